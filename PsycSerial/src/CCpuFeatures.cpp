@@ -0,0 +1,54 @@
+#include "CCpuFeatures.h"
+#pragma managed(push, off)
+
+#if defined(CPU_X64) && defined(_MSC_VER)
+    #include <intrin.h>
+
+static bool CheckAvx()
+{
+    int info[4];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool cpuAvx  = (info[2] & (1 << 28)) != 0;
+    return osxsave && cpuAvx && (_xgetbv(0) & 0x6) == 0x6;   // OS saves the YMM state
+}
+
+bool CCpuFeatures::HasAvx()
+{
+    static const bool avx = CheckAvx();
+    return avx;
+}
+
+bool CCpuFeatures::HasAvx2()
+{
+    static const bool avx2 = [] {
+        if (!CheckAvx()) return false;
+        int info[4];
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }();
+    return avx2;
+}
+
+#elif defined(CPU_X64)
+
+bool CCpuFeatures::HasAvx()
+{
+    static const bool avx = __builtin_cpu_supports("avx");
+    return avx;
+}
+
+bool CCpuFeatures::HasAvx2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+#else
+
+bool CCpuFeatures::HasAvx()  { return false; }
+bool CCpuFeatures::HasAvx2() { return false; }
+
+#endif
+
+#pragma managed(pop)
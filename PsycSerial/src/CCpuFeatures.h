@@ -0,0 +1,26 @@
+#pragma once
+#pragma managed(push, off)
+
+// What the SIMD paths may use on this machine, checked once.  CPU_X64 is defined where the x64 intrinsics are
+// available; a function using AVX or AVX2 intrinsics is marked CPU_TARGET_AVX / CPU_TARGET_AVX2 (MSVC emits them
+// without /arch, gcc and clang only in a function targeted at them) and called only when the check passes.
+#if defined(_M_X64) || defined(__x86_64__)
+    #define CPU_X64 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #define CPU_TARGET_AVX
+        #define CPU_TARGET_AVX2
+    #else
+        #define CPU_TARGET_AVX  __attribute__((target("avx")))
+        #define CPU_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+class CCpuFeatures
+{
+public:
+    static bool HasAvx();    // the CPU has it and the OS saves the YMM state
+    static bool HasAvx2();
+};
+
+#pragma managed(pop)
@@ -0,0 +1,323 @@
+#include "CDownsampler.h"
+#pragma managed(push, off)
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define DOWNSAMPLER_SSE2 1
+#endif
+
+
+// ------------------------------------------------------------------ batch
+
+// Bucket i (0 .. threshold-3) covers [Edge(i), Edge(i+1)); the first and last points are outside all buckets
+static inline size_t Edge(size_t i, size_t n, size_t threshold)
+{
+    return 1 + static_cast<size_t>(static_cast<uint64_t>(i) * (n - 2) / (threshold - 2));
+}
+
+// Index in [begin, end) of the point forming the largest triangle with a and c (the first, on ties).  With a and c
+// fixed the doubled area |(ax - cx)(by - ay) - (ax - bx)(cy - ay)| is linear in b, so each point costs two
+// multiplies; the SSE2 path keeps a best area and index per lane, with no branches in the loop.
+static inline size_t LargestTriangle(const double* x, const double* y, size_t begin, size_t end,
+                                     double ax, double ay, double cx, double cy)
+{
+    const double kx = cy - ay;
+    const double ky = ax - cx;
+    const double k0 = -ky * ay - ax * kx;
+
+    size_t best     = begin;
+    double bestArea = -1.0;
+    size_t j        = begin;
+
+#ifdef DOWNSAMPLER_SSE2
+    if (end - begin >= 4) {
+        const __m128d vkx  = _mm_set1_pd(kx), vky = _mm_set1_pd(ky), vk0 = _mm_set1_pd(k0);
+        const __m128d sign = _mm_set1_pd(-0.0);
+        const __m128d two  = _mm_set1_pd(2.0);
+        __m128d vbest = _mm_set1_pd(-1.0);
+        __m128d vidx  = _mm_setzero_pd();
+        __m128d vj    = _mm_set_pd(1.0, 0.0);          // offsets from begin, as doubles so they blend like areas
+
+        for (; j + 2 <= end; j += 2) {
+            __m128d area = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_loadu_pd(x + j), vkx),
+                                                 _mm_mul_pd(_mm_loadu_pd(y + j), vky)), vk0);
+            area = _mm_andnot_pd(sign, area);
+            const __m128d gt = _mm_cmpgt_pd(area, vbest);
+            vbest = _mm_or_pd(_mm_and_pd(gt, area), _mm_andnot_pd(gt, vbest));
+            vidx  = _mm_or_pd(_mm_and_pd(gt, vj  ), _mm_andnot_pd(gt, vidx ));
+            vj    = _mm_add_pd(vj, two);
+        }
+
+        const double a0 = _mm_cvtsd_f64(vbest), a1 = _mm_cvtsd_f64(_mm_unpackhi_pd(vbest, vbest));
+        const double i0 = _mm_cvtsd_f64(vidx ), i1 = _mm_cvtsd_f64(_mm_unpackhi_pd(vidx , vidx ));
+        const bool   hi = a1 > a0 || (a1 == a0 && i1 < i0);
+        bestArea = hi ? a1 : a0;
+        best     = begin + static_cast<size_t>(hi ? i1 : i0);
+    }
+#endif
+
+    for (; j < end; ++j) {
+        const double area = std::fabs(x[j] * kx + y[j] * ky + k0);
+        if (area > bestArea) { bestArea = area; best = j; }
+    }
+    return best;
+}
+
+// Sums of x and y over [begin, end), in independent partial sums so the adds are not one long dependency chain
+static inline void SumXY(const double* x, const double* y, size_t begin, size_t end, double& sx, double& sy)
+{
+    size_t j = begin;
+    sx = sy = 0.0;
+#ifdef DOWNSAMPLER_SSE2
+    __m128d ax0 = _mm_setzero_pd(), ax1 = _mm_setzero_pd(), ay0 = _mm_setzero_pd(), ay1 = _mm_setzero_pd();
+    for (; j + 4 <= end; j += 4) {
+        ax0 = _mm_add_pd(ax0, _mm_loadu_pd(x + j)); ax1 = _mm_add_pd(ax1, _mm_loadu_pd(x + j + 2));
+        ay0 = _mm_add_pd(ay0, _mm_loadu_pd(y + j)); ay1 = _mm_add_pd(ay1, _mm_loadu_pd(y + j + 2));
+    }
+    const __m128d vx = _mm_add_pd(ax0, ax1), vy = _mm_add_pd(ay0, ay1);
+    sx = _mm_cvtsd_f64(_mm_add_sd(vx, _mm_unpackhi_pd(vx, vx)));
+    sy = _mm_cvtsd_f64(_mm_add_sd(vy, _mm_unpackhi_pd(vy, vy)));
+#endif
+    for (; j < end; ++j) { sx += x[j]; sy += y[j]; }
+}
+
+size_t CDownsampler::LttbCore(const double* x, const double* y, size_t n, size_t* out, size_t threshold)
+{
+    if (threshold == 0 || n == 0) return 0;
+    if (threshold >= n) {
+        for (size_t i = 0; i < n; ++i) out[i] = i;
+        return n;
+    }
+    if (threshold < 3) {
+        out[0] = 0;
+        if (threshold == 2) out[1] = n - 1;
+        return threshold;
+    }
+
+    size_t count = 0;
+    size_t a     = 0;
+    out[count++] = 0;
+
+    size_t begin = Edge(0, n, threshold);
+    for (size_t i = 0; i < threshold - 2; ++i) {
+        const size_t end = Edge(i + 1, n, threshold);
+
+        // Mean of the next bucket; the last bucket looks at the final point
+        const size_t nextEnd = std::min(Edge(i + 2, n, threshold), n);
+        const size_t nextBeg = std::min(end, n - 1);
+        double cx, cy;
+        SumXY(x, y, nextBeg, nextEnd, cx, cy);
+        const double inv = 1.0 / static_cast<double>(nextEnd - nextBeg);
+        cx *= inv;
+        cy *= inv;
+
+        a = LargestTriangle(x, y, begin, end, x[a], y[a], cx, cy);
+        out[count++] = a;
+        begin = end;
+    }
+
+    out[count++] = n - 1;
+    return count;
+}
+
+// Min and max of each of buckets index buckets over the interior points [1, n-1), in index order
+size_t CDownsampler::MinMaxPreselect(const double* y, size_t n, size_t buckets, size_t* out)
+{
+    const size_t interior = n - 2;
+    size_t count = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+        const size_t begin = 1 + static_cast<size_t>(static_cast<uint64_t>(b    ) * interior / buckets);
+        const size_t end   = 1 + static_cast<size_t>(static_cast<uint64_t>(b + 1) * interior / buckets);
+        if (begin == end) continue;
+
+        // Extremes first (vectorised), then the first index holding each; the bucket is in cache by then
+        double vMin = y[begin], vMax = y[begin];
+        size_t j = begin + 1;
+#ifdef DOWNSAMPLER_SSE2
+        if (end - j >= 4) {
+            __m128d mn = _mm_loadu_pd(y + j), mx = mn;
+            for (j += 2; j + 2 <= end; j += 2) {
+                const __m128d v = _mm_loadu_pd(y + j);
+                mn = _mm_min_pd(mn, v);
+                mx = _mm_max_pd(mx, v);
+            }
+            vMin = std::min({ vMin, _mm_cvtsd_f64(mn), _mm_cvtsd_f64(_mm_unpackhi_pd(mn, mn)) });
+            vMax = std::max({ vMax, _mm_cvtsd_f64(mx), _mm_cvtsd_f64(_mm_unpackhi_pd(mx, mx)) });
+        }
+#endif
+        for (; j < end; ++j) {
+            vMin = std::min(vMin, y[j]);
+            vMax = std::max(vMax, y[j]);
+        }
+
+        size_t iMin = end, iMax = end;
+        for (j = begin; j < end && (iMin == end || iMax == end); ++j) {
+            if (iMin == end && y[j] == vMin) iMin = j;
+            if (iMax == end && y[j] == vMax) iMax = j;
+        }
+
+        if (iMin == iMax)
+            out[count++] = iMin;
+        else {
+            out[count++] = std::min(iMin, iMax);
+            out[count++] = std::max(iMin, iMax);
+        }
+    }
+    return count;
+}
+
+size_t CDownsampler::Lttb(std::span<const double> x, std::span<const double> y, std::span<size_t> out)
+{
+    const size_t n = std::min(x.size(), y.size());
+    return LttbCore(x.data(), y.data(), n, out.data(), std::min(out.size(), n));
+}
+
+size_t CDownsampler::MinMaxLttb(std::span<const double> x, std::span<const double> y, std::span<size_t> out, size_t ratio)
+{
+    const size_t n         = std::min(x.size(), y.size());
+    const size_t threshold = std::min(out.size(), n);
+    const size_t buckets   = (threshold > 2 ? threshold - 2 : 0) * std::max<size_t>(ratio, 1);
+
+    // Preselection only pays off when it leaves well under the input
+    if (threshold < 3 || n <= 2 * buckets + 2)
+        return LttbCore(x.data(), y.data(), n, out.data(), threshold);
+
+    std::vector<size_t> keep(2 * buckets + 2);
+    size_t m = 0;
+    keep[m++] = 0;
+    m += MinMaxPreselect(y.data(), n, buckets, keep.data() + m);
+    keep[m++] = n - 1;
+
+    std::vector<double> px(m), py(m);
+    for (size_t i = 0; i < m; ++i) { px[i] = x[keep[i]]; py[i] = y[keep[i]]; }
+
+    const size_t count = LttbCore(px.data(), py.data(), m, out.data(), threshold);
+    for (size_t i = 0; i < count; ++i) out[i] = keep[out[i]];
+    return count;
+}
+
+static size_t Gather(std::span<const double> x, std::span<const double> y, std::span<const size_t> idx,
+                     std::span<double> outX, std::span<double> outY)
+{
+    for (size_t i = 0; i < idx.size(); ++i) { outX[i] = x[idx[i]]; outY[i] = y[idx[i]]; }
+    return idx.size();
+}
+
+size_t CDownsampler::Lttb(std::span<const double> x, std::span<const double> y, std::span<double> outX, std::span<double> outY)
+{
+    std::vector<size_t> idx(std::min(outX.size(), outY.size()));
+    const size_t count = Lttb(x, y, idx);
+    return Gather(x, y, std::span<const size_t>(idx.data(), count), outX, outY);
+}
+
+size_t CDownsampler::MinMaxLttb(std::span<const double> x, std::span<const double> y, std::span<double> outX, std::span<double> outY, size_t ratio)
+{
+    std::vector<size_t> idx(std::min(outX.size(), outY.size()));
+    const size_t count = MinMaxLttb(x, y, idx, ratio);
+    return Gather(x, y, std::span<const size_t>(idx.data(), count), outX, outY);
+}
+
+
+// ------------------------------------------------------------------ streaming
+
+void CLttbStream::Reset(size_t bucketSize)
+{
+    m_bucketSize = bucketSize ? bucketSize : 1;
+    m_started    = false;
+    m_cur .clear();
+    m_next.clear();
+    m_cur .x.assign(m_bucketSize, 0.0); m_cur .y.assign(m_bucketSize, 0.0);
+    m_next.x.assign(m_bucketSize, 0.0); m_next.y.assign(m_bucketSize, 0.0);
+    m_outX.clear();
+    m_outY.clear();
+}
+
+void CLttbStream::Select(const Bucket& b, size_t count, double cx, double cy)
+{
+    if (count == 0) return;
+    const size_t best = LargestTriangle(b.x.data(), b.y.data(), 0, count, m_ax, m_ay, cx, cy);
+    Emit(b.x[best], b.y[best]);
+}
+
+// Keeps one of the first count points of b, against the mean of next
+void CLttbStream::SelectBefore(const Bucket& b, size_t count, const Bucket& next)
+{
+    double cx, cy;
+    SumXY(next.x.data(), next.y.data(), 0, next.size(), cx, cy);
+    const double inv = 1.0 / static_cast<double>(next.size());
+    Select(b, count, cx * inv, cy * inv);
+}
+
+size_t CLttbStream::Fill(Bucket& b, const double* x, const double* y, size_t n) const
+{
+    const size_t take = std::min(n, m_bucketSize - b.n);
+    std::copy_n(x, take, b.x.data() + b.n);
+    std::copy_n(y, take, b.y.data() + b.n);
+    b.n += take;
+    return take;
+}
+
+void CLttbStream::Add(double x, double y)
+{
+    AddRange(std::span<const double>(&x, 1), std::span<const double>(&y, 1));
+}
+
+void CLttbStream::AddRange(std::span<const double> x, std::span<const double> y)
+{
+    const size_t n = std::min(x.size(), y.size());
+    size_t i = 0;
+    if (n && !m_started) {
+        m_started = true;
+        Emit(x[0], y[0]);
+        i = 1;
+    }
+
+    while (i < n) {
+        if (m_cur.size() < m_bucketSize) {
+            i += Fill(m_cur, x.data() + i, y.data() + i, n - i);
+            continue;
+        }
+
+        i += Fill(m_next, x.data() + i, y.data() + i, n - i);
+        if (m_next.size() < m_bucketSize) break;
+
+        SelectBefore(m_cur, m_cur.size(), m_next);
+        std::swap(m_cur, m_next);
+        m_next.clear();
+    }
+}
+
+void CLttbStream::Flush()
+{
+    if (!m_started) return;
+
+    const Bucket* tail = &m_cur;
+    if (m_next.size()) {
+        SelectBefore(m_cur, m_cur.size(), m_next);
+        tail = &m_next;
+    }
+
+    if (const size_t n = tail->size()) {
+        const double lx = tail->x[n - 1], ly = tail->y[n - 1];
+        Select(*tail, n - 1, lx, ly);
+        Emit(lx, ly);
+    }
+
+    m_started = false;
+    m_cur .clear();
+    m_next.clear();
+}
+
+size_t CLttbStream::Drain(std::vector<double>& x, std::vector<double>& y)
+{
+    x.clear();
+    y.clear();
+    std::swap(x, m_outX);
+    std::swap(y, m_outY);
+    return x.size();
+}
+
+#pragma managed(pop)
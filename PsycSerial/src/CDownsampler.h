@@ -0,0 +1,79 @@
+#pragma once
+#pragma managed(push, off)
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Shape-preserving point reduction for long x/y series (x sorted ascending).  Largest-Triangle-Three-Buckets keeps
+// the first and last points and, from each bucket in between, the point forming the largest triangle with the
+// point kept from the previous bucket and the mean of the next one.  MinMaxLttb first reduces every bucket of a
+// much finer grid to its min and max, then runs LTTB over what is left: near-identical output, a fraction of the
+// work on very long inputs.
+class CDownsampler
+{
+public:
+    static constexpr size_t MINMAX_RATIO = 4;   // preselection buckets per output point
+
+    // Indices of the kept points, in order, written to out; returns how many (out.size() is the point budget)
+    static size_t Lttb      (std::span<const double> x, std::span<const double> y, std::span<size_t> out);
+    static size_t MinMaxLttb(std::span<const double> x, std::span<const double> y, std::span<size_t> out,
+                             size_t ratio = MINMAX_RATIO);
+
+    // Same, writing the kept points themselves; outX and outY must be the same size
+    static size_t Lttb      (std::span<const double> x, std::span<const double> y,
+                             std::span<double> outX, std::span<double> outY);
+    static size_t MinMaxLttb(std::span<const double> x, std::span<const double> y,
+                             std::span<double> outX, std::span<double> outY, size_t ratio = MINMAX_RATIO);
+
+    static void DoTest();
+
+private:
+    static size_t LttbCore(const double* x, const double* y, size_t n, size_t* out, size_t threshold);
+    static size_t MinMaxPreselect(const double* y, size_t n, size_t buckets, size_t* out);
+};
+
+
+// Streaming LTTB with a fixed number of input points per bucket, for series of unknown length.  Output lags the
+// input by one bucket (the next bucket's mean must be known); Flush emits the tail, including the last point, and
+// starts a new stream.  Fed n = 2 + k * bucketSize points and flushed, it keeps exactly what batch Lttb keeps with
+// a budget of k + 2.
+class CLttbStream
+{
+public:
+    explicit CLttbStream(size_t bucketSize = 64) { Reset(bucketSize); }
+
+    void Reset(size_t bucketSize);
+    void Add(double x, double y);
+    void AddRange(std::span<const double> x, std::span<const double> y);
+    void Flush();
+
+    // Moves the points kept so far into x / y (cleared first); returns how many
+    size_t Drain(std::vector<double>& x, std::vector<double>& y);
+
+    size_t GetBucketSize() const { return m_bucketSize; }
+    size_t GetPending()    const { return m_outX.size(); }
+
+private:
+    struct Bucket {
+        std::vector<double> x, y;     // sized to the bucket once, filled by index
+        size_t n{};
+
+        size_t size() const { return n; }
+        void   clear() { n = 0; }
+    };
+
+    size_t m_bucketSize{};
+    bool   m_started{};
+    double m_ax{}, m_ay{};          // last point kept
+    Bucket m_cur, m_next;
+    std::vector<double> m_outX, m_outY;
+
+    void Emit(double x, double y) { m_outX.push_back(x); m_outY.push_back(y); m_ax = x; m_ay = y; }
+    void Select(const Bucket& b, size_t count, double cx, double cy);
+    void SelectBefore(const Bucket& b, size_t count, const Bucket& next);
+    size_t Fill(Bucket& b, const double* x, const double* y, size_t n) const;
+};
+
+#pragma managed(pop)
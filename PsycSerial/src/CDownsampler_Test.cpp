@@ -0,0 +1,150 @@
+#include "CDownsampler.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+constexpr size_t SAMPLES = 5'000'000;
+constexpr size_t POINTS  = 4'000;
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// Reference: LTTB as usually written, floating-point bucket edges and the full triangle formula
+static std::vector<size_t> NaiveLttb(const std::vector<double>& x, const std::vector<double>& y, size_t threshold)
+{
+    const size_t n = x.size();
+    std::vector<size_t> out{ 0 };
+    const double every = double(n - 2) / double(threshold - 2);
+    size_t a = 0;
+    for (size_t i = 0; i < threshold - 2; ++i) {
+        size_t avgBeg = size_t(std::floor((i + 1) * every)) + 1;
+        size_t avgEnd = std::min(size_t(std::floor((i + 2) * every)) + 1, n);
+        if (avgBeg >= n) avgBeg = n - 1;
+        double cx = 0.0, cy = 0.0;
+        for (size_t j = avgBeg; j < avgEnd; ++j) { cx += x[j]; cy += y[j]; }
+        cx /= double(avgEnd - avgBeg);
+        cy /= double(avgEnd - avgBeg);
+
+        const size_t beg = size_t(std::floor(i * every)) + 1;
+        const size_t end = size_t(std::floor((i + 1) * every)) + 1;
+        double best = -1.0;
+        size_t pick = beg;
+        for (size_t j = beg; j < end; ++j) {
+            const double area = std::fabs((x[a] - cx) * (y[j] - y[a]) - (x[a] - x[j]) * (cy - y[a]));
+            if (area > best) { best = area; pick = j; }
+        }
+        out.push_back(a = pick);
+    }
+    out.push_back(n - 1);
+    return out;
+}
+
+
+void CDownsampler::DoTest()
+{
+    std::cout << "=== CDownsampler test ===\n";
+
+    std::mt19937 rng(5);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    // A2D-like series: slow sines, noise, steps and a few spikes, on a slightly jittered clock
+    std::vector<double> x(SAMPLES), y(SAMPLES);
+    double t = 0.0, level = 0.0;
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        t += 1e-4 * (0.9 + 0.2 * uniform(rng));
+        if (i % 250'000 == 0) level = 50.0 * noise(rng);
+        x[i] = t;
+        y[i] = level + 20.0 * std::sin(t * 3.0) + 5.0 * std::sin(t * 41.0) + noise(rng)
+             + ((i % 333'331 == 1'000) ? 300.0 : 0.0);
+    }
+
+    // Correctness against the reference on a range of lengths and budgets
+    size_t mismatches = 0;
+    for (size_t n : { 3, 10, 101, 1'000, 65'537 }) {
+        std::vector<double> sx(x.begin(), x.begin() + n), sy(y.begin(), y.begin() + n);
+        for (size_t threshold : { 3, 7, 50, 1'000 }) {
+            if (threshold >= n) continue;
+            std::vector<size_t> idx(threshold);
+            idx.resize(Lttb(sx, sy, idx));
+            if (idx != NaiveLttb(sx, sy, threshold)) ++mismatches;
+        }
+    }
+    std::cout << "Batch mismatches: " << mismatches << "\n";
+
+    // Streaming equals batch when n = 2 + k * bucketSize
+    mismatches = 0;
+    for (size_t bucket : { 1, 3, 64, 1'000 }) {
+        const size_t k = 200, n = 2 + k * bucket;
+        std::vector<double> sx(x.begin(), x.begin() + n), sy(y.begin(), y.begin() + n);
+        std::vector<double> bx(k + 2), by(k + 2);
+        bx.resize(Lttb(sx, sy, bx, by));
+        by.resize(bx.size());
+
+        CLttbStream stream(bucket);
+        std::vector<double> ox, oy, chunkX, chunkY;
+        for (size_t i = 0; i < n; i += 777) {
+            const size_t m = std::min<size_t>(777, n - i);
+            stream.AddRange(std::span(sx).subspan(i, m), std::span(sy).subspan(i, m));
+            stream.Drain(chunkX, chunkY);
+            ox.insert(ox.end(), chunkX.begin(), chunkX.end());
+            oy.insert(oy.end(), chunkY.begin(), chunkY.end());
+        }
+        stream.Flush();
+        stream.Drain(chunkX, chunkY);
+        ox.insert(ox.end(), chunkX.begin(), chunkX.end());
+        oy.insert(oy.end(), chunkY.begin(), chunkY.end());
+        if (ox != bx || oy != by) ++mismatches;
+    }
+    std::cout << "Stream mismatches: " << mismatches << "\n";
+
+    // Timing: millions of points down to a few thousand
+    std::vector<size_t> lttb(POINTS), minmax(POINTS);
+    double start = GetTime();
+    lttb.resize(Lttb(x, y, lttb));
+    const double tLttb = GetTime() - start;
+
+    start = GetTime();
+    minmax.resize(MinMaxLttb(x, y, minmax));
+    const double tMinMax = GetTime() - start;
+
+    CLttbStream stream(SAMPLES / POINTS);
+    std::vector<double> sx, sy;
+    start = GetTime();
+    stream.AddRange(x, y);
+    stream.Flush();
+    stream.Drain(sx, sy);
+    const double tStream = GetTime() - start;
+
+    // Floor for comparison: one plain read of x and y
+    start = GetTime();
+    double checksum = 0.0;
+    for (size_t i = 0; i < SAMPLES; ++i) checksum += x[i] + y[i];
+    const double tRead = GetTime() - start;
+
+    std::vector<size_t> every(POINTS);
+    for (size_t i = 0; i < POINTS; ++i) every[i] = i * (SAMPLES - 1) / (POINTS - 1);
+
+    auto spikesIn = [](const std::vector<size_t>& idx) {
+        size_t n = 0;
+        for (size_t i : idx) n += (i % 333'331 == 1'000);
+        return n;
+    };
+    size_t spikes = 0;
+    for (size_t i = 0; i < SAMPLES; ++i) spikes += (i % 333'331 == 1'000);
+
+    std::cout << SAMPLES << " -> " << POINTS << " points (spikes kept of " << spikes << "):\n";
+    std::cout << "  LTTB        " << tLttb   * 1e3 << " ms,  spikes " << spikesIn(lttb)   << "\n";
+    std::cout << "  MinMaxLTTB  " << tMinMax * 1e3 << " ms,  spikes " << spikesIn(minmax) << "\n";
+    std::cout << "  Stream      " << tStream * 1e3 << " ms,  " << sx.size() << " points\n";
+    std::cout << "  Every n-th  spikes " << spikesIn(every) << "\n";
+    std::cout << "  (one read of x and y: " << tRead * 1e3 << " ms, checksum " << checksum << ")\n";
+    std::cout << "\n";
+}
@@ -0,0 +1,38 @@
+#pragma once
+#pragma managed(push, off)
+
+#include <cstdint>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
+
+// Monotonic host time in nanoseconds: QueryPerformanceCounter on Windows, CLOCK_MONOTONIC_RAW elsewhere.  Not
+// slewed by NTP, so differences are true elapsed time; the epoch is arbitrary (boot, usually) and only meaningful
+// within the process.
+class CHostClock
+{
+public:
+    static int64_t NowNs() noexcept
+    {
+#ifdef _WIN32
+        LARGE_INTEGER count, freq;
+        QueryPerformanceCounter(&count);
+        QueryPerformanceFrequency(&freq);   // fixed at boot, and cheaper than a guarded static in mixed-mode code
+        const int64_t sec = count.QuadPart / freq.QuadPart;
+        const int64_t rem = count.QuadPart % freq.QuadPart;
+        return sec * 1'000'000'000 + rem * 1'000'000'000 / freq.QuadPart;
+#else
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return int64_t(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+#endif
+    }
+
+    static double ToSeconds(int64_t ns) noexcept { return ns * 1e-9; }
+};
+
+#pragma managed(pop)
@@ -0,0 +1,177 @@
+#pragma once
+#pragma managed(push, off)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <span>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+// Min/max level-of-detail pyramid for one plot series.  Level 0 holds raw (x, y) samples; every level above it holds
+// buckets that each cover FANOUT buckets of the level below.  Each level is a ring of the same capacity, so memory
+// is fixed (levels * capacity buckets) while the coarse levels reach FANOUT times further back in time per level.
+// A bucket is only pushed up when it completes, so Add is amortized O(1).  x must be non-decreasing; a step back
+// in x (device reset, restarted timestamps) clears the history.
+class CMinMaxPyramid {
+public:
+    static constexpr size_t FANOUT     = 4;
+    static constexpr size_t OVERSAMPLE = 4;   // Query uses the finest level with at most this many buckets per pixel
+
+    struct Bucket {
+        double x0, x1;       // first and last x covered
+        double min, max;
+    };
+
+    explicit CMinMaxPyramid(size_t capacity = 4096, size_t levels = 8) {
+        Reset(capacity, levels);
+    }
+
+    void Reset(size_t capacity, size_t levels) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        m_mask = cap - 1;
+        m_levels.assign(levels ? levels : 1, Level{});
+        for (Level& l : m_levels) l.ring.resize(cap);
+        Clear();
+    }
+
+    void Clear() {
+        for (Level& l : m_levels) { l.head = 0; l.count = 0; l.accCount = 0; }
+        m_firstX = std::numeric_limits<double>::quiet_NaN();
+        m_lastX  = -std::numeric_limits<double>::infinity();
+    }
+
+    // NaN y is ignored
+    void Add(double x, double y) {
+        if (std::isnan(y) || std::isnan(x)) return;
+        if (x < m_lastX) Clear();
+        if (IsEmpty()) m_firstX = x;
+        m_lastX = x;
+        Push(0, Bucket{ x, x, y, y });
+    }
+
+    void AddRange(std::span<const double> x, std::span<const double> y) {
+        const size_t n = std::min(x.size(), y.size());
+        for (size_t i = 0; i < n; ++i) Add(x[i], y[i]);
+    }
+
+    size_t GetLevelCount()        const { return m_levels.size(); }
+    size_t GetCapacity()          const { return m_mask + 1; }
+    size_t GetCount(size_t level) const { return level < m_levels.size() ? m_levels[level].count : 0; }
+    bool   IsEmpty()              const { return m_levels[0].count == 0; }
+
+    // Oldest x still held at any level, +inf when empty
+    double GetFirstX() const {
+        for (size_t k = m_levels.size(); k-- > 0; ) {
+            const Level& l = m_levels[k];
+            if (l.count) return At(l, 0).x0;
+        }
+        return std::numeric_limits<double>::infinity();
+    }
+    double GetLastX() const { return IsEmpty() ? -std::numeric_limits<double>::infinity() : m_lastX; }
+
+    // One min/max pair per pixel over [x0, x1).  Pixels with no data get NaN.  Returns the level used, or -1 if
+    // nothing was in range.
+    int Query(double x0, double x1, std::span<double> outMin, std::span<double> outMax) const {
+        const size_t pixels = std::min(outMin.size(), outMax.size());
+        std::fill_n(outMin.begin(), pixels, std::numeric_limits<double>::quiet_NaN());
+        std::fill_n(outMax.begin(), pixels, std::numeric_limits<double>::quiet_NaN());
+        if (pixels == 0 || !(x1 > x0) || IsEmpty()) return -1;
+
+        // Finest level that still reaches back to x0 (or to the first sample) and is not too dense for the pixel
+        // count; failing that, the coarsest level holding anything
+        const double reach = std::max(x0, m_firstX);
+        size_t level = 0, first = 0, last = 0;
+        for (; level < m_levels.size(); ++level) {
+            const Level& l = m_levels[level];
+            first = LowerBound(l, x0);
+            last  = LowerBound(l, x1);
+            const bool covers = l.count && At(l, 0).x0 <= reach;
+            const bool top    = level + 1 == m_levels.size() || m_levels[level + 1].count == 0;
+            if ((covers && last - first <= pixels * OVERSAMPLE) || top) break;
+        }
+
+        // buckets wholly in range, plus the one straddling x0
+        const Level& l = m_levels[level];
+        if (first > 0 && At(l, first - 1).x1 >= x0) --first;
+
+        const double scale = pixels / (x1 - x0);
+        auto merge = [&](const Bucket& b) {
+            if (b.x1 < x0 || b.x0 >= x1) return;
+            const size_t p0 = b.x0 <= x0 ? 0 : std::min(pixels - 1, static_cast<size_t>((b.x0 - x0) * scale));
+            const size_t p1 = std::min(pixels - 1, static_cast<size_t>(std::max(0.0, (b.x1 - x0) * scale)));
+            for (size_t p = p0; p <= p1; ++p) {
+                if (!(outMin[p] <= b.min)) outMin[p] = b.min;
+                if (!(outMax[p] >= b.max)) outMax[p] = b.max;
+            }
+        };
+
+        for (size_t i = first; i < last; ++i) merge(At(l, i));
+
+        // Samples newer than the last completed bucket at this level are still in the accumulators below it
+        if (last == l.count)
+            for (size_t k = level; k > 0; --k)
+                if (m_levels[k].accCount) merge(m_levels[k].acc);
+
+        return static_cast<int>(level);
+    }
+
+    static void DoTest();
+
+private:
+    struct Level {
+        std::vector<Bucket> ring;
+        size_t head{};       // next write slot
+        size_t count{};
+        Bucket acc{};        // partial bucket built from completed buckets of the level below
+        size_t accCount{};
+    };
+
+    std::vector<Level> m_levels;
+    size_t             m_mask{};
+    double             m_firstX{};     // since the last Clear
+    double             m_lastX{};
+
+    // i = 0 is the oldest held bucket
+    const Bucket& At(const Level& l, size_t i) const {
+        return l.ring[(l.head - l.count + i) & m_mask];
+    }
+
+    // First held bucket with x0 >= x
+    size_t LowerBound(const Level& l, double x) const {
+        size_t lo = 0, hi = l.count;
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (At(l, mid).x0 < x) lo = mid + 1; else hi = mid;
+        }
+        return lo;
+    }
+
+    void Push(size_t level, Bucket b) {
+        for (;;) {
+            Level& l = m_levels[level];
+            l.ring[l.head] = b;
+            l.head = (l.head + 1) & m_mask;
+            if (l.count <= m_mask) l.count++;
+
+            if (++level == m_levels.size()) return;
+
+            Level& up = m_levels[level];
+            if (up.accCount++ == 0)
+                up.acc = b;
+            else {
+                up.acc.x1  = b.x1;
+                up.acc.min = std::min(up.acc.min, b.min);
+                up.acc.max = std::max(up.acc.max, b.max);
+            }
+            if (up.accCount < FANOUT) return;
+
+            up.accCount = 0;
+            b = up.acc;
+        }
+    }
+};
+
+#pragma managed(pop)
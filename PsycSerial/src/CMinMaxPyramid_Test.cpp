@@ -0,0 +1,98 @@
+#include "CMinMaxPyramid.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+constexpr size_t SAMPLES = 2'000'000;
+constexpr size_t PIXELS  = 1'000;
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// Reference: bin every raw sample in [x0, x1) into its pixel
+static void NaiveQuery(const std::vector<double>& x, const std::vector<double>& y, size_t from, double x0, double x1,
+                       std::vector<double>& outMin, std::vector<double>& outMax)
+{
+    const double nan   = std::numeric_limits<double>::quiet_NaN();
+    const size_t px    = outMin.size();
+    const double scale = px / (x1 - x0);
+    std::fill(outMin.begin(), outMin.end(), nan);
+    std::fill(outMax.begin(), outMax.end(), nan);
+    for (size_t i = from; i < x.size(); ++i) {
+        if (x[i] < x0 || x[i] >= x1) continue;
+        const size_t p = std::min(px - 1, static_cast<size_t>((x[i] - x0) * scale));
+        if (!(outMin[p] <= y[i])) outMin[p] = y[i];
+        if (!(outMax[p] >= y[i])) outMax[p] = y[i];
+    }
+}
+
+
+void CMinMaxPyramid::DoTest()
+{
+    std::cout << "=== CMinMaxPyramid test ===\n";
+
+    std::mt19937 rng(11);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    // Irregularly spaced samples with occasional single-sample spikes
+    std::vector<double> x(SAMPLES), y(SAMPLES);
+    double t = 0.0;
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        t += 0.001 * (0.5 + uniform(rng));
+        x[i] = t;
+        y[i] = 10.0 * std::sin(t) + noise(rng) + ((i % 100'003 == 50'000) ? 500.0 : 0.0);
+    }
+
+    CMinMaxPyramid pyramid(4096, 8);
+    double start = GetTime();
+    for (size_t i = 0; i < SAMPLES; ++i) pyramid.Add(x[i], y[i]);
+    const double tAdd = (GetTime() - start) * 1e9 / SAMPLES;
+
+    // Ranges inside the raw window must match the naive binning exactly
+    const size_t raw0 = SAMPLES - pyramid.GetCapacity();
+    std::vector<double> qMin(PIXELS), qMax(PIXELS), nMin(PIXELS), nMax(PIXELS);
+    size_t mismatches = 0;
+    for (int i = 0; i < 100; ++i) {
+        double a = x[raw0] + uniform(rng) * (x.back() - x[raw0]);
+        double b = x[raw0] + uniform(rng) * (x.back() - x[raw0]);
+        if (a > b) std::swap(a, b);
+        if (b - a < 1e-6) continue;
+        if (pyramid.Query(a, b, qMin, qMax) != 0) { ++mismatches; continue; }
+        NaiveQuery(x, y, raw0, a, b, nMin, nMax);
+        for (size_t p = 0; p < PIXELS; ++p)
+            if ((qMin[p] != nMin[p] && !(std::isnan(qMin[p]) && std::isnan(nMin[p]))) ||
+                (qMax[p] != nMax[p] && !(std::isnan(qMax[p]) && std::isnan(nMax[p])))) ++mismatches;
+    }
+    std::cout << "Raw-level mismatches: " << mismatches << "\n";
+
+    // Wider ranges come from coarser levels: the envelope must contain every sample and keep every spike
+    size_t missed = 0, spikesSeen = 0, spikesKept = 0;
+    double tQuery = 0.0;
+    for (double span : { 10.0, 100.0, 1000.0 }) {
+        const double b = x.back() + 1e-9, a = std::max(pyramid.GetFirstX(), b - span);
+        start = GetTime();
+        const int level = pyramid.Query(a, b, qMin, qMax);
+        tQuery = std::max(tQuery, GetTime() - start);
+
+        NaiveQuery(x, y, 0, a, b, nMin, nMax);
+        for (size_t p = 0; p < PIXELS; ++p) {
+            if (std::isnan(nMin[p])) continue;
+            if (!(qMin[p] <= nMin[p]) || !(qMax[p] >= nMax[p])) ++missed;
+            if (nMax[p] > 100.0) { ++spikesSeen; if (qMax[p] > 100.0) ++spikesKept; }
+        }
+        std::cout << "Span " << span << ": level " << level << "\n";
+    }
+    std::cout << "Samples outside envelope: " << missed << ",  spikes kept " << spikesKept << "/" << spikesSeen << "\n";
+
+    std::cout << "Add: " << tAdd << " ns/sample,  worst query (" << PIXELS << " px): " << tQuery * 1e6 << " us\n";
+    std::cout << "Memory: " << pyramid.GetLevelCount() * pyramid.GetCapacity() * sizeof(Bucket) / 1024 << " KiB,  reach "
+              << x.back() - pyramid.GetFirstX() << " of " << x.back() - x.front() << "\n";
+    std::cout << "\n";
+}
@@ -1,11 +1,40 @@
 #pragma once
+#pragma managed(push, off)
 
 #include <cstddef>
 #include <cstdint>   // For double and double
 #include <vector>
-#include <deque>
-#include <utility> // pair
+#include <span>
+#include <algorithm>
+#include <cmath>
 
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define RUNNINGAVERAGE_SSE2 1
+#endif
+
+// Neumaier-compensated accumulator: the rounding error of every add is carried in c
+struct CCompensatedSum {
+    double sum{};
+    double c{};
+
+    void Reset(double value = 0.0) { sum = value; c = 0.0; }
+
+    void Add(double x) {
+        double t = sum + x;
+        if (std::fabs(sum) >= std::fabs(x))
+            c += (sum - t) + x;
+        else
+            c += (x - t) + sum;
+        sum = t;
+    }
+
+    double Value() const { return sum + c; }
+};
+
+
+// Window sums are kept relative to a shift K (a recent mean), compensated, and re-summed exactly every time the
+// ring wraps, so values around 1e9 neither drift nor lose the variance to cancellation.
 class CRunningAverage {
 public:
     explicit CRunningAverage(size_t windowSize = 16) {
@@ -14,75 +43,358 @@ public:
 
     void Reset(size_t windowSize) {
         m_values.assign(windowSize ? windowSize : 1, 0.0);
-        m_sum = 0.0;
+        m_sum.Reset();
+        m_sumSq.Reset();
+        m_shift = 0.0;
         m_head = 0;
         m_count = 0;
         m_seq = 0;
+        m_ema = 0.0;
+        m_emaPrimed = false;
     }
 
-
+    // 0 disables the exponential moving average
+    void   SetEmaAlpha(double alpha) { m_emaAlpha = std::clamp(alpha, 0.0, 1.0); m_ema = GetNewest(); m_emaPrimed = m_count > 0; }
+    double GetEmaAlpha() const       { return m_emaAlpha; }
 
     void Add(double value) {
         const size_t W = m_values.size();
-        if (m_count == W)
-            m_sum -= m_values[m_head];
+        if (m_count == 0)
+            m_shift = value;
+
+        const double d = value - m_shift;
+        if (m_count == W) {
+            const double old = m_values[m_head] - m_shift;
+            m_sum.Add(-old);
+            m_sumSq.Add(-old * old);
+        }
         else
             m_count++;
 
-        m_sum += value;
+        m_sum.Add(d);
+        m_sumSq.Add(d * d);
         m_values[m_head] = value;
+        UpdateEma(value);
 
-        if (++m_head == W) m_head = 0;
+        if (++m_head == W) {
+            m_head = 0;
+            if (m_count == W) Resum();
+        }
         m_seq++;
     }
 
-    double   GetAverage() const { return m_count ? m_sum / m_count : 0.0; }
-    size_t   GetCount()   const { return m_count; }
-    bool     IsFull()     const { return m_count == m_values.size(); }
+    // Bulk add.  The sums are updated from per-slot differences against what each slot held before.
+    void AddRange(std::span<const double> values) {
+        const size_t W = m_values.size();
+        const size_t n = values.size();
+        if (n == 0) return;
+
+        if (n >= W) {
+            // only the last W values survive
+            for (double v : values) UpdateEma(v);
+            std::copy(values.end() - W, values.end(), m_values.begin());
+            m_head  = 0;
+            m_count = W;
+            m_seq  += n;
+            Resum();
+            return;
+        }
+
+        if (!IsFull()) {
+            // still filling: unfilled slots are not part of the sums
+            for (double v : values) Add(v);
+            return;
+        }
+
+        for (double v : values) UpdateEma(v);
+
+        const size_t first = std::min(n, W - m_head);   // up to the end of the ring, then wrap
+        CopyAndDiff(values.data()        , m_values.data() + m_head, first    );
+        CopyAndDiff(values.data() + first, m_values.data()         , n - first);
+
+        const bool wrapped = m_head + n >= W;
+        m_head  = (m_head + n) % W;
+        m_seq  += n;
+        if (wrapped) Resum();
+    }
+
+    double   GetAverage()  const { return m_count ? m_shift + m_sum.Value() / m_count : 0.0; }
+    size_t   GetCount()    const { return m_count; }
+    bool     IsFull()      const { return m_count == m_values.size(); }
+
+    // Population variance of the window
+    double GetVariance() const {
+        if (m_count < 2) return 0.0;
+        const double mean = m_sum.Value() / m_count;
+        return std::max(0.0, m_sumSq.Value() / m_count - mean * mean);
+    }
+    double GetStdDev()   const { return std::sqrt(GetVariance()); }
+    double GetEma()      const { return m_emaAlpha > 0.0 ? m_ema : GetAverage(); }
+
+    // Value added `delay` samples ago (0 = newest); 0.0 if that is outside the window
+    double GetDelayed(size_t delay) const {
+        if (delay >= m_count) return 0.0;
+        const size_t W = m_values.size();
+        return m_values[(m_head + W - 1 - delay) % W];
+    }
+    double GetNewest() const { return GetDelayed(0); }
 
 protected:
     std::vector<double> m_values;
-    double   m_sum{};
+    CCompensatedSum m_sum{};     // sum(v - m_shift)
+    CCompensatedSum m_sumSq{};   // sum((v - m_shift)^2)
+    double   m_shift{};
     size_t   m_count{};
     size_t   m_head{};
     size_t   m_seq{}; // monotonically increasing
+    double   m_emaAlpha{};
+    double   m_ema{};
+    bool     m_emaPrimed{};
+
+    void UpdateEma(double value) {
+        if (m_emaAlpha <= 0.0) return;
+        m_ema = m_emaPrimed ? m_ema + m_emaAlpha * (value - m_ema) : value;
+        m_emaPrimed = true;
+    }
+
+    // Exact re-summation over the full window, re-centring the shift on the current mean
+    void Resum() {
+        const size_t W = m_values.size();
+        m_shift += Sum(m_values.data(), W, m_shift) / W;
+
+        double s1, s2;
+        SumShifted(m_values.data(), W, m_shift, s1, s2);
+        m_sum.Reset(s1);
+        m_sumSq.Reset(s2);
+    }
+
+    // sum(p[i] - shift)
+    static double Sum(const double* p, size_t n, double shift) {
+        double s1, s2;
+        SumShifted(p, n, shift, s1, s2);
+        return s1;
+    }
+
+    static void SumShifted(const double* p, size_t n, double shift, double& s1, double& s2) {
+        size_t i = 0;
+        s1 = 0.0; s2 = 0.0;
+#ifdef RUNNINGAVERAGE_SSE2
+        const __m128d k = _mm_set1_pd(shift);
+        __m128d a1 = _mm_setzero_pd(), a2 = _mm_setzero_pd();
+        for (; i + 2 <= n; i += 2) {
+            __m128d d = _mm_sub_pd(_mm_loadu_pd(p + i), k);
+            a1 = _mm_add_pd(a1, d);
+            a2 = _mm_add_pd(a2, _mm_mul_pd(d, d));
+        }
+        s1 = HorizontalAdd(a1);
+        s2 = HorizontalAdd(a2);
+#endif
+        for (; i < n; ++i) { double d = p[i] - shift; s1 += d; s2 += d * d; }
+    }
+
+    // Copies src over dst, folding (new - old) and ((new-K)^2 - (old-K)^2) = (new - old)(new + old - 2K) into the sums
+    void CopyAndDiff(const double* src, double* dst, size_t n) {
+        size_t i = 0;
+        double d1 = 0.0, d2 = 0.0;
+        const double twoK = 2.0 * m_shift;
+#ifdef RUNNINGAVERAGE_SSE2
+        const __m128d k2 = _mm_set1_pd(twoK);
+        __m128d a1 = _mm_setzero_pd(), a2 = _mm_setzero_pd();
+        for (; i + 2 <= n; i += 2) {
+            __m128d v = _mm_loadu_pd(src + i);
+            __m128d o = _mm_loadu_pd(dst + i);
+            __m128d diff = _mm_sub_pd(v, o);
+            a1 = _mm_add_pd(a1, diff);
+            a2 = _mm_add_pd(a2, _mm_mul_pd(diff, _mm_sub_pd(_mm_add_pd(v, o), k2)));
+            _mm_storeu_pd(dst + i, v);
+        }
+        d1 = HorizontalAdd(a1);
+        d2 = HorizontalAdd(a2);
+#endif
+        for (; i < n; ++i) {
+            double diff = src[i] - dst[i];
+            d1 += diff;
+            d2 += diff * (src[i] + dst[i] - twoK);
+            dst[i] = src[i];
+        }
+        m_sum.Add(d1);
+        m_sumSq.Add(d2);
+    }
+
+#ifdef RUNNINGAVERAGE_SSE2
+    static double HorizontalAdd(__m128d v) {
+        return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+    }
+#endif
+};
+
 
+// Monotonic queue on a fixed power-of-two ring: values with their sequence numbers, no per-push allocation.
+// Evicts(back, value) is true when a newer value makes the back entry irrelevant.
+template <typename Evicts>
+class CMonotonicRing {
+public:
+    void Reset(size_t window) {
+        size_t cap = 1;
+        while (cap < window + 1) cap <<= 1;   // window + 1: Add pushes before it expires
+        m_value.assign(cap, 0.0);
+        m_seq.assign(cap, 0);
+        m_mask = cap - 1;
+        m_front = m_back = 0;
+    }
+
+    bool   empty()     const { return m_front == m_back; }
+    double Front()     const { return m_value[m_front & m_mask]; }
+    double Back()      const { return m_value[(m_back - 1) & m_mask]; }
+
+    void Clear() { m_front = m_back = 0; }
+
+    void Push(double value, size_t seq) {
+        while (!empty() && Evicts{}(Back(), value)) --m_back;
+        PushUnchecked(value, seq);
+    }
+
+    void PushUnchecked(double value, size_t seq) {
+        m_value[m_back & m_mask] = value;
+        m_seq  [m_back & m_mask] = seq;
+        ++m_back;
+    }
+
+    // Drop everything from the back that value would evict (used before a bulk append)
+    void TrimBack(double value) {
+        while (!empty() && Evicts{}(Back(), value)) --m_back;
+    }
+
+    void Expire(size_t expireBefore) {
+        while (!empty() && m_seq[m_front & m_mask] <= expireBefore) ++m_front;
+    }
+
+private:
+    std::vector<double> m_value;
+    std::vector<size_t> m_seq;
+    size_t m_mask{};
+    size_t m_front{}, m_back{};   // free-running, masked on access
 };
 
 
 class CRunningAverageMinMax : public CRunningAverage {
 public:
     explicit CRunningAverageMinMax(size_t windowSize = 16) : CRunningAverage(windowSize) {
-        m_minq.clear(); m_maxq.clear();
+        ResetQueues();
     }
 
     void Reset(size_t windowSize) {
         CRunningAverage::Reset(windowSize);
-        m_minq.clear(); m_maxq.clear();
+        ResetQueues();
     }
 
     void Add(double value) {
         CRunningAverage::Add(value);
         const size_t W = m_values.size();
 
-        // Min deque: pop larger tails, then push
-        while (!m_minq.empty() && m_minq.back().first >= value) m_minq.pop_back();
-        m_minq.emplace_back(value, m_seq);
-
-        // Max deque: pop smaller tails, then push
-        while (!m_maxq.empty() && m_maxq.back().first <= value) m_maxq.pop_back();
-        m_maxq.emplace_back(value, m_seq);
+        // Min queue: pop larger tails, then push.  Max queue: pop smaller tails, then push
+        m_minq.Push(value, m_seq);
+        m_maxq.Push(value, m_seq);
 
         // Expire anything that fell out of the window
         const size_t expireBefore = (m_seq > W) ? (m_seq - W) : 0;
-        while (!m_minq.empty() && m_minq.front().second <= expireBefore) m_minq.pop_front();
-        while (!m_maxq.empty() && m_maxq.front().second <= expireBefore) m_maxq.pop_front();
+        m_minq.Expire(expireBefore);
+        m_maxq.Expire(expireBefore);
+    }
+
+    // Bulk add.  Within a block only its suffix minima (maxima) can survive in the queue, so those are found
+    // with one backwards scan and appended in order; the block extremes trim the old queues in one go.
+    void AddRange(std::span<const double> values) {
+        const size_t W = m_values.size();
+        if (values.empty()) return;
+
+        const size_t firstSeq = m_seq + 1;
+        CRunningAverage::AddRange(values);
+
+        if (values.size() >= W) {
+            // whole window replaced
+            m_minq.Clear(); m_maxq.Clear();
+            AppendBlock(values.last(W), m_seq - W + 1);
+            return;
+        }
+
+        const size_t expireBefore = (m_seq > W) ? (m_seq - W) : 0;
+        m_minq.Expire(expireBefore);
+        m_maxq.Expire(expireBefore);
+
+        AppendBlock(values, firstSeq);
     }
 
-    double GetMin()     const { return m_count ? m_minq.front().first : 0; }
-    double GetMax()     const { return m_count ? m_maxq.front().first : 0; }
+    double GetMin()     const { return m_count ? m_minq.Front() : 0; }
+    double GetMax()     const { return m_count ? m_maxq.Front() : 0; }
+
+    static void DoTest();
+
 private:
+    struct GreaterEq { bool operator()(double back, double v) const { return back >= v; } };
+    struct LessEq    { bool operator()(double back, double v) const { return back <= v; } };
+
+    CMonotonicRing<GreaterEq> m_minq;
+    CMonotonicRing<LessEq>    m_maxq;
+    std::vector<uint32_t>     m_scratch;   // suffix extreme indices of the current block
+
+    void ResetQueues() {
+        m_minq.Reset(m_values.size());
+        m_maxq.Reset(m_values.size());
+        m_scratch.assign(m_values.size(), 0);
+    }
+
+    void AppendBlock(std::span<const double> block, size_t firstSeq) {
+        const size_t n = block.size();
+
+        double blockMin, blockMax;
+        MinMax(block.data(), n, blockMin, blockMax);
 
-    std::deque<std::pair<double, size_t>> m_minq, m_maxq;
+        m_minq.TrimBack(blockMin);
+        AppendSuffix(m_minq, block, firstSeq, [](double v, double best) { return v < best; });
+
+        m_maxq.TrimBack(blockMax);
+        AppendSuffix(m_maxq, block, firstSeq, [](double v, double best) { return v > best; });
+    }
+
+    // Strict comparison: a later equal value evicts an earlier one, as in Add
+    template <typename Queue, typename Better>
+    void AppendSuffix(Queue& q, std::span<const double> block, size_t firstSeq, Better better) {
+        size_t kept = 0;
+        double best = block.back();
+        m_scratch[kept++] = static_cast<uint32_t>(block.size() - 1);
+
+        for (size_t i = block.size() - 1; i-- > 0; ) {
+            if (better(block[i], best)) {
+                best = block[i];
+                m_scratch[kept++] = static_cast<uint32_t>(i);
+            }
+        }
+
+        while (kept > 0) {
+            uint32_t i = m_scratch[--kept];
+            q.PushUnchecked(block[i], firstSeq + i);
+        }
+    }
+
+    static void MinMax(const double* p, size_t n, double& mn, double& mx) {
+        size_t i = 0;
+        mn = p[0]; mx = p[0];
+#ifdef RUNNINGAVERAGE_SSE2
+        if (n >= 2) {
+            __m128d vmin = _mm_loadu_pd(p), vmax = vmin;
+            for (i = 2; i + 2 <= n; i += 2) {
+                __m128d v = _mm_loadu_pd(p + i);
+                vmin = _mm_min_pd(vmin, v);
+                vmax = _mm_max_pd(vmax, v);
+            }
+            mn = std::min(_mm_cvtsd_f64(vmin), _mm_cvtsd_f64(_mm_unpackhi_pd(vmin, vmin)));
+            mx = std::max(_mm_cvtsd_f64(vmax), _mm_cvtsd_f64(_mm_unpackhi_pd(vmax, vmax)));
+        }
+#endif
+        for (; i < n; ++i) { mn = std::min(mn, p[i]); mx = std::max(mx, p[i]); }
+    }
+
+};
 
-};
\ No newline at end of file
+#pragma managed(pop)
@@ -0,0 +1,147 @@
+#include "CRunningAverage.h"
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+constexpr size_t SAMPLES = 2'000'000;
+constexpr size_t BLOCK   = 164;         // MAX_BLOCKSIZE
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+
+// The previous implementation: std::deque monotonic queues, one sample at a time
+class CDequeMinMax : public CRunningAverage {
+public:
+    explicit CDequeMinMax(size_t windowSize) : CRunningAverage(windowSize) {}
+
+    void Add(double value) {
+        CRunningAverage::Add(value);
+        const size_t W = m_values.size();
+
+        while (!m_minq.empty() && m_minq.back().value >= value) m_minq.pop_back();
+        m_minq.push_back({ value, m_seq });
+        while (!m_maxq.empty() && m_maxq.back().value <= value) m_maxq.pop_back();
+        m_maxq.push_back({ value, m_seq });
+
+        const size_t expireBefore = (m_seq > W) ? (m_seq - W) : 0;
+        while (!m_minq.empty() && m_minq.front().seq <= expireBefore) m_minq.pop_front();
+        while (!m_maxq.empty() && m_maxq.front().seq <= expireBefore) m_maxq.pop_front();
+    }
+
+    double GetMin() const { return m_count ? m_minq.front().value : 0; }
+    double GetMax() const { return m_count ? m_maxq.front().value : 0; }
+
+private:
+    struct Entry { double value; size_t seq; };
+    std::deque<Entry> m_minq, m_maxq;
+};
+
+
+void CRunningAverageMinMax::DoTest()
+{
+    std::cout << "=== CRunningAverageMinMax test ===\n";
+
+    std::mt19937 rng(42);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_int_distribution<size_t> blockLen(1, 2 * BLOCK);
+
+    // Random walk with plateaus so equal values are exercised too
+    std::vector<double> data(SAMPLES);
+    double v = 0.0;
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        if (i % 7) v += noise(rng);
+        data[i] = std::round(v * 4.0) / 4.0;
+    }
+
+    // Correctness: per-sample and random-sized blocks must agree with the deque version at every block end
+    size_t mismatches = 0;
+    for (size_t window : { 1, 2, 16, 164, 1000 }) {
+        CDequeMinMax          ref(window);
+        CRunningAverageMinMax single(window), bulk(window);
+
+        size_t i = 0;
+        while (i < SAMPLES / 10) {
+            size_t n = std::min(blockLen(rng), SAMPLES / 10 - i);
+            for (size_t k = 0; k < n; ++k) {
+                ref.Add(data[i + k]);
+                single.Add(data[i + k]);
+            }
+            bulk.AddRange(std::span<const double>(data.data() + i, n));
+            i += n;
+
+            if (single.GetMin() != ref.GetMin() || single.GetMax() != ref.GetMax() ||
+                bulk.GetMin()   != ref.GetMin() || bulk.GetMax()   != ref.GetMax() ||
+                std::fabs(bulk.GetAverage() - ref.GetAverage()) > 1e-9 * (1.0 + std::fabs(ref.GetAverage())))
+                ++mismatches;
+        }
+    }
+    std::cout << "Mismatches: " << mismatches << "\n";
+
+    // Drift: raw channel counts around 1e9, naive add/subtract sum vs compensated, against an exact window mean
+    {
+        constexpr size_t W = 512;
+        CRunningAverageMinMax ra(W);
+        std::vector<double> ring(W, 0.0);
+        double naive = 0.0, worstNaive = 0.0, worstRa = 0.0;
+
+        for (size_t i = 0; i < SAMPLES; ++i) {
+            double x = 1e9 + 1e6 * std::sin(i * 1e-5) + noise(rng);
+            naive += x - ring[i % W];
+            ring[i % W] = x;
+            ra.Add(x);
+
+            if (i >= W && i % 1000 == 0) {
+                long double exact = 0.0L;
+                for (double r : ring) exact += r;
+                exact /= W;
+                worstNaive = std::max(worstNaive, static_cast<double>(std::fabs(naive / W - exact)));
+                worstRa    = std::max(worstRa   , static_cast<double>(std::fabs(ra.GetAverage() - exact)));
+            }
+        }
+        std::cout << "Mean drift at 1e9: naive " << worstNaive << ",  compensated " << worstRa
+                  << "  (stddev " << ra.GetStdDev() << ")\n";
+    }
+
+    // Timing
+    auto run = [&](auto& ra, bool blocks) {
+        double checksum = 0.0;
+        double start = GetTime();
+        if (blocks) {
+            for (size_t i = 0; i < SAMPLES; i += BLOCK) {
+                ra.AddRange(std::span<const double>(data.data() + i, std::min(BLOCK, SAMPLES - i)));
+                checksum += ra.GetMin() + ra.GetMax() + ra.GetAverage();
+            }
+        }
+        else {
+            for (size_t i = 0; i < SAMPLES; ++i) {
+                ra.Add(data[i]);
+                if (i % BLOCK == BLOCK - 1) checksum += ra.GetMin() + ra.GetMax() + ra.GetAverage();
+            }
+        }
+        double elapsed = GetTime() - start;
+        return std::make_pair(elapsed * 1e9 / SAMPLES, checksum);
+    };
+
+    for (size_t window : { 16, 512, 4096 }) {
+        CDequeMinMax          ref(window);
+        CRunningAverageMinMax single(window), bulk(window);
+
+        auto [tDeque , c0] = run(ref   , false);
+        auto [tRing  , c1] = run(single, false);
+        auto [tBlock , c2] = run(bulk  , true );
+
+        std::cout << "Window " << window << ":  deque " << tDeque << " ns/sample,  ring " << tRing
+                  << " ns/sample,  AddRange(" << BLOCK << ") " << tBlock << " ns/sample"
+                  << "  (checksum " << (c0 + c1 + c2) << ")\n";
+    }
+    std::cout << "\n";
+}
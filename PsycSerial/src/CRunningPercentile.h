@@ -0,0 +1,180 @@
+#pragma once
+#pragma managed(push, off)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <span>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+// Sliding-window order statistics: an indexable skiplist (each link stores how many elements it skips), so insert,
+// remove and "k-th smallest" are all O(log n).  Nodes live in a fixed pool sized from the window; links are
+// indices, not pointers, and nothing is allocated after Reset.
+class CRunningPercentile {
+public:
+    explicit CRunningPercentile(size_t windowSize = 16) {
+        Reset(windowSize);
+    }
+
+    void Reset(size_t windowSize) {
+        const size_t W = windowSize ? windowSize : 1;
+        m_window.assign(W, 0.0);
+        m_head  = 0;
+        m_count = 0;
+
+        m_levels = 1;
+        while ((size_t(1) << m_levels) < W) ++m_levels;
+        ++m_levels;
+
+        const size_t nodes = W + 2;   // + head and nil sentinels
+        m_value.assign(nodes, 0.0);
+        m_next .assign(nodes * m_levels, NIL);
+        m_width.assign(nodes * m_levels, 1);
+        m_value[HEAD] =  -std::numeric_limits<double>::infinity();
+        m_value[NIL]  =   std::numeric_limits<double>::infinity();
+
+        m_free.clear();
+        for (size_t n = nodes; n-- > FIRST; ) m_free.push_back(static_cast<uint32_t>(n));
+    }
+
+    // NaN and the infinities (the sentinels' values) have no rank here and are ignored
+    void Add(double value) {
+        if (!std::isfinite(value)) return;
+        const size_t W = m_window.size();
+        if (m_count == W)
+            Remove(m_window[m_head]);
+        else
+            m_count++;
+
+        Insert(value);
+        m_window[m_head] = value;
+        if (++m_head == W) m_head = 0;
+    }
+
+    void AddRange(std::span<const double> values) {
+        for (double v : values) Add(v);
+    }
+
+    size_t GetCount() const { return m_count; }
+    bool   IsFull()   const { return m_count == m_window.size(); }
+
+    // k-th smallest value in the window, k = 0 .. count-1
+    double GetRank(size_t k) const {
+        if (k >= m_count) return 0.0;
+        uint32_t node = HEAD;
+        size_t   i    = k + 1;
+        for (size_t level = m_levels; level-- > 0; ) {
+            while (Width(node, level) <= i) {
+                i   -= Width(node, level);
+                node = Next(node, level);
+            }
+        }
+        return m_value[node];
+    }
+
+    // p in [0, 1], linear interpolation between closest ranks
+    double GetPercentile(double p) const {
+        if (m_count == 0) return 0.0;
+        const double pos  = std::clamp(p, 0.0, 1.0) * (m_count - 1);
+        const size_t lo   = static_cast<size_t>(pos);
+        const double frac = pos - lo;
+        const double a    = GetRank(lo);
+        return (frac > 0.0) ? a + frac * (GetRank(lo + 1) - a) : a;
+    }
+
+    double GetMedian() const { return GetPercentile(0.5); }
+
+    static void DoTest();
+
+private:
+    static constexpr uint32_t HEAD  = 0;
+    static constexpr uint32_t NIL   = 1;
+    static constexpr uint32_t FIRST = 2;
+
+    std::vector<double>   m_window;   // insertion order, to know what leaves
+    size_t                m_head{};
+    size_t                m_count{};
+
+    size_t                m_levels{};
+    std::vector<double>   m_value;    // per node
+    std::vector<uint32_t> m_next;     // per node * level
+    std::vector<size_t>   m_width;    // per node * level
+    std::vector<uint32_t> m_free;
+    uint64_t              m_rng{ 0x9E3779B97F4A7C15ull };
+
+    uint32_t& Next (uint32_t node, size_t level)       { return m_next [node * m_levels + level]; }
+    uint32_t  Next (uint32_t node, size_t level) const { return m_next [node * m_levels + level]; }
+    size_t&   Width(uint32_t node, size_t level)       { return m_width[node * m_levels + level]; }
+    size_t    Width(uint32_t node, size_t level) const { return m_width[node * m_levels + level]; }
+
+    // Geometric level, p = 1/2
+    size_t RandomLevel() {
+        m_rng ^= m_rng << 13; m_rng ^= m_rng >> 7; m_rng ^= m_rng << 17;
+        return std::min<size_t>(m_levels, 1 + std::countr_zero(m_rng | (uint64_t(1) << 63)));
+    }
+
+    void Insert(double value) {
+        uint32_t chain[64];
+        size_t   steps[64];
+
+        uint32_t node = HEAD;
+        for (size_t level = m_levels; level-- > 0; ) {
+            steps[level] = 0;
+            while (m_value[Next(node, level)] <= value) {
+                steps[level] += Width(node, level);
+                node = Next(node, level);
+            }
+            chain[level] = node;
+        }
+
+        const uint32_t n = m_free.back();
+        m_free.pop_back();
+        m_value[n] = value;
+
+        const size_t d = RandomLevel();
+        size_t skipped = 0;
+        for (size_t level = 0; level < d; ++level) {
+            uint32_t prev = chain[level];
+            Next (n, level)    = Next(prev, level);
+            Next (prev, level) = n;
+            Width(n, level)    = Width(prev, level) - skipped;
+            Width(prev, level) = skipped + 1;
+            skipped += steps[level];
+        }
+        for (size_t level = d; level < m_levels; ++level) {
+            Width(chain[level], level) += 1;
+            Next(n, level) = NIL;
+        }
+    }
+
+    // Any node holding an equal value will do
+    void Remove(double value) {
+        uint32_t chain[64];
+
+        uint32_t node = HEAD;
+        for (size_t level = m_levels; level-- > 0; ) {
+            while (m_value[Next(node, level)] < value)
+                node = Next(node, level);
+            chain[level] = node;
+        }
+
+        const uint32_t victim = Next(chain[0], 0);
+        if (victim == NIL || m_value[victim] != value) return;
+
+        for (size_t level = 0; level < m_levels; ++level) {
+            uint32_t prev = chain[level];
+            if (Next(prev, level) == victim) {
+                Width(prev, level) += Width(victim, level) - 1;
+                Next (prev, level)  = Next(victim, level);
+            }
+            else
+                Width(prev, level) -= 1;
+        }
+        m_free.push_back(victim);
+    }
+};
+
+#pragma managed(pop)
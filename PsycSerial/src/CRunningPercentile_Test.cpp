@@ -0,0 +1,104 @@
+#include "CRunningPercentile.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+constexpr size_t SAMPLES = 200'000;
+constexpr size_t NAIVE   =  20'000;   // sort-per-window is timed on fewer samples
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// Reference: copy the window and nth_element it for every sample
+static double NaivePercentile(const std::vector<double>& ring, size_t count, double p, std::vector<double>& scratch)
+{
+    scratch.assign(ring.begin(), ring.begin() + count);
+    const double pos  = p * (count - 1);
+    const size_t lo   = static_cast<size_t>(pos);
+    const double frac = pos - lo;
+    std::nth_element(scratch.begin(), scratch.begin() + lo, scratch.end());
+    double a = scratch[lo];
+    if (frac <= 0.0) return a;
+    double b = *std::min_element(scratch.begin() + lo + 1, scratch.end());
+    return a + frac * (b - a);
+}
+
+
+void CRunningPercentile::DoTest()
+{
+    std::cout << "=== CRunningPercentile test ===\n";
+
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    // Noisy signal with steps (gain/offset changes), quantised so duplicates are common
+    std::vector<double> data(SAMPLES);
+    double level = 0.0;
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        if (i % 5000 == 0) level = 100.0 * noise(rng);
+        data[i] = std::round((level + noise(rng)) * 8.0) / 8.0;
+    }
+
+    std::vector<double> scratch;
+
+    // Correctness against the naive version, including the filling phase
+    size_t mismatches = 0;
+    for (size_t window : { 1, 2, 3, 64, 257 }) {
+        CRunningPercentile rp(window);
+        std::vector<double> ring(window);
+        size_t count = 0;
+        for (size_t i = 0; i < 20'000; ++i) {
+            rp.Add(data[i]);
+            ring[i % window] = data[i];
+            count = std::min(count + 1, window);
+            for (double p : { 0.0, 0.1, 0.5, 0.9, 1.0 })
+                if (std::fabs(rp.GetPercentile(p) - NaivePercentile(ring, count, p, scratch)) > 1e-12) ++mismatches;
+        }
+    }
+    std::cout << "Mismatches: " << mismatches << "\n";
+
+    // Non-finite samples are skipped: +inf once walked onto the nil sentinel and never returned
+    {
+        CRunningPercentile rp(4);
+        const double inf = std::numeric_limits<double>::infinity();
+        for (double v : { 1.0, inf, 2.0, -inf, std::nan(""), 3.0 }) rp.Add(v);
+        std::cout << "Non-finite skipped: count " << rp.GetCount() << ", median " << rp.GetMedian() << " (3, 2)\n";
+    }
+
+    // Timing: median per sample, skiplist vs sort-per-window
+    for (size_t window : { 64, 512, 2048, 8192 }) {
+        double checksum = 0.0;
+
+        CRunningPercentile rp(window);
+        double start = GetTime();
+        for (size_t i = 0; i < SAMPLES; ++i) {
+            rp.Add(data[i]);
+            checksum += rp.GetMedian();
+        }
+        double tSkip = GetTime() - start;
+
+        std::vector<double> ring(window);
+        size_t count = 0;
+        start = GetTime();
+        for (size_t i = 0; i < NAIVE; ++i) {
+            ring[i % window] = data[i];
+            count = std::min(count + 1, window);
+            scratch.assign(ring.begin(), ring.begin() + count);
+            std::sort(scratch.begin(), scratch.end());
+            checksum += (count & 1) ? scratch[count / 2] : 0.5 * (scratch[count / 2 - 1] + scratch[count / 2]);
+        }
+        double tSort = GetTime() - start;
+
+        tSkip *= 1e9 / SAMPLES;
+        tSort *= 1e9 / NAIVE;
+        std::cout << "Window " << window << ":  skiplist " << tSkip << " ns/sample,  sort " << tSort
+                  << " ns/sample  (x" << tSort / tSkip << ", checksum " << checksum << ")\n";
+    }
+    std::cout << "\n";
+}
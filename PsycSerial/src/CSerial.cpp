@@ -1,6 +1,9 @@
 #include "CSerial.h"
 #pragma managed(push, off)
 #include "Packets/CDecoder.h"
+#include "Packets/CEncoder.h"
+#include "CHostClock.h"
+#include "CTrace.h"
 
 #include <chrono>
 #include <thread>
@@ -8,8 +11,7 @@
 #include <memory>
 #include <atomic>
 #include <sstream>
-
-static CDecoder decoder;
+#include <algorithm>
 
 #include <stdexcept> // Include for std::exception
 
@@ -38,12 +40,14 @@ CSerial::CSerial()
 	, m_mutex()
 	, m_readLoopRunning(false)
 	, m_decodedPacket(new CDecodedPacket()) // Allocate decodedPacket
+	, m_decoder(new CDecoder())
 { }
 
 
 CSerial::~CSerial() {
+    Close();  // Ensure proper cleanup; the read thread is gone after this
     delete m_decodedPacket;
-    Close();  // Ensure proper cleanup
+    delete m_decoder;
 }
 
 
@@ -111,11 +115,18 @@ void CSerial::InvokeDataReceived(CPacket& packet) {
 	CDecodedPacket& dataPacket = *m_decodedPacket;  // single reusable decoded packet
 
     for (;;) {
-        auto kind = decoder.process(packet, dataPacket);
+        auto kind = m_decoder->process(packet, dataPacket);
         if (kind == PacketKind::Unknown)
             break;
         packet.bytesRead = 0; // Mark as consumed
 
+        dataPacket.traceId = 0;
+        if (CTrace::IsOn()) {
+            dataPacket.traceId = CTrace::NextId();
+            CTrace::Record(CTrace::Point::Read, dataPacket.traceId, static_cast<uint8_t>(kind), packet.readTicks ? packet.readTicks : CTrace::Ticks());
+            CTrace::Record(CTrace::Point::Decode, dataPacket.traceId, static_cast<uint8_t>(kind));
+        }
+
 		// Ignore lone carriage return text packets
         if (kind == PacketKind::Text && dataPacket.text.length == 1 && dataPacket.text.utf8Bytes[0] == '\r')
             continue;
@@ -123,6 +134,22 @@ void CSerial::InvokeDataReceived(CPacket& packet) {
         if (kind == PacketKind::Block && dataPacket.block.state == CDataPacket::STATE_UNSET)
             continue;
 
+        bool consumed = false;
+        {
+            std::lock_guard<std::mutex> lock(m_stageMutex);
+            for (CPacketStage* stage : m_stages) {
+                try {
+                    stage->Process(dataPacket);
+                    consumed |= stage->Consumes(dataPacket);
+                }
+                catch (const std::exception& e) {
+                    OutputDebugStringA("CSerial: Exception caught in packet stage: ");
+                    OutputDebugStringA(e.what());
+                    OutputDebugStringA("\r\n");
+                }
+            }
+        }
+
 /*      if (kind == PacketKind::Text)
         {
 			char* debugBuffer = new char[dataPacket.text.length + 3];
@@ -136,26 +163,79 @@ void CSerial::InvokeDataReceived(CPacket& packet) {
 			delete[] debugBuffer;
         }
 */
-        // Invoke outside the lock
-        if (handler) {
-            try {
-				handler(context, this, dataPacket); // call hander with reusable packet reference
-            }
-            catch (const std::exception& e) {
-                OutputDebugStringA("CSerial: Exception caught during DataReceived callback: ");
-                OutputDebugStringA(e.what());
-                OutputDebugStringA("\r\n");
-                // Optionally invoke error handler here if desired, carefully
-                // InvokeErrorOccurred(std::runtime_error("Exception in DataReceived callback: " + std::string(e.what())));
-            }
-            catch (...) {
-                OutputDebugStringA("CSerial: Unknown exception caught during DataReceived callback.\r\n");
-                // InvokeErrorOccurred(std::runtime_error("Unknown exception in DataReceived callback"));
+        if (consumed)
+            continue;
+
+        // Invoke outside the lock.  Managed code takes telemetry one key at a time, so a batch no stage consumed is
+        // passed on as a Telemetry packet per entry.
+        if (kind == PacketKind::TelemetryBatch) {
+            const CTelemetryBatch batch = dataPacket.telemetryBatch;  // the union member is reused below
+            dataPacket.kind = PacketKind::Telemetry;
+            for (uint32_t i = 0; i < batch.count; ++i) {
+                CTelemetryPacket& t = dataPacket.telemetry;
+                t.timeStamp = batch.timeStamp;
+                t.key       = batch.entries[i].key;
+                t.group     = static_cast<uint8_t >(t.key);
+                t.subGroup  = static_cast<uint8_t >(t.key >> 8);
+                t.id        = static_cast<uint16_t>(t.key >> 16);
+                t.value     = batch.entries[i].value;
+                if (dataPacket.traceId && i > 0) {   // each entry is its own managed packet: trace it as one
+                    dataPacket.traceId = CTrace::NextId();
+                    CTrace::Record(CTrace::Point::Read, dataPacket.traceId, static_cast<uint8_t>(PacketKind::Telemetry), packet.readTicks ? packet.readTicks : CTrace::Ticks());
+                    CTrace::Record(CTrace::Point::Decode, dataPacket.traceId, static_cast<uint8_t>(PacketKind::Telemetry));
+                }
+                InvokeDataHandler(handler, context, dataPacket);
             }
+            continue;
         }
+
+        InvokeDataHandler(handler, context, dataPacket);
 	}
 }
 
+void CSerial::InvokeDataHandler(DataHandler handler, void* context, const CDecodedPacket& packet) {
+    if (!handler)
+        return;
+
+    if (packet.traceId)
+        CTrace::Record(CTrace::Point::Callback, packet.traceId);
+
+    try {
+		handler(context, this, packet); // call hander with reusable packet reference
+    }
+    catch (const std::exception& e) {
+        OutputDebugStringA("CSerial: Exception caught during DataReceived callback: ");
+        OutputDebugStringA(e.what());
+        OutputDebugStringA("\r\n");
+        // Optionally invoke error handler here if desired, carefully
+        // InvokeErrorOccurred(std::runtime_error("Exception in DataReceived callback: " + std::string(e.what())));
+    }
+    catch (...) {
+        OutputDebugStringA("CSerial: Unknown exception caught during DataReceived callback.\r\n");
+        // InvokeErrorOccurred(std::runtime_error("Unknown exception in DataReceived callback"));
+    }
+}
+
+void CSerial::AddStage(CPacketStage* stage) {
+    if (!stage) return;
+    std::lock_guard<std::mutex> lock(m_stageMutex);
+    if (std::find(m_stages.begin(), m_stages.end(), stage) == m_stages.end())
+        m_stages.push_back(stage);
+}
+
+void CSerial::RemoveStage(CPacketStage* stage) {
+    std::lock_guard<std::mutex> lock(m_stageMutex);
+    m_stages.erase(std::remove(m_stages.begin(), m_stages.end(), stage), m_stages.end());
+}
+
+void CSerial::SetBlockCapacity(size_t maxItems, size_t maxEvents) {
+    m_decoder->setBlockCapacity(maxItems, maxEvents);  // applied by the read thread before its next frame
+}
+
+uint64_t CSerial::GetDroppedBlocks() const {
+    return m_decoder->droppedBlocks();
+}
+
 bool CSerial::SetPort(const std::string& portName, DataHandler dataHandler, void* userData, int baudRate) {
 
     static constexpr int RETRIES = 10;
@@ -306,7 +386,10 @@ void CSerial::ReadLoop()
 
     std::vector<BYTE> buffer(READ_BUFFER_SIZE);
 
-    const auto start = std::chrono::steady_clock::now();
+    // Last time the driver queue was seen empty, or a read took all of it: the bytes of the next read arrived
+    // after this.  Only an estimate of when the first of them did, but a bounded one.
+    const int64_t startNs = CHostClock::NowNs();
+    int64_t drainedNs = startNs;
 
     for (;;) {
         // Cooperative shutdown
@@ -366,6 +449,7 @@ void CSerial::ReadLoop()
         }
         if (queued == 0) {
             // Nothing buffered right now  short pause to avoid busy-spin
+            drainedNs = CHostClock::NowNs();
                std::this_thread::sleep_for(std::chrono::milliseconds(1));
             continue;
         }
@@ -448,9 +532,12 @@ void CSerial::ReadLoop()
 
         // Build and dispatch the packet (no locks held during callback)
         CPacket pkt{};
-        auto now = std::chrono::steady_clock::now();
-        pkt.timestamp = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count());
+        pkt.readNs    = CHostClock::NowNs();
+        pkt.readTicks = CTrace::IsOn() ? CTrace::Ticks() : 0;
+        pkt.spanNs    = pkt.readNs - drainedNs;
+        pkt.startNs   = startNs;
         pkt.bytesRead = bytesRead;
+        if (bytesRead >= queued) drainedNs = pkt.readNs;
         pkt.data.assign(buffer.begin(), buffer.begin() + bytesRead);
 
         InvokeDataReceived(pkt);
@@ -464,6 +551,16 @@ void CSerial::ReadLoop()
 
 
 
+uint32_t CSerial::SendCommand(uint16_t code, uint16_t parameter, double value)
+{
+    uint32_t requestId = m_nextRequestId.fetch_add(1, std::memory_order_relaxed);
+    if (requestId == 0) requestId = m_nextRequestId.fetch_add(1, std::memory_order_relaxed);  // 0 is the failure value
+
+    std::vector<uint8_t> frame;
+    CEncoder::encodeCommand(CCommandPacket{ requestId, code, parameter, value }, frame);
+    return Write(frame.data(), 0, static_cast<DWORD>(frame.size())) ? requestId : 0;
+}
+
 bool CSerial::Write(const std::string& data) {
     // Forward to byte array version
     return Write(reinterpret_cast<const BYTE*>(data.c_str()), 0, static_cast<DWORD>(data.length()));
@@ -613,7 +710,13 @@ void CSerial::Clear()
         if (m_isOpen && m_hSerial.get() != INVALID_HANDLE_VALUE) 
             PurgeComm(m_hSerial.get(), PURGE_RXCLEAR | PURGE_TXCLEAR | PURGE_RXABORT | PURGE_TXABORT);
         
-        decoder.reset();
+        m_decoder->reset();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_stageMutex);
+        for (CPacketStage* stage : m_stages)
+            stage->Reset();
     }
 }
 
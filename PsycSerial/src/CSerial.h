@@ -2,6 +2,7 @@
 #pragma managed(push, off)
 #include "CHandleGuard.h"
 #include "Packets/CPackets.h"
+#include "Processing/CPacketStage.h"
 
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
@@ -13,6 +14,8 @@
 #include <atomic>  // Include atomic for m_stopReadLoop
 #include <stdexcept> // Include for std::exception
 
+class CDecoder;
+
 class CSerial {
 public:
     
@@ -32,6 +35,10 @@ public:
     bool Write(const std::string& data);
     bool Write(const BYTE* data, DWORD offset, DWORD count);
 
+    // Writes a Command frame (CCommandPacket).  Returns its request id, which the device echoes in its reply,
+    // or 0 if the write failed.
+    uint32_t SendCommand(uint16_t code, uint16_t parameter, double value);
+
     void Clear();
 
     bool Close();
@@ -50,6 +57,17 @@ public:
         m_errorHandler = handler;
     }
 
+    // Native stages run on the read thread for every packet, in registration order, before the DataHandler.
+    // A packet any stage Consumes() is not passed to the DataHandler.
+    // Not owned.  RemoveStage waits for any in-flight Process call, after which the stage may be deleted.
+    void AddStage(CPacketStage* stage);
+    void RemoveStage(CPacketStage* stage);
+
+    // Block frames are decoded into storage of this many samples / events, from the handshake.  Larger frames
+    // (and corrupt packed ones) are dropped; GetDroppedBlocks counts them.
+    void     SetBlockCapacity(size_t maxItems, size_t maxEvents);
+    uint64_t GetDroppedBlocks() const;
+
     static const int DEFAULT_BAUDRATE = 57600 * 16;
 
 private:
@@ -80,8 +98,15 @@ private:
     void InvokeConnectionChanged(bool state);
     void InvokeErrorOccurred(const std::exception& ex);
     void InvokeDataReceived(CPacket& packet);
+    void InvokeDataHandler(DataHandler handler, void* context, const CDecodedPacket& packet);
 
     CDecodedPacket* m_decodedPacket;
+    CDecoder*       m_decoder;        // one per port: each read thread decodes its own stream
+
+    std::atomic<uint32_t> m_nextRequestId{ 1 };
+
+    std::mutex                 m_stageMutex;
+    std::vector<CPacketStage*> m_stages;
 };
 
 #pragma managed(pop)
@@ -0,0 +1,191 @@
+#include "CTrace.h"
+#pragma managed(push, off)
+
+#include "CHostClock.h"
+#include "Packets/CPackets.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define TRACE_TSC 1
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+#endif
+
+
+std::atomic<bool>     CTrace::s_on{ false };
+std::atomic<uint32_t> CTrace::s_nextId{ 1 };
+std::atomic<uint64_t> CTrace::s_dropped{ 0 };
+
+namespace
+{
+    struct Stamp {
+        uint64_t ticks;
+        uint32_t id;
+        uint8_t  point;
+        uint8_t  kind;
+    };
+
+    struct Ring {
+        std::atomic<uint64_t> head{ 0 };   // stamps ever written; only the owner stores it
+        Stamp                 stamps[CTrace::RING_SIZE];
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> owner{ 0 };       // hashed thread id, 0 = free
+        std::atomic<Ring*>    ring{ nullptr };  // kept for the process: a thread that ends leaves its stamps
+    };
+
+    Slot     g_slots[CTrace::MAX_THREADS];
+    uint64_t g_startTicks = 0, g_stopTicks = 0;
+    int64_t  g_startNs    = 0, g_stopNs    = 0;
+
+    uint64_t ThreadKey()
+    {
+        return std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+    }
+
+    // The calling thread's ring; claimed on its first stamp (the only allocation), nullptr if all are taken
+    Ring* ThisRing()
+    {
+        const uint64_t key = ThreadKey();
+        for (size_t i = 0; i < CTrace::MAX_THREADS; ++i) {
+            Slot& slot = g_slots[(key + i) % CTrace::MAX_THREADS];
+            uint64_t owner = slot.owner.load(std::memory_order_acquire);
+            if (owner == 0 && slot.owner.compare_exchange_strong(owner, key, std::memory_order_acq_rel)) {
+                Ring* ring = new (std::nothrow) Ring;
+                slot.ring.store(ring, std::memory_order_release);
+                return ring;
+            }
+            if (owner == key) return slot.ring.load(std::memory_order_acquire);
+        }
+        return nullptr;
+    }
+
+    const char* PointName(uint8_t point)
+    {
+        static const char* const names[] = { "read", "decode", "native callback", "convert", "dequeue", "consumers" };
+        return point < std::size(names) ? names[point] : "?";
+    }
+
+    const char* KindName(uint8_t kind)
+    {
+        static const char* const names[] = { "Unknown", "Data", "Block", "Telemetry", "Text", "TelemetryBatch", "Command" };
+        return kind < std::size(names) ? names[kind] : "?";
+    }
+}
+
+
+uint64_t CTrace::Ticks() noexcept
+{
+#ifdef TRACE_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(CHostClock::NowNs());
+#endif
+}
+
+void CTrace::Start()
+{
+    s_on.store(false, std::memory_order_relaxed);
+    for (Slot& slot : g_slots)
+        if (Ring* ring = slot.ring.load(std::memory_order_acquire)) ring->head.store(0, std::memory_order_relaxed);
+    s_dropped.store(0, std::memory_order_relaxed);
+    s_nextId.store(1, std::memory_order_relaxed);
+
+    g_startNs    = CHostClock::NowNs();
+    g_startTicks = Ticks();
+    g_stopNs     = 0;
+    s_on.store(true, std::memory_order_release);
+}
+
+void CTrace::Stop()
+{
+    s_on.store(false, std::memory_order_release);
+    g_stopNs    = CHostClock::NowNs();
+    g_stopTicks = Ticks();
+}
+
+void CTrace::Record(Point point, uint32_t id, uint8_t kind, uint64_t ticks) noexcept
+{
+    Ring* ring = ThisRing();
+    if (!ring) { s_dropped.fetch_add(1, std::memory_order_relaxed); return; }
+
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    ring->stamps[head & (RING_SIZE - 1)] = Stamp{ ticks, id, static_cast<uint8_t>(point), kind };
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+std::string CTrace::ToChromeJson()
+{
+    struct Entry { Stamp s; uint32_t tid; };
+    std::vector<Entry> all;
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+                      "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{\"name\":\"PsycSerial\"}}";
+
+    for (uint32_t t = 0; t < MAX_THREADS; ++t) {
+        const Ring* ring = g_slots[t].ring.load(std::memory_order_acquire);
+        if (!ring) continue;
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        const uint64_t n    = std::min<uint64_t>(head, RING_SIZE);
+        uint8_t first = static_cast<uint8_t>(Point::COUNT);
+        for (uint64_t i = head - n; i < head; ++i) {
+            const Stamp& s = ring->stamps[i & (RING_SIZE - 1)];
+            all.push_back(Entry{ s, t + 1 });
+            first = std::min(first, s.point);
+        }
+        if (n == 0) continue;
+        char buf[160];
+        std::snprintf(buf, sizeof buf, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+                      t + 1, first <= static_cast<uint8_t>(Point::Convert) ? "serial read" : "callbacks", t + 1);
+        out += buf;
+    }
+
+    // Ticks to microseconds since Start, from the host clock over the same interval
+    const int64_t  endNs    = g_stopNs ? g_stopNs    : CHostClock::NowNs();
+    const uint64_t endTicks = g_stopNs ? g_stopTicks : Ticks();
+    const double   perUs    = endNs > g_startNs ? double(endTicks - g_startTicks) / (double(endNs - g_startNs) * 1e-3) : 1e3;
+    auto us = [&](uint64_t ticks) { return double(int64_t(ticks - g_startTicks)) / perUs; };
+
+    std::sort(all.begin(), all.end(), [](const Entry& a, const Entry& b) {
+        return a.s.id != b.s.id ? a.s.id < b.s.id : a.s.ticks < b.s.ticks;
+    });
+
+    char buf[256];
+    for (size_t begin = 0, end; begin < all.size(); begin = end) {
+        uint8_t kind = 0;
+        for (end = begin; end < all.size() && all[end].s.id == all[begin].s.id; ++end) kind = std::max(kind, all[end].s.kind);
+        if (all[begin].s.id == 0 || end - begin < 2) continue;
+
+        // One slice per hop, named for where it ended
+        for (size_t i = begin + 1; i < end; ++i) {
+            std::snprintf(buf, sizeof buf,
+                ",\n{\"ph\":\"X\",\"name\":\"%s\",\"cat\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"id\":%u}}",
+                PointName(all[i].s.point), KindName(kind), all[i].tid, us(all[i - 1].s.ticks),
+                us(all[i].s.ticks) - us(all[i - 1].s.ticks), all[i].s.id);
+            out += buf;
+        }
+
+        // An arrow from the first hop to the last when the frame changed threads
+        if (all[begin + 1].tid != all[end - 1].tid) {
+            std::snprintf(buf, sizeof buf,
+                ",\n{\"ph\":\"s\",\"name\":\"frame\",\"cat\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"id\":%u}"
+                ",\n{\"ph\":\"f\",\"bp\":\"e\",\"name\":\"frame\",\"cat\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"id\":%u}",
+                KindName(kind), all[begin + 1].tid, us(all[begin].s.ticks), all[begin].s.id,
+                KindName(kind), all[end - 1].tid, us(all[end - 2].s.ticks), all[begin].s.id);
+            out += buf;
+        }
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+#pragma managed(pop)
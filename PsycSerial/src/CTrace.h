@@ -0,0 +1,55 @@
+#pragma once
+#pragma managed(push, off)
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Where a frame's time goes between the device and the screen.  Each traced frame gets an id at decode and is
+// stamped at every Point it passes, on whichever thread it is on then.  Stamps are TSC ticks (invariant on every
+// x86 this runs on; CHostClock ns elsewhere), written to a ring per thread that only that thread writes, so
+// recording takes no lock.  Rings keep the last RING_SIZE stamps of their thread.
+//
+// Off (the default) a tracepoint is one relaxed load and a branch: call sites test IsOn() before anything else.
+// ToChromeJson gives chrome://tracing / Perfetto trace events: one slice per hop, on the thread that ended it, and
+// a flow arrow following each frame across threads.  Take it after Stop(); while on, the newest stamps may be torn.
+class CTrace
+{
+public:
+    enum class Point : uint8_t {
+        Read,       // the read that completed the frame returned (CPacket::readTicks)
+        Decode,     // the decoder returned it
+        Callback,   // stages done, native data handler called
+        Convert,    // managed packet made (Decoder::Convert)
+        Dequeue,    // callback worker took it from the queue
+        Return,     // the DataReceived consumers returned
+        COUNT
+    };
+
+    static constexpr size_t RING_SIZE   = 1 << 16;   // stamps per thread, power of two
+    static constexpr size_t MAX_THREADS = 32;         // stamps from more threads than this are dropped
+
+    static bool IsOn() noexcept { return s_on.load(std::memory_order_relaxed); }
+
+    static void Start();   // clears what was recorded
+    static void Stop();
+
+    static uint64_t Ticks() noexcept;
+    static uint32_t NextId() noexcept { return s_nextId.fetch_add(1, std::memory_order_relaxed); }
+
+    // kind is the frame's PacketKind where known; 0 elsewhere, the dump takes it from the frame's other stamps
+    static void Record(Point point, uint32_t id, uint8_t kind, uint64_t ticks) noexcept;
+    static void Record(Point point, uint32_t id, uint8_t kind = 0) noexcept { Record(point, id, kind, Ticks()); }
+
+    static std::string ToChromeJson();
+    static uint64_t    GetDropped() noexcept { return s_dropped.load(std::memory_order_relaxed); }
+
+    static void DoTest();
+
+private:
+    static std::atomic<bool>     s_on;
+    static std::atomic<uint32_t> s_nextId;
+    static std::atomic<uint64_t> s_dropped;
+};
+
+#pragma managed(pop)
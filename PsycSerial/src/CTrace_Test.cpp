@@ -0,0 +1,122 @@
+#include "CTrace.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+static size_t Count(const std::string& s, const std::string& what)
+{
+    size_t n = 0;
+    for (size_t at = s.find(what); at != std::string::npos; at = s.find(what, at + what.size())) ++n;
+    return n;
+}
+
+// The receive path in miniature: a read thread stamps each frame up to Convert and queues it, a worker takes it
+// off, "raises" it and stamps Dequeue / Return, as SerialHelper and ManagedCallbacks do
+static void RunPipeline(uint32_t frames)
+{
+    std::mutex              mutex;
+    std::condition_variable cv;
+    std::deque<uint32_t>    queue;
+    bool                    done = false;
+
+    std::thread worker([&] {
+        for (;;) {
+            uint32_t id;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return done || !queue.empty(); });
+                if (queue.empty()) return;
+                id = queue.front();
+                queue.pop_front();
+            }
+            if (CTrace::IsOn()) CTrace::Record(CTrace::Point::Dequeue, id);
+            const double until = GetTime() + 20e-6;   // the consumers
+            while (GetTime() < until) {}
+            if (CTrace::IsOn()) CTrace::Record(CTrace::Point::Return, id);
+        }
+    });
+
+    for (uint32_t i = 0; i < frames; ++i) {
+        const uint64_t read = CTrace::Ticks();
+        uint32_t id = 0;
+        if (CTrace::IsOn()) {
+            id = CTrace::NextId();
+            CTrace::Record(CTrace::Point::Read, id, 2, read);
+            CTrace::Record(CTrace::Point::Decode, id, 2);
+            CTrace::Record(CTrace::Point::Callback, id);
+            CTrace::Record(CTrace::Point::Convert, id);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(id);
+        }
+        cv.notify_one();
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    cv.notify_one();
+    worker.join();
+}
+
+
+void CTrace::DoTest()
+{
+    std::cout << "=== CTrace test ===\n";
+
+    // Off: nothing is recorded
+    RunPipeline(100);
+    std::cout << "Off: " << Count(ToChromeJson(), "\"ph\":\"X\"") << " slices\n";
+
+    const uint32_t FRAMES = 2000;
+    Start();
+    RunPipeline(FRAMES);
+    Stop();
+    const std::string json = ToChromeJson();
+    std::cout << "On, " << FRAMES << " frames: " << Count(json, "\"ph\":\"X\"") << " slices (5 per frame), "
+              << Count(json, "\"ph\":\"s\"") << " flows, " << Count(json, "thread_name") << " threads, "
+              << Count(json, "\"cat\":\"Block\"") << " Block events, " << json.size() / 1024 << " KB, dropped "
+              << GetDropped() << "\n";
+    const size_t slice = json.find("\"ph\":\"X\"");
+    std::cout << json.substr(json.rfind('{', slice), json.find('}', slice) - json.rfind('{', slice) + 2) << "\n";
+
+    // A ring keeps the newest RING_SIZE stamps of its thread
+    Start();
+    for (uint32_t i = 1; i <= RING_SIZE; ++i) { Record(Point::Read, i, 2); Record(Point::Decode, i, 2); }
+    Stop();
+    std::cout << "Ring of " << RING_SIZE << " after " << 2 * RING_SIZE << " stamps: " << Count(ToChromeJson(), "\"ph\":\"X\"")
+              << " slices\n";
+
+    // Cost of a tracepoint, off and on
+    const int N = 10'000'000;
+    double start = GetTime();
+    uint32_t sum = 0;
+    for (int i = 0; i < N; ++i)
+        if (IsOn()) Record(Point::Decode, uint32_t(i)); else ++sum;
+    const double tOff = (GetTime() - start) / N;
+
+    Start();
+    start = GetTime();
+    for (int i = 0; i < N; ++i)
+        if (IsOn()) Record(Point::Decode, uint32_t(i));
+    const double tOn = (GetTime() - start) / N;
+    Stop();
+    Start();   // leave nothing behind
+    Stop();
+    std::cout << "Tracepoint: off " << tOff * 1e9 << " ns, on " << tOn * 1e9 << " ns (" << (sum & 1) << ")\n";
+    std::cout << "\n";
+}
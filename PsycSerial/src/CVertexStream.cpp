@@ -0,0 +1,105 @@
+#include "CVertexStream.h"
+#pragma managed(push, off)
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define VERTEXSTREAM_SSE2 1
+#endif
+
+
+const double* CVertexStream::FieldValues(const CBlockColumns& block, Field field, size_t first, size_t count, double* scratch)
+{
+    const uint64_t* hw = block.hardwareState + first;
+    const uint32_t* ss = block.sensorState   + first;
+    const uint32_t* c0 = block.channel[0]    + first;
+
+    // Bit positions as in DataPacket
+    auto bits = [&](const uint64_t* src, int shift, uint64_t mask) {
+        for (size_t i = 0; i < count; ++i) scratch[i] = static_cast<double>((src[i] >> shift) & mask);
+        return scratch;
+    };
+    auto bits32 = [&](const uint32_t* src, int shift, uint32_t mask) {
+        for (size_t i = 0; i < count; ++i) scratch[i] = static_cast<double>((src[i] >> shift) & mask);
+        return scratch;
+    };
+
+    switch (field) {
+        case Field::Timestamp:     return block.stateTime + first;
+        case Field::C0:            for (size_t i = 0; i < count; ++i) scratch[i] = static_cast<double>(c0[i]);
+                                   return scratch;
+        case Field::Stage1_Mid:    return bits(hw, 56, 0xFF);
+        case Field::Stage1_Top:    return bits(hw, 48, 0xFF);
+        case Field::Stage1_Bot:    return bits(hw, 40, 0xFF);
+        case Field::Stage2_Offset: return bits(hw, 24, 0xFF);
+        case Field::Stage2_Gain:   return bits(hw, 16, 0xFF);
+        case Field::Stage1_Sensor: return bits32(ss, 16, 0xFFFF);
+        case Field::Stage2_Sensor: return bits32(ss,  0, 0xFFFF);
+        default:                   return nullptr;
+    }
+}
+
+size_t CVertexStream::Generate(const CBlockColumns& block, size_t first, size_t count, const Params& params,
+                               Vertex* dest, size_t capacity)
+{
+    if (first >= block.count) return 0;
+    count = std::min({ count, static_cast<size_t>(block.count) - first, capacity });
+    if (count == 0) return 0;
+
+    // Block size follows the handshake, so the y values go through the scratch buffer a chunk at a time
+    for (size_t done = 0; done < count; done += SCRATCH_SIZE)
+        if (!GenerateChunk(block, first + done, std::min(count - done, SCRATCH_SIZE), params, dest + done)) return 0;
+    return count;
+}
+
+bool CVertexStream::GenerateChunk(const CBlockColumns& block, size_t first, size_t count, const Params& params, Vertex* dest)
+{
+    double scratch[SCRATCH_SIZE];
+    const double* ys = FieldValues(block, params.field, first, count, scratch);
+    if (!ys) return false;
+
+    const double* xs = (params.xSource == XSource::StateTime ? block.stateTime : block.sampleTime) + first;
+    const float*  c  = params.colour;
+    size_t i = 0;
+
+#ifdef VERTEXSTREAM_SSE2
+    // Two samples per step: subtract / scale in double, narrow to float, then interleave into (x, y, 0, 1)
+    const __m128d origin = _mm_set1_pd(params.originX);
+    const __m128d scale  = _mm_set1_pd(params.scale);
+    const __m128  zw     = _mm_setr_ps(0.0f, 1.0f, 0.0f, 1.0f);
+    const __m128  normal = _mm_setr_ps(0.0f, 0.0f, 1.0f, 0.0f);
+    const __m128  colour = _mm_loadu_ps(c);
+    const __m128  uv     = _mm_setzero_ps();
+
+    for (; i + 2 <= count; i += 2) {
+        const __m128 fx = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(xs + i), origin));
+        const __m128 fy = _mm_cvtpd_ps(_mm_mul_pd(_mm_loadu_pd(ys + i), scale));
+        const __m128 xy = _mm_unpacklo_ps(fx, fy);                   // x0 y0 x1 y1
+
+        float* v0 = reinterpret_cast<float*>(dest + i);
+        float* v1 = reinterpret_cast<float*>(dest + i + 1);
+        _mm_storeu_ps(v0,      _mm_movelh_ps(xy, zw));              // x0 y0 0 1
+        _mm_storeu_ps(v0 +  4, normal);
+        _mm_storeu_ps(v0 +  8, colour);
+        _mm_storeu_ps(v0 + 12, uv);
+        _mm_storeu_ps(v1,      _mm_movehl_ps(zw, xy));              // x1 y1 0 1
+        _mm_storeu_ps(v1 +  4, normal);
+        _mm_storeu_ps(v1 +  8, colour);
+        _mm_storeu_ps(v1 + 12, uv);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        dest[i] = Vertex{
+            { static_cast<float>(xs[i] - params.originX), static_cast<float>(ys[i] * params.scale), 0.0f, 1.0f },
+            { 0.0f, 0.0f, 1.0f, 0.0f },
+            { c[0], c[1], c[2], c[3] },
+            { 0.0f, 0.0f },
+            { 0.0f, 0.0f },
+        };
+    }
+    return true;
+}
+
+#pragma managed(pop)
@@ -0,0 +1,63 @@
+#pragma once
+#pragma managed(push, off)
+
+#include "Packets/CBlockColumns.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// GPU-ready vertices straight from a block's columns.  The layout matches the plotter's Vertex (position, normal,
+// colour, uv0, uv1; 64 bytes).  x is the sample time minus originX, so it stays small enough for a float however
+// long the session runs; the caller moves the origin and folds it back into its transform.
+class CVertexStream
+{
+public:
+    // Same order as the managed FieldEnum
+    enum class Field : uint32_t {
+        Timestamp,        // stateTime, as DataPacket.get does
+        C0,
+        Events,           // not a per-sample field; generates nothing
+        Stage1_Mid,
+        Stage1_Top,
+        Stage1_Bot,
+        Stage2_Offset,
+        Stage2_Gain,
+        Stage1_Sensor,
+        Stage2_Sensor,
+    };
+
+    enum class XSource : uint32_t { SampleTime, StateTime };
+
+    struct Vertex {
+        float position[4];
+        float normal[4];
+        float colour[4];
+        float uv0[2];
+        float uv1[2];
+    };
+    static_assert(sizeof(Vertex) == 64, "Vertex must match the managed layout");
+
+    struct Params {
+        Field   field   { Field::C0 };
+        XSource xSource { XSource::SampleTime };
+        double  scale   { 1.0 };
+        double  originX { 0.0 };
+        float   colour[4]{ 1.0f, 0.0f, 1.0f, 1.0f };
+    };
+
+    // Writes one vertex per sample in [first, first + count) of the block, up to capacity; returns how many
+    static size_t Generate(const CBlockColumns& block, size_t first, size_t count, const Params& params,
+                           Vertex* dest, size_t capacity);
+
+    static void DoTest();
+
+private:
+    static constexpr size_t SCRATCH_SIZE = 256;
+
+    static bool GenerateChunk(const CBlockColumns& block, size_t first, size_t count, const Params& params, Vertex* dest);
+
+    // y values for the field as doubles in scratch, or a pointer straight into the block when the column already is
+    static const double* FieldValues(const CBlockColumns& block, Field field, size_t first, size_t count, double* scratch);
+};
+
+#pragma managed(pop)
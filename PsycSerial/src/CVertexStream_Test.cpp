@@ -0,0 +1,151 @@
+#include "CVertexStream.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+
+constexpr size_t BLOCKS = 20'000;
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// Reference: what the managed loop does, one packed sample and one field switch at a time
+static double NaiveField(const CDataPacket& s, CVertexStream::Field field)
+{
+    using F = CVertexStream::Field;
+    switch (field) {
+        case F::Timestamp:     return s.stateTime;
+        case F::C0:            return s.channel[0];
+        case F::Stage1_Mid:    return double((s.hardwareState >> 56) & 0xFF);
+        case F::Stage1_Top:    return double((s.hardwareState >> 48) & 0xFF);
+        case F::Stage1_Bot:    return double((s.hardwareState >> 40) & 0xFF);
+        case F::Stage2_Offset: return double((s.hardwareState >> 24) & 0xFF);
+        case F::Stage2_Gain:   return double((s.hardwareState >> 16) & 0xFF);
+        case F::Stage1_Sensor: return double((s.sensorState >> 16) & 0xFFFF);
+        case F::Stage2_Sensor: return double((s.sensorState      ) & 0xFFFF);
+        default:               return 0.0;
+    }
+}
+
+static size_t NaiveGenerate(const CBlockPacket& block, const CVertexStream::Params& p, CVertexStream::Vertex* dest)
+{
+    for (size_t i = 0; i < block.count; ++i) {
+        const CDataPacket& s = block.blockData[i];
+        const double x = (p.xSource == CVertexStream::XSource::StateTime) ? s.stateTime : s.timeStamp;
+        dest[i] = CVertexStream::Vertex{
+            { float(x - p.originX), float(NaiveField(s, p.field) * p.scale), 0.0f, 1.0f },
+            { 0.0f, 0.0f, 1.0f, 0.0f },
+            { p.colour[0], p.colour[1], p.colour[2], p.colour[3] },
+            { 0.0f, 0.0f }, { 0.0f, 0.0f },
+        };
+    }
+    return block.count;
+}
+
+
+void CVertexStream::DoTest()
+{
+    std::cout << "=== CVertexStream test ===\n";
+
+    std::mt19937_64 rng(3);
+    constexpr size_t N = CBlockPacket::MAX_BLOCK_SIZE;
+
+    // A day into a session, 10 us sample spacing
+    std::vector<CDataPacket> samples(N);
+    auto block = std::make_unique<CBlockPacket>();
+    block->count     = N;
+    block->blockData = samples.data();
+    for (size_t i = 0; i < N; ++i) {
+        CDataPacket& s  = block->blockData[i];
+        s.timeStamp     = 86'400.0 + i * 1e-5;
+        s.stateTime     = i * 1e-5;
+        s.hardwareState = rng();
+        s.sensorState   = static_cast<uint32_t>(rng());
+        for (auto& c : s.channel) c = static_cast<uint32_t>(rng());
+    }
+
+    auto columns = std::make_unique<CBlockColumns>();
+    columns->Load(*block);
+
+    std::vector<Vertex> a(N + 8), b(N + 8);
+
+    // Every field, odd and even ranges, against the reference
+    size_t mismatches = 0;
+    for (uint32_t f = 0; f <= static_cast<uint32_t>(Field::Stage2_Sensor); ++f) {
+        if (static_cast<Field>(f) == Field::Events) continue;
+        for (double origin : { 0.0, 86'400.0 }) {
+            Params p{ static_cast<Field>(f), XSource::SampleTime, 0.5, origin, { 0.1f, 0.2f, 0.3f, 1.0f } };
+            const size_t na = NaiveGenerate(*block, p, a.data());
+            for (size_t first : { size_t(0), size_t(1) }) {
+                const size_t nb = Generate(*columns, first, N, p, b.data(), b.size());
+                if (nb != na - first || std::memcmp(a.data() + first, b.data(), nb * sizeof(Vertex)) != 0) ++mismatches;
+            }
+        }
+    }
+    std::cout << "Mismatches: " << mismatches << "\n";
+
+    // A block past the scratch size, as a larger negotiated block size gives, goes through in chunks
+    {
+        constexpr size_t LARGE = 1000;
+        std::vector<CDataPacket> large(LARGE);
+        for (size_t i = 0; i < LARGE; ++i) large[i] = samples[i % N];
+        CBlockPacket big = *block;
+        big.count     = LARGE;
+        big.blockData = large.data();
+
+        CBlockColumns bigColumns;
+        bigColumns.Load(big);
+        std::vector<Vertex> va(LARGE), vb(LARGE);
+        Params p{ Field::Stage1_Top, XSource::StateTime, 0.5, 0.0, { 0.1f, 0.2f, 0.3f, 1.0f } };
+        NaiveGenerate(big, p, va.data());
+        const size_t nb = Generate(bigColumns, 0, LARGE, p, vb.data(), vb.size());
+        std::cout << "Block of " << LARGE << ": " << nb << " vertices, "
+                  << (std::memcmp(va.data(), vb.data(), LARGE * sizeof(Vertex)) == 0 ? "matching" : "MISMATCH") << "\n";
+    }
+
+    // Precision: distinct x values a day in, absolute vs rebased
+    std::set<float> absolute, rebased;
+    for (size_t i = 0; i < N; ++i) {
+        absolute.insert(float(block->blockData[i].timeStamp));
+        rebased .insert(float(block->blockData[i].timeStamp - 86'400.0));
+    }
+    std::cout << "Distinct x of " << N << ": absolute float " << absolute.size() << ",  rebased " << rebased.size() << "\n";
+
+    // Timing per block
+    Params p{ Field::C0, XSource::SampleTime, 1.0 / 5000.0, 86'400.0, { 0.1f, 0.2f, 0.3f, 1.0f } };
+    double checksum = 0.0;
+
+    double start = GetTime();
+    for (size_t k = 0; k < BLOCKS; ++k) {
+        NaiveGenerate(*block, p, a.data());
+        checksum += a[k % N].position[1];
+    }
+    const double tNaive = (GetTime() - start) * 1e9 / BLOCKS;
+
+    start = GetTime();
+    for (size_t k = 0; k < BLOCKS; ++k) {
+        Generate(*columns, 0, N, p, b.data(), b.size());
+        checksum += b[k % N].position[1];
+    }
+    const double tColumns = (GetTime() - start) * 1e9 / BLOCKS;
+
+    start = GetTime();
+    for (size_t k = 0; k < BLOCKS; ++k) {
+        columns->Load(*block);
+        checksum += columns->sampleTime[k % N];
+    }
+    const double tLoad = (GetTime() - start) * 1e9 / BLOCKS;
+
+    // Columns are loaded once per block in the decoder and shared by every plot drawing from it
+    std::cout << "Per block of " << N << ":  packed loop " << tNaive << " ns,  columns " << tColumns << " ns per plot;  "
+              << "loading columns " << tLoad << " ns once  (checksum " << checksum << ")\n";
+    std::cout << "\n";
+}
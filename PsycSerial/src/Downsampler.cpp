@@ -0,0 +1,130 @@
+#include "Downsampler.h"
+
+using namespace System::Runtime::InteropServices;
+
+namespace PsycSerial
+{
+    static void CheckSeries(array<double>^ x, array<double>^ y, int count, array<double>^ outX, array<double>^ outY)
+    {
+        if (x    == nullptr) throw gcnew ArgumentNullException("x");
+        if (y    == nullptr) throw gcnew ArgumentNullException("y");
+        if (outX == nullptr) throw gcnew ArgumentNullException("outX");
+        if (outY == nullptr) throw gcnew ArgumentNullException("outY");
+        if (count < 0 || count > x->Length || count > y->Length) throw gcnew ArgumentOutOfRangeException("count");
+        if (outX->Length != outY->Length) throw gcnew ArgumentException("outX and outY must be the same length");
+    }
+
+    int Downsampler::Lttb(array<double>^ x, array<double>^ y, int count, array<double>^ outX, array<double>^ outY)
+    {
+        CheckSeries(x, y, count, outX, outY);
+        if (count == 0 || outX->Length == 0) return 0;
+
+        pin_ptr<double> px = &x[0];
+        pin_ptr<double> py = &y[0];
+        pin_ptr<double> ox = &outX[0];
+        pin_ptr<double> oy = &outY[0];
+        const size_t n = static_cast<size_t>(count), m = static_cast<size_t>(outX->Length);
+        return static_cast<int>(CDownsampler::Lttb(std::span<const double>(px, n), std::span<const double>(py, n),
+                                                   std::span<double>(ox, m), std::span<double>(oy, m)));
+    }
+
+    int Downsampler::MinMaxLttb(array<double>^ x, array<double>^ y, int count, array<double>^ outX, array<double>^ outY)
+    {
+        return MinMaxLttb(x, y, count, outX, outY, static_cast<int>(CDownsampler::MINMAX_RATIO));
+    }
+
+    int Downsampler::MinMaxLttb(array<double>^ x, array<double>^ y, int count, array<double>^ outX, array<double>^ outY, int ratio)
+    {
+        CheckSeries(x, y, count, outX, outY);
+        if (ratio <= 0) throw gcnew ArgumentOutOfRangeException("ratio");
+        if (count == 0 || outX->Length == 0) return 0;
+
+        pin_ptr<double> px = &x[0];
+        pin_ptr<double> py = &y[0];
+        pin_ptr<double> ox = &outX[0];
+        pin_ptr<double> oy = &outY[0];
+        const size_t n = static_cast<size_t>(count), m = static_cast<size_t>(outX->Length);
+        return static_cast<int>(CDownsampler::MinMaxLttb(std::span<const double>(px, n), std::span<const double>(py, n),
+                                                         std::span<double>(ox, m), std::span<double>(oy, m),
+                                                         static_cast<size_t>(ratio)));
+    }
+
+
+    // Deterministic cleanup
+    LttbStream::~LttbStream() { this->!LttbStream(); }
+
+    // Finalizer (in case user forgets to Dispose)
+    LttbStream::!LttbStream()
+    {
+        delete _p;        _p        = nullptr;
+        delete _scratchX; _scratchX = nullptr;
+        delete _scratchY; _scratchY = nullptr;
+    }
+
+    LttbStream::LttbStream(int bucketSize)
+    {
+        if (bucketSize <= 0) throw gcnew ArgumentOutOfRangeException("bucketSize");
+        _p        = new CLttbStream(static_cast<size_t>(bucketSize));
+        _scratchX = new std::vector<double>();
+        _scratchY = new std::vector<double>();
+    }
+
+    void LttbStream::Reset(int bucketSize)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("LttbStream");
+        if (bucketSize <= 0) throw gcnew ArgumentOutOfRangeException("bucketSize");
+        _p->Reset(static_cast<size_t>(bucketSize));
+    }
+
+    void LttbStream::Add(double x, double y)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("LttbStream");
+        _p->Add(x, y);
+    }
+
+    void LttbStream::AddRange(array<double>^ x, array<double>^ y, int offset, int count)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("LttbStream");
+        if (x == nullptr) throw gcnew ArgumentNullException("x");
+        if (y == nullptr) throw gcnew ArgumentNullException("y");
+        if (offset < 0 || count < 0 || offset + count > x->Length || offset + count > y->Length) throw gcnew ArgumentOutOfRangeException("count");
+        if (count == 0) return;
+
+        pin_ptr<double> px = &x[offset];
+        pin_ptr<double> py = &y[offset];
+        _p->AddRange(std::span<const double>(px, static_cast<size_t>(count)),
+                     std::span<const double>(py, static_cast<size_t>(count)));
+    }
+
+    void LttbStream::Flush()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("LttbStream");
+        _p->Flush();
+    }
+
+    int LttbStream::Drain(array<double>^% x, array<double>^% y)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("LttbStream");
+
+        const int n = static_cast<int>(_p->Drain(*_scratchX, *_scratchY));
+        if (x == nullptr || x->Length < n) x = gcnew array<double>(n);
+        if (y == nullptr || y->Length < n) y = gcnew array<double>(n);
+        if (n > 0) {
+            Marshal::Copy(IntPtr(_scratchX->data()), x, 0, n);
+            Marshal::Copy(IntPtr(_scratchY->data()), y, 0, n);
+        }
+        return n;
+    }
+
+    int LttbStream::BucketSize::get()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("LttbStream");
+        return static_cast<int>(_p->GetBucketSize());
+    }
+
+    int LttbStream::Pending::get()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("LttbStream");
+        return static_cast<int>(_p->GetPending());
+    }
+} // namespace PsycSerial
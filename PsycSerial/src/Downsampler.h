@@ -0,0 +1,46 @@
+// Downsampler.h
+#pragma once
+
+#include <cstdint>
+#include "CDownsampler.h"
+
+using namespace System;
+
+namespace PsycSerial
+{
+    // Batch LTTB / MinMaxLTTB.  x must be ascending; outX->Length is the point budget.  Returns the points written.
+    public ref class Downsampler abstract sealed
+    {
+    public:
+        static int Lttb      (array<double>^ x, array<double>^ y, int count, array<double>^ outX, array<double>^ outY);
+        static int MinMaxLttb(array<double>^ x, array<double>^ y, int count, array<double>^ outX, array<double>^ outY);
+        static int MinMaxLttb(array<double>^ x, array<double>^ y, int count, array<double>^ outX, array<double>^ outY, int ratio);
+
+        static void DoTest() { CDownsampler::DoTest(); }
+    };
+
+    // Streaming LTTB, bucketSize input points per kept point
+    public ref class LttbStream sealed
+    {
+    private:
+        CLttbStream*         _p        = nullptr;
+        std::vector<double>* _scratchX = nullptr;
+        std::vector<double>* _scratchY = nullptr;
+
+    public:
+        LttbStream(int bucketSize);
+        ~LttbStream();
+        !LttbStream();
+
+        void Reset(int bucketSize);
+        void Add(double x, double y);
+        void AddRange(array<double>^ x, array<double>^ y, int offset, int count);
+        void Flush();
+
+        // Moves the points kept so far into x / y (grown if too small); returns how many
+        int Drain(array<double>^% x, array<double>^% y);
+
+        property int BucketSize { inline int get(); }
+        property int Pending    { inline int get(); }
+    };
+}
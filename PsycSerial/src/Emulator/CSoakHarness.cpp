@@ -0,0 +1,205 @@
+#include "CSoakHarness.h"
+#pragma managed(push, off)
+
+#include <algorithm>
+#include <chrono>
+#include <psapi.h>
+#include "../CHostClock.h"
+#include "../Packets/CEncoder.h"
+
+
+CSoakHarness::CSoakHarness() = default;
+
+CSoakHarness::~CSoakHarness()
+{
+    m_stopPump.store(true);
+    if (m_pump.joinable()) m_pump.join();
+}
+
+double CSoakHarness::Now()
+{
+    return CHostClock::ToSeconds(CHostClock::NowNs());
+}
+
+uint64_t CSoakHarness::GetRss()
+{
+    PROCESS_MEMORY_COUNTERS pmc{};
+    return GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof pmc) ? pmc.WorkingSetSize : 0;
+}
+
+bool CSoakHarness::Wait(double seconds)
+{
+    const double until = Now() + seconds;
+    while (Now() < until) {
+        if (m_cancel.load(std::memory_order_relaxed)) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return !m_cancel.load(std::memory_order_relaxed);
+}
+
+void CSoakHarness::HostData(void* self, CSerial*, const CDecodedPacket& packet)
+{
+    auto* harness = static_cast<CSoakHarness*>(self);
+    const double latency = CHostClock::ToSeconds(CHostClock::NowNs() - packet.arrivalNs);
+
+    // Handshake replies come before the first frame of a new stream
+    if (packet.kind == PacketKind::Text && packet.text.length > 1 && packet.text.utf8Bytes[0] == '<') {
+        harness->m_recorder.Reset();
+        return;
+    }
+    harness->m_recorder.OnPacket(packet, latency);
+}
+
+void CSoakHarness::DeviceData(void* self, CSerial*, const CDecodedPacket& packet)
+{
+    // The device port decodes what the host wrote; the emulator wants it as bytes again
+    auto* harness = static_cast<CSoakHarness*>(self);
+    std::vector<uint8_t> bytes;
+    if (!CEncoder::encode(packet, bytes)) return;
+
+    std::lock_guard<std::mutex> lock(harness->m_deviceMutex);
+    if (harness->m_emulator)
+        harness->m_emulator->Receive(bytes.data(), bytes.size(), Now(), harness->m_replies);
+}
+
+void CSoakHarness::Pump()
+{
+    // All device writes go out from here, in order: replies first, then whatever became due
+    std::vector<uint8_t> out;
+    while (!m_stopPump.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(m_deviceMutex);
+            out.swap(m_replies);
+            if (m_emulator && m_generate.load(std::memory_order_relaxed))
+                m_emulator->Generate(Now(), out);
+        }
+        // A write that times out is the device's USB buffer full: those bytes are gone
+        if (!out.empty() && !m_device.Write(out.data(), 0, static_cast<DWORD>(out.size())))
+            m_writeFailures.fetch_add(1, std::memory_order_relaxed);
+        out.clear();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+CSoakStep CSoakHarness::RunStep(double multiplier, double seconds)
+{
+    CSoakStep step;
+    step.multiplier = multiplier;
+
+    CTeensyEmulator::Settings device = m_settings.device;
+    device.multiplier = multiplier;
+    {
+        std::lock_guard<std::mutex> lock(m_deviceMutex);
+        m_emulator = std::make_unique<CTeensyEmulator>(device);
+        m_replies.clear();
+    }
+    m_host.SetBlockCapacity(device.maxBlockSize, device.maxEventsPerBlock);
+    m_writeFailures.store(0);
+    const uint64_t droppedBefore = m_host.GetDroppedBlocks();
+
+    // Connect as TeensySerial does; the stream starts on the version line
+    m_generate.store(true);
+    m_host.Write(">HOST_ACK\n");
+    m_host.Write(">" + m_settings.hostVersion + ":TELEMETRY_BATCH=" + std::to_string(CTelemetryBatch::MAX_ENTRIES) + "\n");
+
+    bool streaming = false;
+    for (int i = 0; i < 200 && !streaming && Wait(0.01); ++i) {
+        std::lock_guard<std::mutex> lock(m_deviceMutex);
+        streaming = m_emulator->IsStreaming();
+    }
+    if (!streaming) {
+        m_generate.store(false);
+        if (m_error.empty()) m_error = "the device port did not see the handshake";
+        return step;
+    }
+
+    const double start = Now();
+    step.rssStart = step.rssPeak = GetRss();
+    while (Now() - start < seconds && Wait(std::min(1.0, seconds - (Now() - start))))
+        step.rssPeak = std::max(step.rssPeak, GetRss());
+    m_generate.store(false);
+    step.seconds = Now() - start;
+
+    // Let the host read what was sent before counting what never arrived
+    uint64_t sent = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_deviceMutex);
+        sent       = m_emulator->GetStats().samples;
+        step.bytes = m_emulator->GetStats().bytes;
+    }
+    for (int i = 0; i < 200 && m_recorder.GetSamples() < sent; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    const CSoakRecorder::Summary s = m_recorder.GetSummary();
+    step.frames        = s.frames;
+    step.samples       = s.samples;
+    step.gaps          = s.gaps;
+    step.lostSamples   = std::max(s.lostSamples, sent > s.samples ? sent - s.samples : 0);
+    step.droppedBlocks = m_host.GetDroppedBlocks() - droppedBefore;
+    step.writeFailures = m_writeFailures.load();
+    step.p50_us        = s.p50  * 1e6;
+    step.p99_us        = s.p99  * 1e6;
+    step.p999_us       = s.p999 * 1e6;
+    step.max_us        = s.max  * 1e6;
+    step.rssEnd        = GetRss();
+    step.rssPeak       = std::max(step.rssPeak, step.rssEnd);
+    step.sustained     = !m_cancel.load() && step.gaps == 0 && step.lostSamples == 0 && step.droppedBlocks == 0
+                      && step.writeFailures == 0 && s.p99 * 1e3 <= m_settings.maxP99_ms;
+    return step;
+}
+
+CSoakReport CSoakHarness::Run(const Settings& settings)
+{
+    m_settings = settings;
+    m_error.clear();
+    m_cancel.store(false);
+
+    CSoakReport report;
+    report.hostVersion      = settings.hostVersion;
+    report.deviceVersion    = settings.device.deviceVersion;
+    report.stateDuration_uS = settings.device.stateDuration_uS;
+    report.samplingSpeed_Hz = settings.device.samplingSpeed_Hz;
+    report.maxBlockSize     = settings.device.maxBlockSize;
+    report.telemetryBatch   = std::min<uint32_t>(settings.device.telemetryBatch, CTelemetryBatch::MAX_ENTRIES);
+    report.packedBlocks     = settings.device.packedBlocks;
+
+    if (!m_host.SetPort(settings.hostPort, &CSoakHarness::HostData, this, settings.baudRate)) {
+        report.error = "could not open " + settings.hostPort;
+        return report;
+    }
+    if (!m_device.SetPort(settings.devicePort, &CSoakHarness::DeviceData, this, settings.baudRate)) {
+        report.error = "could not open " + settings.devicePort;
+        m_host.Close();
+        return report;
+    }
+    m_stopPump.store(false);
+    m_pump = std::thread(&CSoakHarness::Pump, this);
+
+    // Ramp until a step is not sustained, then soak below the fastest one that was
+    double multiplier = settings.device.multiplier;
+    while (!m_cancel.load() && multiplier <= settings.maxMultiplier) {
+        report.ramp.push_back(RunStep(multiplier, settings.stepSeconds));
+        if (!report.ramp.back().sustained) break;
+        report.sustainedStep = static_cast<int>(report.ramp.size()) - 1;
+        if (settings.rampFactor <= 1.0) break;
+        multiplier *= settings.rampFactor;
+    }
+    if (!m_cancel.load() && report.sustainedStep >= 0 && settings.soakSeconds > 0.0) {
+        report.soak   = RunStep(report.ramp[report.sustainedStep].multiplier * settings.soakFraction, settings.soakSeconds);
+        report.soaked = true;
+    }
+
+    m_stopPump.store(true);
+    m_pump.join();
+    m_device.Close();
+    m_host.Close();
+    {
+        std::lock_guard<std::mutex> lock(m_deviceMutex);
+        m_emulator.reset();
+    }
+    if (m_cancel.load()) m_error = m_error.empty() ? "cancelled" : m_error;
+    report.error = m_error;
+    return report;
+}
+
+#pragma managed(pop)
@@ -0,0 +1,68 @@
+#pragma once
+#pragma managed(push, off)
+
+#include "../CSerial.h"
+#include "CSoakRecorder.h"
+#include "CTeensyEmulator.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Soak run of the real receive path.  An in-process CTeensyEmulator writes to one end of a null-modem pair
+// (com0com, or two USB-serial adapters wired back to back); a CSerial on the other end reads, decodes and calls
+// back exactly as it does for the device.  The rate starts at device.multiplier and goes up by rampFactor every
+// stepSeconds until a step is not sustained: samples lost, blocks dropped, device writes timing out or p99 latency
+// over maxP99_ms.  The last sustained rate, times soakFraction, then runs for soakSeconds.
+class CSoakHarness
+{
+public:
+    struct Settings {
+        std::string hostPort, devicePort;
+        int         baudRate      = CSerial::DEFAULT_BAUDRATE;
+        CTeensyEmulator::Settings device;
+        double      rampFactor    =    1.5;
+        double      maxMultiplier = 1000.0;
+        double      stepSeconds   =   10.0;
+        double      soakSeconds   = 3600.0;   // 0 = ramp only
+        double      soakFraction  =    0.8;
+        double      maxP99_ms     =   50.0;
+        std::string hostVersion;
+    };
+
+    CSoakHarness();
+    ~CSoakHarness();
+
+    // Opens both ports, ramps, soaks and closes them again; blocks until done or cancelled
+    CSoakReport Run(const Settings& settings);
+    void        Cancel() { m_cancel.store(true, std::memory_order_relaxed); }
+
+private:
+    static void HostData  (void* self, CSerial* sender, const CDecodedPacket& packet);
+    static void DeviceData(void* self, CSerial* sender, const CDecodedPacket& packet);
+
+    CSoakStep RunStep(double multiplier, double seconds);
+    void      Pump();
+    bool      Wait(double seconds);    // false if cancelled meanwhile
+
+    static double   Now();
+    static uint64_t GetRss();
+
+    Settings      m_settings;
+    CSerial       m_host, m_device;
+    CSoakRecorder m_recorder;
+    std::string   m_error;
+
+    std::mutex                       m_deviceMutex;   // emulator and its pending replies
+    std::unique_ptr<CTeensyEmulator> m_emulator;
+    std::vector<uint8_t>             m_replies;
+
+    std::thread           m_pump;
+    std::atomic<bool>     m_generate{ false }, m_stopPump{ false }, m_cancel{ false };
+    std::atomic<uint64_t> m_writeFailures{ 0 };
+};
+
+#pragma managed(pop)
@@ -0,0 +1,187 @@
+#include "CSoakRecorder.h"
+#pragma managed(push, off)
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+
+
+void CSoakRecorder::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_frames = m_samples = m_gaps = m_lost = m_count = m_maxNs = 0;
+    m_nextSample = 0;
+    std::fill(std::begin(m_buckets), std::end(m_buckets), 0);
+}
+
+void CSoakRecorder::OnPacket(const CDecodedPacket& packet, double latency)
+{
+    const uint64_t ns = latency > 0.0 ? uint64_t(latency * 1e9) : 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_frames;
+    ++m_buckets[BucketOf(ns)];
+    ++m_count;
+    m_maxNs = std::max(m_maxNs, ns);
+
+    if (packet.kind != PacketKind::Block || packet.block.count == 0) return;
+
+    // The index is 32 bits and wraps within a long soak; differences are taken modulo 2^32
+    const CBlockPacket& b = packet.block;
+    const uint32_t jump = b.blockData[0].sensorState - m_nextSample;
+    if (jump != 0) {
+        ++m_gaps;
+        if (jump < 0x8000'0000u) m_lost += jump;   // backwards would be a repeat, nothing lost
+    }
+    m_nextSample = b.blockData[b.count - 1].sensorState + 1;
+    m_samples   += b.count;
+}
+
+uint64_t CSoakRecorder::GetSamples() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_samples;
+}
+
+CSoakRecorder::Summary CSoakRecorder::GetSummary() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Summary s;
+    s.frames      = m_frames;
+    s.samples     = m_samples;
+    s.gaps        = m_gaps;
+    s.lostSamples = m_lost;
+    s.p50         = Percentile(0.5);
+    s.p99         = Percentile(0.99);
+    s.p999        = Percentile(0.999);
+    s.max         = m_maxNs * 1e-9;
+    return s;
+}
+
+size_t CSoakRecorder::BucketOf(uint64_t ns)
+{
+    if (ns < SUB_BUCKETS) return size_t(ns);
+    const int shift = std::min(int(std::bit_width(ns)) - 5, MAX_SHIFT);
+    const uint64_t mantissa = std::min<uint64_t>(ns >> shift, 2 * SUB_BUCKETS - 1);   // 16..31
+    return size_t(shift + 1) * SUB_BUCKETS + size_t(mantissa - SUB_BUCKETS);
+}
+
+uint64_t CSoakRecorder::BucketValue(size_t bucket)
+{
+    if (bucket < SUB_BUCKETS) return bucket;
+    const int shift = int(bucket / SUB_BUCKETS) - 1;
+    const uint64_t low = uint64_t(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return low + (uint64_t(1) << shift) / 2;
+}
+
+double CSoakRecorder::Percentile(double fraction) const
+{
+    if (m_count == 0) return 0.0;
+    const uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(fraction * m_count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) return std::min(BucketValue(i), m_maxNs) * 1e-9;
+    }
+    return m_maxNs * 1e-9;
+}
+
+
+// ----------------------------- Report --------------------------------
+
+namespace
+{
+    void AppendString(std::string& out, const std::string& s)
+    {
+        out += '"';
+        for (char c : s) {
+            switch (c) {
+                case '"' : out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n";  break;
+                case '\r': out += "\\r";  break;
+                case '\t': out += "\\t";  break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char esc[8]; std::snprintf(esc, sizeof esc, "\\u%04x", c);
+                        out += esc;
+                    }
+                    else out += c;
+            }
+        }
+        out += '"';
+    }
+
+    void AppendNumber(std::string& out, double v)
+    {
+        if (!std::isfinite(v)) { out += "null"; return; }
+        char buf[32];
+        std::snprintf(buf, sizeof buf, "%.6g", v);
+        out += buf;
+    }
+
+    void AppendStep(std::string& out, const CSoakStep& s)
+    {
+        auto field = [&](const char* name, double v, bool last = false) {
+            out += '"'; out += name; out += "\": "; AppendNumber(out, v); if (!last) out += ", ";
+        };
+        auto count = [&](const char* name, int64_t v, bool last = false) {
+            out += '"'; out += name; out += "\": "; out += std::to_string(v); if (!last) out += ", ";
+        };
+        out += "{ ";
+        field("multiplier",       s.multiplier);
+        field("seconds",          s.seconds);
+        count("frames",           int64_t(s.frames));
+        field("framesPerSecond",  s.FramesPerSecond());
+        count("samples",          int64_t(s.samples));
+        field("samplesPerSecond", s.SamplesPerSecond());
+        field("bytesPerSecond",   s.BytesPerSecond());
+        count("gaps",             int64_t(s.gaps));
+        count("lostSamples",      int64_t(s.lostSamples));
+        count("droppedBlocks",    int64_t(s.droppedBlocks));
+        count("writeFailures",    int64_t(s.writeFailures));
+        out += "\"latency_us\": { ";
+        field("p50", s.p50_us); field("p99", s.p99_us); field("p999", s.p999_us); field("max", s.max_us, true);
+        out += " }, \"rss\": { ";
+        count("start", int64_t(s.rssStart)); count("end", int64_t(s.rssEnd)); count("peak", int64_t(s.rssPeak));
+        count("growth", int64_t(s.rssEnd) - int64_t(s.rssStart), true);
+        out += " }, \"sustained\": ";
+        out += s.sustained ? "true" : "false";
+        out += " }";
+    }
+}
+
+std::string CSoakReport::ToJson() const
+{
+    std::string out = "{\n  \"format\": 1,\n  \"hostVersion\": ";
+    AppendString(out, hostVersion);
+    out += ",\n  \"deviceVersion\": ";
+    AppendString(out, deviceVersion);
+
+    char buf[256];
+    std::snprintf(buf, sizeof buf,
+        ",\n  \"device\": { \"stateDuration_uS\": %u, \"samplingSpeed_Hz\": %u, \"maxBlockSize\": %u, "
+        "\"telemetryBatch\": %u, \"packedBlocks\": %s },\n  \"ramp\": [",
+        stateDuration_uS, samplingSpeed_Hz, maxBlockSize, telemetryBatch, packedBlocks ? "true" : "false");
+    out += buf;
+    for (size_t i = 0; i < ramp.size(); ++i) {
+        out += i ? ",\n    " : "\n    ";
+        AppendStep(out, ramp[i]);
+    }
+    out += ramp.empty() ? "],\n" : "\n  ],\n";
+
+    out += "  \"sustained\": ";
+    if (sustainedStep >= 0 && size_t(sustainedStep) < ramp.size()) AppendStep(out, ramp[sustainedStep]);
+    else                                                           out += "null";
+    out += ",\n  \"soak\": ";
+    if (soaked) AppendStep(out, soak);
+    else        out += "null";
+    out += ",\n  \"error\": ";
+    AppendString(out, error);
+    out += "\n}\n";
+    return out;
+}
+
+#pragma managed(pop)
@@ -0,0 +1,84 @@
+#pragma once
+#pragma managed(push, off)
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../Packets/CPackets.h"
+
+// One step of a soak run: a stream rate held for some seconds, and what the host made of it.  Latencies are from
+// a frame's arrival to its callback, in microseconds; RSS is the process working set in bytes.
+struct CSoakStep
+{
+    double   multiplier{};
+    double   seconds{};
+    uint64_t frames{}, samples{}, bytes{};
+    uint64_t gaps{};            // places where the sample index jumped
+    uint64_t lostSamples{};     // samples sent that never arrived
+    uint64_t droppedBlocks{};   // by the host's decoder
+    uint64_t writeFailures{};   // device writes that timed out: the host was not reading
+    double   p50_us{}, p99_us{}, p999_us{}, max_us{};
+    uint64_t rssStart{}, rssEnd{}, rssPeak{};
+    bool     sustained{};
+
+    double FramesPerSecond()  const { return seconds > 0.0 ? frames  / seconds : 0.0; }
+    double SamplesPerSecond() const { return seconds > 0.0 ? samples / seconds : 0.0; }
+    double BytesPerSecond()   const { return seconds > 0.0 ? bytes   / seconds : 0.0; }
+};
+
+// Everything a soak run reports: the ramp, the fastest step the host sustained, and the long run at a fraction of
+// it.  ToJson gives the machine-readable form kept between releases.
+struct CSoakReport
+{
+    std::string hostVersion, deviceVersion;
+    uint32_t    stateDuration_uS{}, samplingSpeed_Hz{}, maxBlockSize{}, telemetryBatch{};
+    bool        packedBlocks{};
+
+    std::vector<CSoakStep> ramp;
+    int         sustainedStep{ -1 };   // index into ramp, -1 if none was
+    bool        soaked{};
+    CSoakStep   soak;
+    std::string error;
+
+    std::string ToJson() const;
+};
+
+// What the host received during a step, fed from the read thread for every decoded packet: frame and sample
+// counts, gaps in the emulator's sample index (sensorState, see CTeensyEmulator) and an arrival-to-callback latency
+// histogram.  Buckets are 1/16 of a power of two wide, so percentiles are good to about 6%.
+class CSoakRecorder
+{
+public:
+    struct Summary {
+        uint64_t frames{}, samples{}, gaps{}, lostSamples{};
+        double   p50{}, p99{}, p999{}, max{};   // seconds
+    };
+
+    // A new stream starts: its first sample is 0
+    void Reset();
+
+    void OnPacket(const CDecodedPacket& packet, double latency);
+
+    Summary  GetSummary() const;
+    uint64_t GetSamples() const;
+
+    static void DoTest();
+
+private:
+    static constexpr int    SUB_BUCKETS = 16;
+    static constexpr int    MAX_SHIFT   = 40;   // latencies up to 2^44 ns, far beyond any step
+    static constexpr size_t NUM_BUCKETS = (MAX_SHIFT + 2) * SUB_BUCKETS;
+
+    static size_t   BucketOf(uint64_t ns);
+    static uint64_t BucketValue(size_t bucket);   // middle of the bucket, ns
+    double          Percentile(double fraction) const;
+
+    mutable std::mutex m_mutex;
+    uint64_t m_frames{}, m_samples{}, m_gaps{}, m_lost{}, m_count{}, m_maxNs{};
+    uint32_t m_nextSample{};
+    uint64_t m_buckets[NUM_BUCKETS]{};
+};
+
+#pragma managed(pop)
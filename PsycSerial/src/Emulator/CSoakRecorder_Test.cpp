@@ -0,0 +1,115 @@
+#include "CSoakRecorder.h"
+#include "CTeensyEmulator.h"
+#include "../Packets/CDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// One second of emulated device output, decoded; f(packet) for each
+template <typename F>
+static void ForEachPacket(double multiplier, F&& f)
+{
+    CTeensyEmulator::Settings settings;
+    settings.multiplier = multiplier;
+    CTeensyEmulator device(settings);
+    std::vector<uint8_t> stream;
+    const char hello[] = ">v0.2.3:TELEMETRY_BATCH=1024\n";
+    device.Receive(reinterpret_cast<const uint8_t*>(hello), sizeof hello - 1, 0.0, stream);
+    for (double t = 0.0; t <= 1.0; t += 1e-3) device.Generate(t, stream);
+
+    CDecoder decoder;
+    decoder.setBlockCapacity(settings.maxBlockSize, settings.maxEventsPerBlock);
+    auto* out = new CDecodedPacket;
+    CPacket packet;
+    packet.data.resize(4096);
+    for (size_t pos = 0; pos < stream.size(); pos += packet.data.size()) {
+        packet.bytesRead = static_cast<uint32_t>(std::min(packet.data.size(), stream.size() - pos));
+        std::memcpy(packet.data.data(), stream.data() + pos, packet.bytesRead);
+        for (; decoder.process(packet, *out) != PacketKind::Unknown; packet.bytesRead = 0) f(*out);
+    }
+    delete out;
+}
+
+static CDecodedPacket MakeBlock(std::vector<CDataPacket>& items, uint32_t first, uint32_t count)
+{
+    items.resize(count);
+    for (uint32_t i = 0; i < count; ++i) items[i].sensorState = first + i;
+    CDecodedPacket p{};
+    p.kind  = PacketKind::Block;
+    p.block = CBlockPacket{ 0, 0.0, count, 0, items.data(), nullptr };
+    return p;
+}
+
+
+void CSoakRecorder::DoTest()
+{
+    std::cout << "=== CSoakRecorder test ===\n";
+
+    // Every sample of a clean stream, then the same stream with one Block lost on the way
+    CSoakRecorder recorder;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> latency(0.0, 1e-3);
+    ForEachPacket(10.0, [&](const CDecodedPacket& p) { recorder.OnPacket(p, latency(rng)); });
+    Summary s = recorder.GetSummary();
+    std::cout << "Clean: " << s.frames << " frames, " << s.samples << " samples, " << s.gaps << " gaps, " << s.lostSamples << " lost\n";
+    std::cout << "Uniform 0..1 ms latency: p50 " << s.p50 * 1e6 << " us, p99 " << s.p99 * 1e6 << " us, p999 " << s.p999 * 1e6
+              << " us, max " << s.max * 1e6 << " us\n";
+
+    recorder.Reset();
+    int block = 0;
+    uint32_t missing = 0;
+    ForEachPacket(10.0, [&](const CDecodedPacket& p) {
+        if (p.kind == PacketKind::Block && ++block == 10) { missing = p.block.count; return; }
+        recorder.OnPacket(p, 0.0);
+    });
+    s = recorder.GetSummary();
+    std::cout << "One block of " << missing << " lost: " << s.gaps << " gaps, " << s.lostSamples << " lost\n";
+
+    // The 32-bit index wraps in a long run; that is not a gap
+    recorder.Reset();
+    std::vector<CDataPacket> items;
+    recorder.OnPacket(MakeBlock(items, 0, 100), 0.0);
+    recorder.m_nextSample = 0xFFFF'FFF0u;
+    recorder.OnPacket(MakeBlock(items, 0xFFFF'FFF0u, 100), 0.0);
+    recorder.OnPacket(MakeBlock(items, 0xFFFF'FFF0u + 100, 100), 0.0);
+    s = recorder.GetSummary();
+    std::cout << "Across the wrap: " << s.gaps << " gaps, " << s.lostSamples << " lost\n";
+
+    // Report
+    CSoakReport report;
+    report.hostVersion   = "v0.2.3";
+    report.deviceVersion = "v0.2.3-emu \"test\"";
+    report.stateDuration_uS = 3050; report.samplingSpeed_Hz = 2000; report.maxBlockSize = 164; report.telemetryBatch = 64;
+    CSoakStep step;
+    step.multiplier = 1.0; step.seconds = 10.0; step.frames = 4000; step.samples = 20000; step.bytes = 1'500'000;
+    step.p50_us = 120.0; step.p99_us = 900.0; step.p999_us = 2100.0; step.max_us = 5000.0;
+    step.rssStart = 50'000'000; step.rssEnd = 50'100'000; step.rssPeak = 50'200'000; step.sustained = true;
+    report.ramp.push_back(step);
+    step.multiplier = 2.0; step.gaps = 3; step.lostSamples = 400; step.sustained = false;
+    report.ramp.push_back(step);
+    report.sustainedStep = 0;
+    std::cout << report.ToJson();
+
+    // Cost per packet on the read thread
+    CDecodedPacket p = MakeBlock(items, 0, 8);
+    recorder.Reset();
+    const uint64_t N = 2'000'000;
+    const double start = GetTime();
+    for (uint64_t i = 0; i < N; ++i) {
+        for (uint32_t k = 0; k < 8; ++k) items[k].sensorState = uint32_t(i * 8 + k);
+        recorder.OnPacket(p, (i % 1000) * 1e-6);
+    }
+    std::cout << "OnPacket: " << (GetTime() - start) / N * 1e9 << " ns, gaps " << recorder.GetSummary().gaps << "\n";
+    std::cout << "\n";
+}
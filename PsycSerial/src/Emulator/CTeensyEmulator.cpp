@@ -0,0 +1,271 @@
+#include "CTeensyEmulator.h"
+#pragma managed(push, off)
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "../Packets/CEncoder.h"
+#include "../Packets/CWireLayout.h"
+
+
+namespace
+{
+    constexpr uint32_t HW_UPDATE_START    = 0x21;   // EventKind
+    constexpr uint32_t HW_UPDATE_COMPLETE = 0x22;
+    constexpr uint32_t A2D_DATA_READY     = 0x11;
+    constexpr double   HEAD_SETTLE_TIME   = 440e-6;
+    constexpr uint32_t NUM_HEAD_STATES    = 4;
+
+    constexpr uint8_t  TELEMETRY_GROUPS[] = { 0x11, 0x12, 0x13, 0x15 };   // A2D, DigiPots, USB, Timer
+
+    constexpr size_t   COMMAND_FRAME_SIZE = sizeof(Frame) + CommandLayout::SIZE + sizeof(Frame);
+    constexpr size_t   MAX_LINE           = 4096;
+
+    // One period of a sine, for the channel signals; sin() per sample and channel costs more than the encoding
+    struct SineTable
+    {
+        static constexpr uint32_t SIZE = 1024;
+        float value[SIZE];
+
+        SineTable() { for (uint32_t i = 0; i < SIZE; ++i) value[i] = float(std::sin(2.0 * 3.14159265358979323846 * i / SIZE)); }
+    };
+    const SineTable s_sine;
+
+    inline uint32_t Noise(uint64_t n)
+    {
+        n ^= n >> 33; n *= 0xFF51AFD7ED558CCDull;
+        n ^= n >> 33; n *= 0xC4CEB9FE1A85EC53ull;
+        return uint32_t(n >> 40);
+    }
+}
+
+
+CTeensyEmulator::CTeensyEmulator() : CTeensyEmulator(Settings{})
+{
+}
+
+CTeensyEmulator::CTeensyEmulator(const Settings& settings)
+    : m_settings(settings)
+    , m_sampleRate(std::max(1e-3, settings.samplingSpeed_Hz * settings.multiplier))
+{
+    m_settings.maxBlockSize = std::max<uint32_t>(1, m_settings.maxBlockSize);
+}
+
+void CTeensyEmulator::Receive(const uint8_t* data, size_t length, double now, std::vector<uint8_t>& out)
+{
+    m_input.insert(m_input.end(), data, data + length);
+
+    size_t pos = 0;
+    while (pos < m_input.size()) {
+        const size_t left = m_input.size() - pos;
+
+        Frame frame = 0;
+        std::memcpy(&frame, m_input.data() + pos, std::min(left, sizeof frame));
+        if (left >= sizeof frame && frame == CCommandPacket::frameStart) {
+            if (left < COMMAND_FRAME_SIZE) break;
+
+            Frame end = 0;
+            std::memcpy(&end, m_input.data() + pos + COMMAND_FRAME_SIZE - sizeof end, sizeof end);
+            if (end != CCommandPacket::frameEnd) { ++pos; continue; }
+
+            CCommandPacket command{};
+            CommandLayout::Read(m_input.data() + pos + sizeof(Frame), command);
+            OnCommand(command, out);
+            pos += COMMAND_FRAME_SIZE;
+            continue;
+        }
+
+        const auto* begin = m_input.data() + pos;
+        const auto* eol   = static_cast<const uint8_t*>(std::memchr(begin, '\n', left));
+        if (eol == nullptr) {
+            if (left > MAX_LINE) pos = m_input.size();   // not a line we will ever answer
+            break;
+        }
+        m_line.assign(reinterpret_cast<const char*>(begin), eol - begin);
+        if (!m_line.empty() && m_line.back() == '\r') m_line.pop_back();
+        OnLine(m_line, now, out);
+        pos += (eol - begin) + 1;
+    }
+    m_input.erase(m_input.begin(), m_input.begin() + pos);
+}
+
+void CTeensyEmulator::OnLine(const std::string& line, double now, std::vector<uint8_t>& out)
+{
+    if (line.empty() || line[0] != '>') return;
+
+    std::string reply;
+    if (line == ">HOST_ACK") {
+        m_streaming = false;   // the host (re)connected; wait for its version line
+        reply = "<DEVICE_ACK";
+    }
+    else {
+        // ">version:KEY=value:..."; the host offers the largest telemetry batch it takes, if it takes any
+        uint32_t offer = 0;
+        for (size_t begin = 1; begin < line.size(); ) {
+            size_t end = line.find(':', begin);
+            if (end == std::string::npos) end = line.size();
+            const std::string part = line.substr(begin, end - begin);
+            if (part.rfind("TELEMETRY_BATCH=", 0) == 0)
+                offer = uint32_t(std::strtoul(part.c_str() + 16, nullptr, 10));
+            begin = end + 1;
+        }
+        m_batch = std::min(offer, m_settings.telemetryBatch);
+
+        reply = "<DeviceVersion=" + m_settings.deviceVersion
+              + ":STATE_DURATION_uS="     + std::to_string(m_settings.stateDuration_uS)
+              + ":A2D_SAMPLING_SPEED_Hz=" + std::to_string(uint32_t(std::lround(m_sampleRate)))
+              + ":MAX_BLOCKSIZE="         + std::to_string(m_settings.maxBlockSize)
+              + ":MAX_EVENTS_PER_BLOCK="  + std::to_string(m_settings.maxEventsPerBlock)
+              + ":TELEMETRY_BATCH="       + std::to_string(m_batch);
+        Start(now);
+    }
+
+    CEncoder::encodeText(reinterpret_cast<const uint8_t*>(reply.data()), reply.size(), out);
+    m_stats.bytes += reply.size() + 1;
+}
+
+void CTeensyEmulator::OnCommand(const CCommandPacket& command, std::vector<uint8_t>& out)
+{
+    CCommandPacket reply = command;
+    switch (command.code)
+    {
+        case CCommandPacket::Ping: break;
+        case CCommandPacket::Get : { auto it = m_parameters.find(command.parameter); reply.value = it != m_parameters.end() ? it->second : 0.0; break; }
+        case CCommandPacket::Set : m_parameters[command.parameter] = command.value; break;
+        default                  : reply.value = std::numeric_limits<double>::quiet_NaN(); break;
+    }
+    CEncoder::encodeCommand(reply, out);
+    ++m_stats.commands;
+    m_stats.bytes += COMMAND_FRAME_SIZE;
+}
+
+void CTeensyEmulator::Start(double now)
+{
+    m_streaming     = true;
+    m_start         = now;
+    m_state         = 0;
+    m_nextSample    = 0;
+    m_telemetryTick = 0;
+    m_textTick      = 0;
+}
+
+void CTeensyEmulator::Disconnect()
+{
+    m_streaming = false;
+    m_input.clear();
+}
+
+uint64_t CTeensyEmulator::SamplesBefore(uint64_t state) const
+{
+    return uint64_t(std::ceil(StateStart(state) * m_sampleRate - 1e-9));
+}
+
+void CTeensyEmulator::Generate(double now, std::vector<uint8_t>& out)
+{
+    if (!m_streaming) return;
+    const double t = now - m_start;
+
+    // Blocks go out as soon as their last sample is read
+    for (;;) {
+        const uint64_t stateEnd = SamplesBefore(m_state + 1);
+        if (m_nextSample >= stateEnd) {
+            if (StateStart(m_state + 1) > t) break;
+            ++m_state;
+            continue;
+        }
+        const uint64_t end = std::min<uint64_t>(stateEnd, m_nextSample + m_settings.maxBlockSize);
+        if (SampleTime(end - 1) > t) break;
+
+        EmitBlock(m_nextSample, end, out);
+        m_nextSample = end;
+    }
+
+    if (m_settings.telemetry_Hz > 0.0) {
+        const double period = 1.0 / (m_settings.telemetry_Hz * m_settings.multiplier);
+        for (; m_telemetryTick * period <= t; ++m_telemetryTick) EmitTelemetry(m_telemetryTick * period, out);
+    }
+    if (m_settings.text_Hz > 0.0) {
+        const double period = 1.0 / (m_settings.text_Hz * m_settings.multiplier);
+        for (; m_textTick * period <= t; ++m_textTick) EmitText(m_textTick * period, out);
+    }
+}
+
+void CTeensyEmulator::EmitBlock(uint64_t first, uint64_t end, std::vector<uint8_t>& out)
+{
+    const uint32_t state      = uint32_t(m_state % NUM_HEAD_STATES);
+    const double   stateStart = StateStart(m_state);
+    const uint32_t count      = uint32_t(end - first);
+
+    m_items.resize(count);
+    m_events.clear();
+    if (first == SamplesBefore(m_state)) {
+        m_events.push_back(CEventPacket{ HW_UPDATE_START,    0.0 });
+        m_events.push_back(CEventPacket{ HW_UPDATE_COMPLETE, HEAD_SETTLE_TIME });
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint64_t n = first + i;
+        CDataPacket& s = m_items[i];
+        s.state         = state;
+        s.timeStamp     = SampleTime(n);
+        s.stateTime     = s.timeStamp - stateStart;
+        s.hardwareState = uint64_t(state) << 40;
+        s.sensorState   = uint32_t(n);
+        for (uint32_t ch = 0; ch < CDataPacket::A2D_NUM_CHANNELS; ++ch) {
+            const float wave = s_sine.value[(n * (ch + 1)) % SineTable::SIZE];
+            s.channel[ch] = 0x8000'0000u + int32_t(wave * 200'000.0f) + (Noise(n * 8 + ch) & 0xFF);
+        }
+        if (m_events.size() < m_settings.maxEventsPerBlock)
+            m_events.push_back(CEventPacket{ A2D_DATA_READY, s.stateTime });
+    }
+
+    const size_t at = out.size();
+    CEncoder::encodeBlock(CBlockPacket{ state, m_items[0].timeStamp, count, uint32_t(m_events.size()), m_items.data(), m_events.data() },
+                          out, m_settings.packedBlocks ? CEncoder::BlockFormat::Packed : CEncoder::BlockFormat::Plain);
+
+    m_stats.samples += count;
+    ++m_stats.blocks;
+    m_stats.bytes   += out.size() - at;
+}
+
+void CTeensyEmulator::EmitTelemetry(double deviceTime, std::vector<uint8_t>& out)
+{
+    const size_t at = out.size();
+
+    m_entries.resize(m_settings.telemetryKeys);
+    for (uint32_t i = 0; i < m_settings.telemetryKeys; ++i) {
+        const uint8_t  group    = TELEMETRY_GROUPS[i % std::size(TELEMETRY_GROUPS)];
+        const uint8_t  subGroup = uint8_t(i / std::size(TELEMETRY_GROUPS) % 8);
+        const float    value    = float(i + 1) * s_sine.value[(m_telemetryTick + i * 37) % SineTable::SIZE];
+        m_entries[i] = CTelemetryEntry{ TelemetryKey(group, subGroup, uint16_t(i)), value };
+
+        if (m_batch == 0) {
+            CEncoder::encodeTelemetry(CTelemetryPacket{ deviceTime, group, subGroup, uint16_t(i), value }, out);
+            ++m_stats.telemetryFrames;
+        }
+    }
+    for (uint32_t i = 0; m_batch != 0 && i < m_settings.telemetryKeys; i += m_batch) {
+        const uint32_t n = std::min(m_batch, m_settings.telemetryKeys - i);
+        CEncoder::encodeTelemetryBatch(CTelemetryBatch{ deviceTime, n, m_entries.data() + i }, out);
+        ++m_stats.telemetryFrames;
+    }
+
+    m_stats.telemetryValues += m_settings.telemetryKeys;
+    m_stats.bytes           += out.size() - at;
+}
+
+void CTeensyEmulator::EmitText(double deviceTime, std::vector<uint8_t>& out)
+{
+    // A status line in the tab-separated field format
+    m_line = "Time:"     + std::to_string(deviceTime)
+           + "\tState:"   + std::to_string(m_state)
+           + "\tSamples:" + std::to_string(m_stats.samples)
+           + "\tBlocks:"  + std::to_string(m_stats.blocks);
+    CEncoder::encodeText(reinterpret_cast<const uint8_t*>(m_line.data()), m_line.size(), out);
+
+    ++m_stats.textLines;
+    m_stats.bytes += m_line.size() + 1;
+}
+
+#pragma managed(pop)
@@ -0,0 +1,96 @@
+#pragma once
+#pragma managed(push, off)
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Packets/CPackets.h"
+
+// The device end of the serial protocol, without the hardware.  It answers the handshake TeensySerial performs
+// (">HOST_ACK" / "<DEVICE_ACK", then the version line) and Command frames, and once connected streams Block,
+// Telemetry and text frames at the rates its Settings imply.  Host bytes go in through Receive, device bytes come
+// out of Receive and Generate; the caller moves them over a port (Tools/TeensyEmulator runs it on a pty) or
+// straight into a CDecoder.  Times are seconds on the caller's clock.
+//
+// Each state lasts stateDuration_uS and its samples are sent as one Block, split into several when there are more
+// than maxBlockSize.  multiplier scales the sampling speed and the telemetry and text rates, so the load goes up
+// while device time stays real time.  sensorState carries each sample's index, so a reader can find gaps.
+class CTeensyEmulator
+{
+public:
+    struct Settings {
+        uint32_t stateDuration_uS  = 3'050;
+        uint32_t samplingSpeed_Hz  = 2'000;
+        uint32_t maxBlockSize      =   164;
+        uint32_t maxEventsPerBlock =   400;
+        uint32_t telemetryBatch    =    64;   // most entries per batched frame; 0 = always single frames
+        uint32_t telemetryKeys     =    24;   // values in each telemetry update
+        double   telemetry_Hz      =  50.0;
+        double   text_Hz           =  10.0;
+        double   multiplier        =   1.0;
+        bool     packedBlocks      = false;
+        std::string deviceVersion  = "v0.2.3-emu";
+    };
+
+    struct Stats {
+        uint64_t samples{}, blocks{}, telemetryFrames{}, telemetryValues{}, textLines{}, commands{}, bytes{};
+    };
+
+    CTeensyEmulator();
+    explicit CTeensyEmulator(const Settings& settings);
+
+    // Host bytes, in any pieces; replies to the handshake and to commands are appended to out
+    void Receive(const uint8_t* data, size_t length, double now, std::vector<uint8_t>& out);
+
+    // Appends every frame that is due by now; nothing until the handshake completed
+    void Generate(double now, std::vector<uint8_t>& out);
+
+    // The host went away: stop streaming until the next handshake
+    void Disconnect();
+
+    bool             IsStreaming()       const { return m_streaming; }
+    uint32_t         GetTelemetryBatch() const { return m_batch; }   // as negotiated
+    double           GetSampleRate()     const { return m_sampleRate; }
+    const Settings&  GetSettings()       const { return m_settings; }
+    const Stats&     GetStats()          const { return m_stats; }
+
+    static void DoTest();
+
+private:
+    void OnLine(const std::string& line, double now, std::vector<uint8_t>& out);
+    void OnCommand(const CCommandPacket& command, std::vector<uint8_t>& out);
+    void Start(double now);
+
+    void EmitBlock(uint64_t first, uint64_t end, std::vector<uint8_t>& out);
+    void EmitTelemetry(double deviceTime, std::vector<uint8_t>& out);
+    void EmitText(double deviceTime, std::vector<uint8_t>& out);
+
+    uint64_t SamplesBefore(uint64_t state) const;   // samples taken before the state starts
+    double   StateStart(uint64_t state) const { return state * (m_settings.stateDuration_uS * 1e-6); }
+    double   SampleTime(uint64_t sample) const { return sample / m_sampleRate; }
+
+    Settings m_settings;
+    double   m_sampleRate;
+    Stats    m_stats;
+
+    std::vector<uint8_t> m_input;   // host bytes not yet a whole line or command
+    bool     m_streaming{ false };
+    uint32_t m_batch{ 0 };
+    double   m_start{ 0.0 };
+
+    uint64_t m_state{ 0 };          // current state and the next sample to send
+    uint64_t m_nextSample{ 0 };
+    uint64_t m_telemetryTick{ 0 };
+    uint64_t m_textTick{ 0 };
+
+    std::unordered_map<uint16_t, double> m_parameters;   // what Set stored, for Get
+
+    std::vector<CDataPacket>     m_items;
+    std::vector<CEventPacket>    m_events;
+    std::vector<CTelemetryEntry> m_entries;
+    std::string                  m_line;
+};
+
+#pragma managed(pop)
@@ -0,0 +1,158 @@
+#include "CTeensyEmulator.h"
+#include "../Packets/CDecoder.h"
+#include "../Packets/CEncoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+static std::string AsText(const std::vector<uint8_t>& bytes)
+{
+    return std::string(bytes.begin(), bytes.end());
+}
+
+static void Send(CTeensyEmulator& device, const std::string& line, double now, std::vector<uint8_t>& out)
+{
+    device.Receive(reinterpret_cast<const uint8_t*>(line.data()), line.size(), now, out);
+}
+
+struct Received {
+    uint64_t samples{}, gaps{}, blocks{}, largestBlock{}, telemetry{}, text{}, commands{}, other{};
+    uint64_t nextSample{};
+    std::vector<CCommandPacket> replies;
+};
+
+// Everything the device sent, as the host's decoder sees it, in reads of up to 4 KB
+static void Decode(CDecoder& decoder, const std::vector<uint8_t>& bytes, Received& r)
+{
+    auto* out = new CDecodedPacket;
+    CPacket packet;
+    packet.data.resize(4096);
+    for (size_t pos = 0; pos < bytes.size(); pos += packet.data.size()) {
+        packet.bytesRead = static_cast<uint32_t>(std::min(packet.data.size(), bytes.size() - pos));
+        std::memcpy(packet.data.data(), bytes.data() + pos, packet.bytesRead);
+        for (PacketKind kind; (kind = decoder.process(packet, *out)) != PacketKind::Unknown; packet.bytesRead = 0) {
+            switch (kind) {
+                case PacketKind::Block:
+                    for (uint32_t i = 0; i < out->block.count; ++i, ++r.nextSample)
+                        r.gaps += out->block.blockData[i].sensorState != uint32_t(r.nextSample);
+                    r.samples += out->block.count;
+                    r.largestBlock = std::max<uint64_t>(r.largestBlock, out->block.count);
+                    ++r.blocks;
+                    break;
+                case PacketKind::Telemetry     : ++r.telemetry;                         break;
+                case PacketKind::TelemetryBatch: r.telemetry += out->telemetryBatch.count; break;
+                case PacketKind::Text          : ++r.text;                              break;
+                case PacketKind::Command       : ++r.commands; r.replies.push_back(out->command); break;
+                default                        : ++r.other;                             break;
+            }
+        }
+    }
+    delete out;
+}
+
+// Connects as TeensySerial does, then runs the device for seconds, a Generate every millisecond
+static Received Run(const CTeensyEmulator::Settings& settings, bool offerBatch, double seconds)
+{
+    CTeensyEmulator device(settings);
+    std::vector<uint8_t> stream;
+    Send(device, ">HOST_ACK\n", 0.0, stream);
+    Send(device, offerBatch ? ">v0.2.3:TELEMETRY_BATCH=1024\n" : ">v0.2.3\n", 0.0, stream);
+    for (double t = 0.0; t <= seconds; t += 1e-3)
+        device.Generate(t, stream);
+
+    CDecoder decoder;
+    decoder.setBlockCapacity(settings.maxBlockSize, settings.maxEventsPerBlock);
+    Received r;
+    Decode(decoder, stream, r);
+    return r;
+}
+
+
+void CTeensyEmulator::DoTest()
+{
+    std::cout << "=== CTeensyEmulator test ===\n";
+
+    // Handshake, as TeensySerial::PerformHandshake does it
+    {
+        CTeensyEmulator device;
+        std::vector<uint8_t> out;
+        Send(device, ">HOST_", 0.0, out);
+        Send(device, "ACK\n", 0.0, out);
+        std::cout << "HOST_ACK answered: " << (AsText(out) == "<DEVICE_ACK\n" ? "yes" : "NO") << "\n";
+
+        out.clear();
+        Send(device, ">v0.2.3:TELEMETRY_BATCH=1024\n", 0.0, out);
+        std::string reply = AsText(out);
+        std::cout << "Version reply: " << reply;
+        std::cout << "Streaming: " << (device.IsStreaming() ? "yes" : "no") << ", telemetry batch " << device.GetTelemetryBatch() << "\n";
+
+        out.clear();
+        Send(device, ">HOST_ACK\n", 1.0, out);
+        device.Generate(2.0, out);
+        std::cout << "New HOST_ACK stops the stream: " << (AsText(out) == "<DEVICE_ACK\n" ? "yes" : "NO") << "\n";
+    }
+
+    // Commands: replies echo the request id; Set is what a later Get reads
+    {
+        CTeensyEmulator device;
+        std::vector<uint8_t> in, out;
+        CEncoder::encodeCommand(CCommandPacket{ 1, CCommandPacket::Set,  5, 440.0 }, in);
+        CEncoder::encodeCommand(CCommandPacket{ 2, CCommandPacket::Get,  5, 0.0   }, in);
+        CEncoder::encodeCommand(CCommandPacket{ 3, CCommandPacket::Ping, 0, 7.5   }, in);
+        for (uint8_t b : in) device.Receive(&b, 1, 0.0, out);   // byte by byte
+
+        CDecoder decoder;
+        Received r;
+        Decode(decoder, out, r);
+        bool ok = r.replies.size() == 3;
+        for (size_t i = 0; ok && i < 3; ++i) ok = r.replies[i].requestId == i + 1;
+        ok = ok && r.replies[1].value == 440.0 && r.replies[2].value == 7.5;
+        std::cout << "Commands: " << r.replies.size() << " replies, " << (ok ? "as sent" : "WRONG") << "\n";
+    }
+
+    // Streams: every sample once, in order, in blocks no larger than negotiated
+    struct Case { const char* name; double multiplier; bool packed, offerBatch; };
+    for (const Case& c : { Case{ "x1", 1.0, false, true }, Case{ "x1, old host", 1.0, false, false },
+                           Case{ "x50", 50.0, false, true }, Case{ "x50 packed", 50.0, true, true } }) {
+        Settings settings;
+        settings.multiplier   = c.multiplier;
+        settings.packedBlocks = c.packed;
+        const double seconds  = 2.0;
+        const Received r = Run(settings, c.offerBatch, seconds);
+
+        const double rate = settings.samplingSpeed_Hz * c.multiplier;
+        std::cout << c.name << ": " << r.samples << " samples (" << rate * seconds << " due), " << r.gaps << " gaps, "
+                  << r.blocks << " blocks of at most " << r.largestBlock << ", "
+                  << r.telemetry << " telemetry values, " << r.text << " lines, " << r.other << " other\n";
+    }
+
+    // Generation cost
+    Settings settings;
+    settings.multiplier = 200.0;
+    CTeensyEmulator device(settings);
+    std::vector<uint8_t> out;
+    Send(device, ">v0.2.3:TELEMETRY_BATCH=1024\n", 0.0, out);
+    out.reserve(1 << 20);
+    double start = GetTime();
+    size_t bytes = 0;
+    for (double t = 0.0; t < 10.0; t += 1e-3) {
+        out.clear();
+        device.Generate(t, out);
+        bytes += out.size();
+    }
+    const double elapsed = GetTime() - start;
+    std::cout << "x200 for 10 s: " << device.GetStats().samples << " samples, " << bytes / 1e6 << " MB in " << elapsed * 1e3
+              << " ms (" << elapsed / device.GetStats().samples * 1e9 << " ns/sample)\n";
+    std::cout << "\n";
+}
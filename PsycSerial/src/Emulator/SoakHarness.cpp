@@ -0,0 +1,54 @@
+#include "SoakHarness.h"
+#include "../Utilities.h"
+#include "../_Config.h"
+
+
+namespace PsycSerial
+{
+    SoakHarness::SoakHarness(String^ hostPort, String^ devicePort)
+        : m_hostPort(hostPort), m_devicePort(devicePort), m_native(new CSoakHarness())
+    {
+        const CSoakHarness::Settings defaults;
+        StartMultiplier    = defaults.device.multiplier;
+        RampFactor         = defaults.rampFactor;
+        MaxMultiplier      = defaults.maxMultiplier;
+        StepSeconds        = defaults.stepSeconds;
+        SoakSeconds        = defaults.soakSeconds;
+        SoakFraction       = defaults.soakFraction;
+        MaxP99Milliseconds = defaults.maxP99_ms;
+        PackedBlocks       = defaults.device.packedBlocks;
+    }
+
+    SoakHarness::~SoakHarness() { this->!SoakHarness(); }
+
+    SoakHarness::!SoakHarness()
+    {
+        delete m_native;
+        m_native = nullptr;
+    }
+
+    String^ SoakHarness::Run()
+    {
+        if (m_native == nullptr) throw gcnew ObjectDisposedException("SoakHarness");
+
+        CSoakHarness::Settings settings;
+        settings.hostPort            = ConvertSysString(m_hostPort);
+        settings.devicePort          = ConvertSysString(m_devicePort);
+        settings.device.multiplier   = StartMultiplier;
+        settings.device.packedBlocks = PackedBlocks;
+        settings.rampFactor          = RampFactor;
+        settings.maxMultiplier       = MaxMultiplier;
+        settings.stepSeconds         = StepSeconds;
+        settings.soakSeconds         = SoakSeconds;
+        settings.soakFraction        = SoakFraction;
+        settings.maxP99_ms           = MaxP99Milliseconds;
+        settings.hostVersion         = ConvertSysString(Config::ProgramVersion);
+
+        return ConvertStdString(m_native->Run(settings).ToJson());
+    }
+
+    void SoakHarness::Cancel()
+    {
+        if (m_native != nullptr) m_native->Cancel();
+    }
+}
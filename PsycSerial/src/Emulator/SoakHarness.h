@@ -0,0 +1,39 @@
+// SoakHarness.h
+#pragma once
+
+#include "CSoakHarness.h"
+
+using namespace System;
+
+namespace PsycSerial
+{
+    // Throughput and latency soak of the receive path against an emulated device on a null-modem port pair (see
+    // CSoakHarness).  Run blocks for the whole ramp and soak, an hour and more with the defaults, so call it off the
+    // UI thread; Cancel ends it early.  The report is JSON, for keeping between releases.
+    public ref class SoakHarness sealed
+    {
+    public:
+        SoakHarness(String^ hostPort, String^ devicePort);
+        ~SoakHarness();
+        !SoakHarness();
+
+        property double StartMultiplier;
+        property double RampFactor;
+        property double MaxMultiplier;
+        property double StepSeconds;
+        property double SoakSeconds;        // 0 = ramp only
+        property double SoakFraction;       // of the fastest sustained rate
+        property double MaxP99Milliseconds;
+        property bool   PackedBlocks;
+
+        String^ Run();
+        void    Cancel();
+
+        static void DoTest() { CTeensyEmulator::DoTest(); CSoakRecorder::DoTest(); }
+
+    private:
+        String^       m_hostPort;
+        String^       m_devicePort;
+        CSoakHarness* m_native = nullptr;
+    };
+}
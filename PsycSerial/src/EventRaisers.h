@@ -16,18 +16,26 @@ namespace PsycSerial
 
         SerialHelper^ m_target;
         IPacket^ m_packet;
+        UInt32   m_traceId;   // CTrace id, 0 when not tracing
 
-		DataEventRaiser() : m_target(nullptr), m_packet(nullptr) {}
+		DataEventRaiser() : m_target(nullptr), m_packet(nullptr), m_traceId(0) {}
 
-		static DataEventRaiser^ Rent(SerialHelper^ target, IPacket^ packet) {
+		static DataEventRaiser^ Rent(SerialHelper^ target, IPacket^ packet, UInt32 traceId) {
 			DataEventRaiser^ raiser = s_pool->Rent();
-			raiser->m_target = target;
-			raiser->m_packet = packet;
+			raiser->m_target  = target;
+			raiser->m_packet  = packet;
+			raiser->m_traceId = traceId;
 			return raiser;
 		}
 		static void Return(IRaiser^ raiser) { s_pool->Return(safe_cast<DataEventRaiser^>(raiser)); }
 
-        DataEventRaiser(SerialHelper^ target, IPacket^ packet) : m_target(target), m_packet(packet) {
+        // Id of the frame a raiser delivers, 0 for other raisers or when not tracing
+        static UInt32 TraceIdOf(IRaiser^ raiser) {
+            DataEventRaiser^ data = dynamic_cast<DataEventRaiser^>(raiser);
+            return data != nullptr ? data->m_traceId : 0;
+        }
+
+        DataEventRaiser(SerialHelper^ target, IPacket^ packet) : m_target(target), m_packet(packet), m_traceId(0) {
             if (m_target == nullptr) throw gcnew System::ArgumentNullException("target");
             if (m_packet == nullptr) throw gcnew System::ArgumentNullException("packet");
         }
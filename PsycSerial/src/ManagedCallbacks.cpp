@@ -1,6 +1,7 @@
 #pragma once
 #include "ManagedCallbacks.h"
 #include "EventRaisers.h"
+#include "CTrace.h"
 using namespace System;
 using namespace System::Diagnostics; // For Debug::WriteLine
 
@@ -11,6 +12,8 @@ namespace PsycSerial
     void ManagedCallbacks::WorkerLoop(CancellationToken token) {
         try {
             for each(IRaiser ^ ev in m_callbackQueue->GetConsumingEnumerable(token)) {
+                const UInt32 traceId = DataEventRaiser::TraceIdOf(ev);
+                if (traceId) CTrace::Record(CTrace::Point::Dequeue, traceId);
                 try {
                     if (ev != nullptr) {
                         ev->Raise();
@@ -21,6 +24,8 @@ namespace PsycSerial
                 catch (OperationCanceledException^) { Debug::WriteLine("ManagedCallbacks: Queued task cancelled during execution.");  }
                 catch (Exception^ ex)               { Debug::WriteLine("ManagedCallbacks: Exception in queued task: " + ex->Message); }
                 finally {
+                    if (traceId) CTrace::Record(CTrace::Point::Return, traceId);
+
                     // Return to pool if applicable
                     try {
                         PoolRegistry::Return(ev);
@@ -84,6 +89,9 @@ namespace PsycSerial
         switch (m_policy)
         {
             case CallbackPolicy::Direct:
+            {
+                const UInt32 traceId = DataEventRaiser::TraceIdOf(action);
+                if (traceId) CTrace::Record(CTrace::Point::Dequeue, traceId);   // nothing queued: taken at once
                 try {
                     action->Raise();
                 }
@@ -91,6 +99,8 @@ namespace PsycSerial
                     Debug::WriteLine("ManagedCallbacks: Exception in direct execution: " + ex->Message);
                 }
                 finally {
+                    if (traceId) CTrace::Record(CTrace::Point::Return, traceId);
+
                     // Return to pool if applicable
                     try {
                         PoolRegistry::Return(action);
@@ -98,6 +108,7 @@ namespace PsycSerial
 					catch (Exception^ ex) { Debug::WriteLine("ManagedCallbacks: Exception returning action to pool: " + ex->Message); }
 				}
                 break;
+            }
 
             case CallbackPolicy::ThreadPool:
                 // static method reference
@@ -24,22 +24,21 @@ CDiscontinuityFixer::~CDiscontinuityFixer() {
 
 CDiscontinuityFixer::Result CDiscontinuityFixer::Fix(double x, double y) noexcept
 {
-	m_data.emplace_back(x, y, currentOffsetY);   if (m_data.size() > ZFIXER_BUFFER_SIZE) m_data.erase(m_data.begin(), m_data.end() - ZFIXER_WINDOW_SIZE);
+	m_data.Append(x, y, currentOffsetY);   if (m_data.size() > ZFIXER_BUFFER_SIZE) m_data.DropFront(m_data.size() - ZFIXER_WINDOW_SIZE);
 	if (m_data.size() < ZFIXER_WINDOW_SIZE) return Result::FromFail(x, y, currentOffsetY);
 
 	auto start = m_data.size() - ZFIXER_WINDOW_SIZE;  // analyze the most recent window
-	auto span = std::span<const XY>(m_data.data() + start, ZFIXER_WINDOW_SIZE);
 
 	std::vector<XY> workingData(ZFIXER_WINDOW_SIZE);
-	XY::CentreX(span, workingData);
+	m_data.CentreX(start, ZFIXER_WINDOW_SIZE, workingData);
 
 	auto analysis = CDiscontinuityAnalyzer::Analyze(workingData, ZFIXER_WINDOW_EDGE);
 
 	size_t outputIndex = m_data.size() - ZFIXER_WINDOW_SIZE + ZFIXER_WINDOW_EDGE;
 
 	*_lastAnalysis = analysis;
-	_lastAnalysis->deltaX = m_data[m_data.size() - 1].x() - m_data[outputIndex].x();
-	_lastAnalysis->centreX = m_data[start].x() - workingData[0].x();
+	_lastAnalysis->deltaX = m_data.x(m_data.size() - 1) - m_data.x(outputIndex);
+	_lastAnalysis->centreX = m_data.x(start) - workingData[0].x();
 
 	return Process(workingData, analysis);
 }
@@ -52,7 +51,7 @@ CDiscontinuityFixer::Result CDiscontinuityFixer::Process(std::span<XY> workingDa
 	size_t outputIndex = m_data.size() - ZFIXER_WINDOW_SIZE + ZFIXER_WINDOW_EDGE;
 
 	result.changed = analysis.valid && (analysis.score > THRESHOLD_SCORE);
-	result.output = m_data[outputIndex];
+	result.output = m_data.At(outputIndex);
 	lastY = result.output.y();
 
 	if (result.changed == false || true) {
@@ -86,17 +85,16 @@ CDiscontinuityFixer::Result CDiscontinuityFixer::Process(std::span<XY> workingDa
 		double averageY = 0.5 * (yL + yR);
 
 		size_t m_dataIndex = i + m_dataIndexOffset;
-		m_data[m_dataIndex].adjustOffsetY(averageY - m_data[m_dataIndex].y());  // adjust offsetY to align curves
+		m_data.AdjustOffsetY(m_dataIndex, m_dataIndex + 1, averageY - m_data.y(m_dataIndex));  // adjust offsetY to align curves
 	}
 
 
 	// move right edge of M_DATA down by deltaY
-	for (size_t i = m_data.size() - ZFIXER_WINDOW_EDGE; i < m_data.size(); i++)
-		m_data[i].adjustOffsetY(-analysis.deltaY);
+	m_data.AdjustOffsetY(m_data.size() - ZFIXER_WINDOW_EDGE, m_data.size(), -analysis.deltaY);
 
 
 	// the XY returned is last non-edge point
-	result.output = m_data[outputIndex];
+	result.output = m_data.At(outputIndex);
 	result.changed = true;
 
 	currentOffsetY += -analysis.deltaY;
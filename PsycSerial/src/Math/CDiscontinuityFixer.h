@@ -4,6 +4,7 @@
 
 #include "CTypes.h"
 #include "CDiscontinuityAnalyzer.h"
+#include "CSegmentedSeries.h"
 #include <span>
 #include <vector>
 
@@ -130,7 +131,7 @@ class CDiscontinuityFixer {
 		CDiscontinuityAnalyzer::Result* _lastAnalysis;
 		double lastY{ 0.0 };
 
-		std::vector<XY> m_data{};
+		CSegmentedSeries m_data{};
 
 		double currentOffsetY{ 0.0 };
 		std::ofstream debugFile;
@@ -10,26 +10,25 @@ class CLinearRegress {
 public:
     
     static RegressResult Fit(std::span<const XY> p) noexcept {
-        const size_t n = p.size();
-        if (n < 2)
+        if (p.size() < 2)
             return {};
 
-        double sumX = 0, sumY = 0, sumXY = 0, sumX2 = 0;
-        for (size_t i = 0; i < n; ++i) {
-            sumX  += p[i].x();
-            sumY  += p[i].y();
-            sumXY += p[i].x() * p[i].y();
-            sumX2 += p[i].x() * p[i].x();
-        }
+        return Fit(RegressMoments::Accumulate(p));
+    }
+
+    // Straight line from already accumulated moments (shared with CQuadRegress's fallback)
+    static RegressResult Fit(const RegressMoments& m) noexcept {
+        if (m.n < 2)
+            return {};
 
-        const double denom = n * sumX2 - sumX * sumX;
+        const double denom = m.n * m.sx2 - m.sx * m.sx;
         if (std::abs(denom) < 1e-12)
             return {};
 
-        const double slope = (n * sumXY - sumX * sumY) / denom;
-        const double intercept = (sumY - slope * sumX) / n;
+        const double slope = (m.n * m.sxy - m.sx * m.sy) / denom;
+        const double intercept = (m.sy - slope * m.sx) / m.n;
 
-        return RegressResult::GetLinearResult( slope, intercept, true, p );
+        return RegressResult::FromMoments(0.0, slope, intercept, true, m);
     }
 };
 
@@ -5,6 +5,7 @@
 // Matrix3x3.hpp
 #pragma once
 #include "CTypes.h"
+#include <cstdint>
 
 class CMatrix3x3 {
 public:
@@ -24,6 +25,82 @@ public:
         return X;
     }
 
+    // Symmetric solve via LDL^T. Only the lower triangle of A is read.
+    // Same singularity rule as TrySolve, plus non-positive pivots are rejected (normal matrices are SPD).
+    static std::optional<Vec3> TrySolveSymmetric(const Mat3& A, const Vec3& B) noexcept {
+        const double d0  = A[0][0];
+        const double l10 = A[1][0] / d0;
+        const double l20 = A[2][0] / d0;
+        const double d1  = A[1][1] - l10 * A[1][0];
+        const double l21 = (A[2][1] - l20 * A[1][0]) / d1;
+        const double d2  = A[2][2] - l20 * A[2][0] - l21 * l21 * d1;
+
+        if (!(d0 > 0.0 && d1 > 0.0 && d2 > 0.0) || std::fabs(d0 * d1 * d2) < 1e-10)
+            return std::nullopt;
+
+        // forward (L z = B), diagonal (D y = z), back (L^T x = y)
+        const double z0 = B[0];
+        const double z1 = B[1] - l10 * z0;
+        const double z2 = B[2] - l20 * z0 - l21 * z1;
+
+        Vec3 X{};
+        X[2] = z2 / d2;
+        X[1] = z1 / d1 - l21 * X[2];
+        X[0] = z0 / d0 - l10 * X[1] - l20 * X[2];
+        return X;
+    }
+
+    // Quadratic normal equations: the matrix is Hankel, fully described by the moments m[k] = sum(x^k), k = 0..4.
+    // t[k] = sum(x^k * y), k = 0..2.  Returns coefficients c[k] of x^k (constant first).
+    static std::optional<Vec3> TrySolveHankel(const std::array<double, 5>& m, const Vec3& t) noexcept {
+        Mat3 A = { {
+            { m[0], m[1], m[2] },
+            { m[1], m[2], m[3] },
+            { m[2], m[3], m[4] }
+        } };
+        return TrySolveSymmetric(A, t);
+    }
+
+    // Many windows at once, one entry per window in each array (SoA).  Straight-line body so the loop vectorizes;
+    // ok[i] is 0 where the window is singular and c*[i] must then be ignored.
+    struct HankelBatch {
+        std::span<const double> m0, m1, m2, m3, m4;
+        std::span<const double> t0, t1, t2;
+    };
+
+    struct HankelBatchResult {
+        std::span<double>  c0, c1, c2;
+        std::span<uint8_t> ok;
+    };
+
+    static void SolveHankelBatch(const HankelBatch& in, const HankelBatchResult& out) noexcept {
+        const size_t n = in.m0.size();
+
+        for (size_t i = 0; i < n; ++i) {
+            const double d0  = in.m0[i];
+            const double l10 = in.m1[i] / d0;
+            const double l20 = in.m2[i] / d0;
+            const double d1  = in.m2[i] - l10 * in.m1[i];
+            const double l21 = (in.m3[i] - l20 * in.m1[i]) / d1;
+            const double d2  = in.m4[i] - l20 * in.m2[i] - l21 * l21 * d1;
+
+            const double z0 = in.t0[i];
+            const double z1 = in.t1[i] - l10 * z0;
+            const double z2 = in.t2[i] - l20 * z0 - l21 * z1;
+
+            const double x2 = z2 / d2;
+            const double x1 = z1 / d1 - l21 * x2;
+            const double x0 = z0 / d0 - l10 * x1 - l20 * x2;
+
+            out.c0[i] = x0;
+            out.c1[i] = x1;
+            out.c2[i] = x2;
+            out.ok[i] = static_cast<uint8_t>((d0 > 0.0) & (d1 > 0.0) & (d2 > 0.0) & (std::fabs(d0 * d1 * d2) >= 1e-10));
+        }
+    }
+
+    static void DoTest();
+
 private:
     static double Determinant(const Mat3& M) noexcept {
         return
@@ -33,4 +110,4 @@ private:
     }
 };
 
-#pragma managed(pop)
\ No newline at end of file
+#pragma managed(pop)
@@ -0,0 +1,118 @@
+#include "CMatrix3x3.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+
+constexpr size_t WINDOW  = 10;        // samples per regression window (matches ZFIXER_WINDOW_SIZE)
+constexpr size_t WINDOWS = 200'000;   // windows per timing run
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+
+// Moments of y = c0 + c1*x + c2*x^2 sampled at x0 + i*dx, i.e. an exact (noise-free) window
+static void MakeWindow(double x0, double dx, const Vec3& c, std::array<double, 5>& m, Vec3& t)
+{
+    m = {}; t = {};
+    for (size_t i = 0; i < WINDOW; ++i) {
+        double x = x0 + i * dx;
+        double y = c[0] + c[1] * x + c[2] * x * x;
+        double xk = 1.0;
+        for (size_t k = 0; k < 5; ++k, xk *= x) {
+            m[k] += xk;
+            if (k < 3) t[k] += xk * y;
+        }
+    }
+}
+
+static double RelError(const Vec3& got, const Vec3& want)
+{
+    double worst = 0.0;
+    for (size_t k = 0; k < 3; ++k)
+        worst = std::max(worst, std::fabs(got[k] - want[k]) / std::max(1.0, std::fabs(want[k])));
+    return worst;
+}
+
+// Cramer path as CQuadRegress used it: descending powers, result reversed
+static std::optional<Vec3> SolveCramer(const std::array<double, 5>& m, const Vec3& t)
+{
+    Mat3 A = { { { m[4], m[3], m[2] }, { m[3], m[2], m[1] }, { m[2], m[1], m[0] } } };
+    auto s = CMatrix3x3::TrySolve(A, { t[2], t[1], t[0] });
+    if (!s) return std::nullopt;
+    return Vec3{ (*s)[2], (*s)[1], (*s)[0] };
+}
+
+
+void CMatrix3x3::DoTest()
+{
+    std::cout << "=== CMatrix3x3 Hankel solver test ===\n";
+
+    // Accuracy: well-conditioned (normalized x) through badly conditioned (raw timestamps, tiny spacing)
+    struct Case { const char* name; double x0; double dx; };
+    const Case cases[] = {
+        { "normalized [-1,1]", -1.0 , 2.0 / (WINDOW - 1) },
+        { "x0=10, dx=0.1   ",  10.0, 0.1                },
+        { "x0=100, dx=1e-3 ", 100.0, 1e-3               },
+        { "x0=1e3, dx=1e-4 ", 1e3  , 1e-4               },
+    };
+    const Vec3 coeffs = { 3.0, -0.5, 0.25 };
+
+    for (const auto& c : cases) {
+        std::array<double, 5> m; Vec3 t;
+        MakeWindow(c.x0, c.dx, coeffs, m, t);
+
+        auto cramer = SolveCramer(m, t);
+        auto ldl    = TrySolveHankel(m, t);
+
+        std::cout << c.name
+                  << "  cramer: " << (cramer ? std::to_string(RelError(*cramer, coeffs)) : std::string("singular"))
+                  << "  ldl: "    << (ldl    ? std::to_string(RelError(*ldl   , coeffs)) : std::string("singular")) << "\n";
+    }
+
+    // Timing: random normalized windows, scalar Cramer vs scalar LDL vs batched LDL
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> coeff(-10.0, 10.0);
+
+    std::vector<double> m0(WINDOWS), m1(WINDOWS), m2(WINDOWS), m3(WINDOWS), m4(WINDOWS);
+    std::vector<double> t0(WINDOWS), t1(WINDOWS), t2(WINDOWS);
+    for (size_t i = 0; i < WINDOWS; ++i) {
+        std::array<double, 5> m; Vec3 t;
+        MakeWindow(-1.0, 2.0 / (WINDOW - 1), { coeff(rng), coeff(rng), coeff(rng) }, m, t);
+        m0[i] = m[0]; m1[i] = m[1]; m2[i] = m[2]; m3[i] = m[3]; m4[i] = m[4];
+        t0[i] = t[0]; t1[i] = t[1]; t2[i] = t[2];
+    }
+
+    double checksum = 0.0;
+
+    double start = GetTime();
+    for (size_t i = 0; i < WINDOWS; ++i)
+        if (auto s = SolveCramer({ m0[i], m1[i], m2[i], m3[i], m4[i] }, { t0[i], t1[i], t2[i] })) checksum += (*s)[2];
+    double tCramer = GetTime() - start;
+
+    start = GetTime();
+    for (size_t i = 0; i < WINDOWS; ++i)
+        if (auto s = TrySolveHankel({ m0[i], m1[i], m2[i], m3[i], m4[i] }, { t0[i], t1[i], t2[i] })) checksum += (*s)[2];
+    double tLdl = GetTime() - start;
+
+    std::vector<double> c0(WINDOWS), c1(WINDOWS), c2(WINDOWS);
+    std::vector<uint8_t> ok(WINDOWS);
+    start = GetTime();
+    SolveHankelBatch({ m0, m1, m2, m3, m4, t0, t1, t2 }, { c0, c1, c2, ok });
+    double tBatch = GetTime() - start;
+    for (size_t i = 0; i < WINDOWS; ++i) if (ok[i]) checksum += c2[i];
+
+    auto ns = [](double seconds) { return seconds * 1e9 / WINDOWS; };
+    std::cout << "Windows: " << WINDOWS << "\n";
+    std::cout << "Cramer: " << ns(tCramer) << " ns/solve\n";
+    std::cout << "LDL   : " << ns(tLdl   ) << " ns/solve\n";
+    std::cout << "Batch : " << ns(tBatch ) << " ns/solve\n";
+    std::cout << "(checksum " << checksum << ")\n\n";
+}
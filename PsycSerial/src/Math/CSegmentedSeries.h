@@ -0,0 +1,123 @@
+#pragma once
+#pragma managed(push, off)
+
+#include "CTypes.h"
+#include <algorithm>
+#include <span>
+#include <vector>
+
+// Sample history for the fixer.  Raw x / y live in separate contiguous arrays; offsetY is not stored per point
+// but as a short list of breakpoints, each giving the offset from its start index up to the next breakpoint.
+// The fixer only ever shifts whole runs of samples, so the list stays tiny.
+class CSegmentedSeries {
+public:
+    void reserve(size_t n) { m_x.reserve(n); m_y.reserve(n); }
+
+    size_t size()  const { return m_x.size(); }
+    bool   empty() const { return m_x.empty(); }
+
+    inline double x   (size_t i) const { return m_x[i]; }
+    inline double rawY(size_t i) const { return m_y[i]; }
+    inline double y   (size_t i) const { return m_y[i] + OffsetAt(i); }
+    inline XY     At  (size_t i) const { return XY(m_x[i], m_y[i], OffsetAt(i)); }
+
+    std::span<const double> X()    const { return m_x; }
+    std::span<const double> RawY() const { return m_y; }
+
+    void Append(double x, double y, double offsetY) {
+        if (m_breaks.empty() || m_breaks.back().offsetY != offsetY)
+            m_breaks.push_back({ m_x.size(), offsetY });
+
+        m_x.push_back(x);
+        m_y.push_back(y);
+    }
+
+    // Drop the oldest samples, rebasing breakpoint indices
+    void DropFront(size_t count) {
+        count = std::min(count, size());
+        if (count == 0) return;
+
+        m_x.erase(m_x.begin(), m_x.begin() + count);
+        m_y.erase(m_y.begin(), m_y.begin() + count);
+
+        auto cover = std::prev(FindSegment(count));  // segment covering the new front
+        m_breaks.erase(m_breaks.begin(), cover);
+        for (auto& b : m_breaks)
+            b.start = (b.start > count) ? b.start - count : 0;
+
+        if (m_x.empty()) m_breaks.clear();
+    }
+
+    // Shift offsetY for samples [begin, end) by delta
+    void AdjustOffsetY(size_t begin, size_t end, double delta) {
+        end = std::min(end, size());
+        if (begin >= end || delta == 0.0) return;
+
+        Split(begin);
+        if (end < size()) Split(end);
+
+        for (auto& b : m_breaks)
+            if (b.start >= begin && b.start < end)
+                b.offsetY += delta;
+
+        Merge();
+    }
+
+    double OffsetAt(size_t i) const {
+        auto it = FindSegment(i);
+        return (it == m_breaks.begin()) ? 0.0 : std::prev(it)->offsetY;
+    }
+
+    // Copy [start, start + count) into out with x centred on its mean and y = raw + offset
+    void CentreX(size_t start, size_t count, std::span<XY> out) const {
+        if (out.size() != count) throw std::invalid_argument("Output span must match the requested count.");
+        if (count == 0) return;
+
+        const double* px = m_x.data() + start;
+        double meanX = 0.0;
+        for (size_t i = 0; i < count; ++i)
+            meanX += px[i];
+        meanX /= count;
+
+        auto seg = std::prev(FindSegment(start));
+        for (size_t i = 0; i < count; ++i) {
+            size_t idx = start + i;
+            auto next = std::next(seg);
+            if (next != m_breaks.end() && next->start == idx) seg = next;
+
+            out[i] = XY(px[i] - meanX, m_y[idx], seg->offsetY);
+        }
+    }
+
+private:
+    struct Breakpoint {
+        size_t start;
+        double offsetY;
+    };
+
+    std::vector<double>     m_x{};
+    std::vector<double>     m_y{};
+    std::vector<Breakpoint> m_breaks{};   // sorted by start, first at 0 while non-empty
+
+    // first breakpoint starting after i
+    std::vector<Breakpoint>::const_iterator FindSegment(size_t i) const {
+        return std::upper_bound(m_breaks.begin(), m_breaks.end(), i,
+            [](size_t v, const Breakpoint& b) { return v < b.start; });
+    }
+
+    void Split(size_t i) {
+        auto it = FindSegment(i);
+        if (it != m_breaks.begin() && std::prev(it)->start == i) return;
+
+        double offset = (it == m_breaks.begin()) ? 0.0 : std::prev(it)->offsetY;
+        m_breaks.insert(it, { i, offset });
+    }
+
+    void Merge() {
+        auto last = std::unique(m_breaks.begin(), m_breaks.end(),
+            [](const Breakpoint& a, const Breakpoint& b) { return a.offsetY == b.offsetY; });
+        m_breaks.erase(last, m_breaks.end());
+    }
+};
+
+#pragma managed(pop)
@@ -46,6 +46,45 @@ public:
     
 };
 
+// Power sums of a window, gathered in a single pass.  x is normalised to [-1, 1] about the window centre and
+// y is taken relative to the first sample, so the residual expansions in RegressResult do not cancel badly.
+struct RegressMoments {
+    double n{}, sx{}, sx2{}, sx3{}, sx4{}, sy{}, sxy{}, sx2y{}, sy2{};
+
+    double mid{}, hr{ 1.0 }, yRef{};       // x = mid + hr * xn,  y = yRef + y'
+    double xFront{}, xBack{};              // end points (data is ordered by x)
+
+    static RegressMoments Accumulate(std::span<const XY> data) noexcept {
+        RegressMoments m{};
+        if (data.empty()) return m;
+
+        m.xFront = data.front().x();
+        m.xBack  = data. back().x();
+        m.yRef   = data.front().y();
+        m.mid    = 0.5 * (m.xFront + m.xBack);
+        m.hr     = 0.5 * (m.xBack - m.xFront);
+        if (std::fabs(m.hr) < 0.5e-10) m.hr = 1.0;   // constant x: leave unscaled, the fit will report singular
+
+        const double invHr = 1.0 / m.hr;
+        for (const auto& pt : data) {
+            double xn  = (pt.x() - m.mid) * invHr;
+            double yn  = pt.y() - m.yRef;
+            double xn2 = xn * xn;
+
+            m.sx   += xn;
+            m.sx2  += xn2;
+            m.sx3  += xn2 * xn;
+            m.sx4  += xn2 * xn2;
+            m.sy   += yn;
+            m.sxy  += xn * yn;
+            m.sx2y += xn2 * yn;
+            m.sy2  += yn * yn;
+        }
+        m.n = static_cast<double>(data.size());
+        return m;
+    }
+};
+
 struct RegressResult {
     double a{}, b{}, c{};
     bool valid{ false };
@@ -53,65 +92,43 @@ struct RegressResult {
 	// fit quality metrics
     double r2{ 0.0 };      // coefficient of determination
     double rmse{ 0.0 };    // root-mean-square error 
-    double curvature;   // absolute a coefficient (normalized)
-    double slopeMean;   // mean slope across segment
-
-	// sets fit quality metrics
-	void GetFit(std::span<const XY> data) {
-        double ss_tot = 0.0, ss_res = 0.0, sumY = 0.0;
-        for (const auto& xy : data)
-			sumY += xy.y();
-		double meanY = sumY / data.size();
-
-        for (auto& xy : data)
-        {
-            double y_pred = EvaluateAt(xy.x());
-            double diff   = xy.y() - y_pred;    ss_res +=  diff *  diff;
-            double dmean  = xy.y() -  meanY;    ss_tot += dmean * dmean;
-        }
-
-        rmse = std::sqrt(ss_res / data.size());
-        r2 = 1.0 - (ss_res / ss_tot);
-
-
-
-        double dx = data.back().x() - data.front().x();
-        double slope1 = 2 * a * data.front().x() + b;
-        double slope2 = 2 * a * data. back().x() + b;
-        
-        slopeMean = 0.5 * (slope1 + slope2);
-        curvature = fabs(a) * dx * dx;  // dimensionless-ish normalization
-	}
+    double curvature{ 0.0 };   // absolute a coefficient (normalized)
+    double slopeMean{ 0.0 };   // mean slope across segment
 
     inline double EvaluateAt(double x) const {
         return a * x * x + b * x + c;
 	}
 
-
-	static RegressResult GetLinearResult(double slope, double intercept,   bool valid, std::span<const XY> data) {
-		RegressResult r{};
-		r.a = 0.0;
-		r.b = slope;
-		r.c = intercept;
-
-		r.GetFit(data);
-
-		r.valid = valid && r.rmse < 1.0;
-
-		return r;
-	}
-
-    static RegressResult GetQuadraticResult(double a, double b, double c,  bool valid, std::span<const XY> data) {
-        RegressResult r{};
-        r.a = a;
-        r.b = b;
-        r.c = c;
-
-        r.GetFit(data);
-
-
-        r.valid = valid && r.rmse < 1.0;
-        return r;
-	}
+    // Builds the result from a fit in normalised coordinates, y' = p*xn^2 + q*xn + r.
+    // Quality metrics come from the same moments: no further pass over the data.
+    static RegressResult FromMoments(double p, double q, double r, bool valid, const RegressMoments& m) {
+        RegressResult res{};
+
+        double ss_res = m.sy2
+                      - 2.0 * (p * m.sx2y + q * m.sxy + r * m.sy)
+                      + p * p * m.sx4 + 2.0 * p * q * m.sx3 + (q * q + 2.0 * p * r) * m.sx2
+                      + 2.0 * q * r * m.sx + r * r * m.n;
+        double ss_tot = m.sy2 - m.sy * m.sy / m.n;
+        if (ss_res < 0.0) ss_res = 0.0;   // rounding on a (near) perfect fit
+
+        res.rmse = std::sqrt(ss_res / m.n);
+        res.r2   = 1.0 - (ss_res / ss_tot);
+
+        // back to original coordinates
+        double hr2 = m.hr * m.hr;
+        res.a = p / hr2;
+        res.b = (q / m.hr) - 2.0 * m.mid * res.a;
+        res.c = r - m.mid * (q / m.hr) + m.mid * m.mid * res.a + m.yRef;
+
+        double dx = m.xBack - m.xFront;
+        double slope1 = 2 * res.a * m.xFront + res.b;
+        double slope2 = 2 * res.a * m.xBack  + res.b;
+
+        res.slopeMean = 0.5 * (slope1 + slope2);
+        res.curvature = fabs(res.a) * dx * dx;  // dimensionless-ish normalization
+
+        res.valid = valid && res.rmse < 1.0;
+        return res;
+    }
 };
 #pragma managed(pop)
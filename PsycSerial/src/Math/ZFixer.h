@@ -2,6 +2,7 @@
 
 #include "CDiscontinuityFixer.h"
 #include "CDiscontinuityAnalyzer.h"
+#include "CMatrix3x3.h"
 
 using namespace System::Collections::Generic;
 using namespace System::Runtime::CompilerServices;
@@ -51,6 +52,7 @@ namespace PsycSerial::Math
 		}
 
 		static void DoTest() { CDiscontinuityAnalyzer::DoTest(); }
+		static void DoSolverTest() { CMatrix3x3::DoTest(); }
 
 		static XY GetTestValue( double% x, double% y ) {
 			auto v = CDiscontinuityAnalyzer::GetTestValue();
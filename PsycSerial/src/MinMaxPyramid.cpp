@@ -0,0 +1,84 @@
+#include "MinMaxPyramid.h"
+
+namespace PsycSerial
+{
+
+    // Deterministic cleanup
+    MinMaxPyramid::~MinMaxPyramid() { this->!MinMaxPyramid(); }
+
+    // Finalizer (in case user forgets to Dispose)
+    MinMaxPyramid::!MinMaxPyramid() { delete _p; _p = nullptr; }
+
+
+    MinMaxPyramid::MinMaxPyramid(int capacity, int levels)
+    {
+        if (capacity <= 0) throw gcnew ArgumentOutOfRangeException("capacity");
+        if (levels   <= 0) throw gcnew ArgumentOutOfRangeException("levels");
+        _p = new CMinMaxPyramid(static_cast<size_t>(capacity), static_cast<size_t>(levels));
+    }
+
+    void MinMaxPyramid::Clear()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("MinMaxPyramid");
+        _p->Clear();
+    }
+
+    void MinMaxPyramid::Add(double x, double y)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("MinMaxPyramid");
+        _p->Add(x, y);
+    }
+
+    void MinMaxPyramid::AddRange(array<double>^ x, array<double>^ y)
+    {
+        if (x == nullptr) throw gcnew ArgumentNullException("x");
+        if (y == nullptr) throw gcnew ArgumentNullException("y");
+        AddRange(x, y, 0, Math::Min(x->Length, y->Length));
+    }
+
+    void MinMaxPyramid::AddRange(array<double>^ x, array<double>^ y, int offset, int count)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("MinMaxPyramid");
+        if (x == nullptr) throw gcnew ArgumentNullException("x");
+        if (y == nullptr) throw gcnew ArgumentNullException("y");
+        if (offset < 0 || count < 0 || offset + count > x->Length || offset + count > y->Length) throw gcnew ArgumentOutOfRangeException("count");
+        if (count == 0) return;
+
+        pin_ptr<double> px = &x[offset];
+        pin_ptr<double> py = &y[offset];
+        _p->AddRange(std::span<const double>(px, static_cast<size_t>(count)),
+                     std::span<const double>(py, static_cast<size_t>(count)));
+    }
+
+    int MinMaxPyramid::Query(double x0, double x1, array<double>^ min, array<double>^ max)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("MinMaxPyramid");
+        if (min == nullptr) throw gcnew ArgumentNullException("min");
+        if (max == nullptr) throw gcnew ArgumentNullException("max");
+        if (min->Length != max->Length) throw gcnew ArgumentException("min and max must be the same length");
+        if (min->Length == 0) return -1;
+
+        pin_ptr<double> pMin = &min[0];
+        pin_ptr<double> pMax = &max[0];
+        return _p->Query(x0, x1, std::span<double>(pMin, static_cast<size_t>(min->Length)),
+                                 std::span<double>(pMax, static_cast<size_t>(max->Length)));
+    }
+
+    double MinMaxPyramid::FirstX::get()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("MinMaxPyramid");
+        return _p->GetFirstX();
+    }
+
+    double MinMaxPyramid::LastX::get()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("MinMaxPyramid");
+        return _p->GetLastX();
+    }
+
+    bool MinMaxPyramid::IsEmpty::get()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("MinMaxPyramid");
+        return _p->IsEmpty();
+    }
+} // namespace PsycSerial
@@ -0,0 +1,37 @@
+// MinMaxPyramid.h
+#pragma once
+
+#include <cstdint>
+#include "CMinMaxPyramid.h"
+
+using namespace System;
+
+namespace PsycSerial
+{
+    public ref class MinMaxPyramid sealed
+    {
+    private:
+        CMinMaxPyramid* _p = nullptr;
+
+    public:
+        MinMaxPyramid(int capacity, int levels);
+        ~MinMaxPyramid();
+        !MinMaxPyramid();
+
+
+        void Clear();
+        void Add(double x, double y);
+        void AddRange(array<double>^ x, array<double>^ y);
+        void AddRange(array<double>^ x, array<double>^ y, int offset, int count);
+
+        // One min/max pair per pixel (min->Length pixels) over [x0, x1); empty pixels are NaN.
+        // Returns the pyramid level used, or -1 if nothing was in range.
+        int Query(double x0, double x1, array<double>^ min, array<double>^ max);
+
+        static void DoTest() { CMinMaxPyramid::DoTest(); }
+
+        property double FirstX  { inline double get(); }
+        property double LastX   { inline double get(); }
+        property bool   IsEmpty { inline bool   get(); }
+    };
+}
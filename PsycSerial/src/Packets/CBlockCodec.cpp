@@ -0,0 +1,312 @@
+#include "CBlockCodec.h"
+#pragma managed(push, off)
+
+#include <algorithm>
+#include <cstring>
+
+#include "../CCpuFeatures.h"
+
+static constexpr size_t CH = CDataPacket::A2D_NUM_CHANNELS;
+static_assert(CH == 8, "a channel row is unpacked as two 4-lane halves");
+
+
+
+// ------------------------------------------------------------------ primitives
+
+namespace
+{
+    inline uint64_t ZigZag  (int64_t  v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+    inline int64_t  UnZigZag(uint64_t z) { return static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1); }
+
+    inline uint64_t Bits(double d)   { uint64_t b; std::memcpy(&b, &d, sizeof b); return b; }
+    inline double   Double(uint64_t b) { double d; std::memcpy(&d, &b, sizeof d); return d; }
+
+    inline uint64_t Load64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, sizeof v); return v; }
+
+    struct Writer {
+        std::vector<uint8_t>& out;
+
+        template <typename T> void Raw(const T& v) {
+            const auto* p = reinterpret_cast<const uint8_t*>(&v);
+            out.insert(out.end(), p, p + sizeof v);
+        }
+        void Varint(uint64_t v) {
+            while (v >= 0x80) { out.push_back(static_cast<uint8_t>(v | 0x80)); v >>= 7; }
+            out.push_back(static_cast<uint8_t>(v));
+        }
+    };
+
+    // Bounds-checked; any overrun clears ok and reads zeros from then on
+    struct Reader {
+        const uint8_t* p;
+        const uint8_t* end;
+        bool           ok{ true };
+
+        template <typename T> T Raw() {
+            T v{};
+            if (p > end || static_cast<size_t>(end - p) < sizeof v) { ok = false; p = end; return v; }
+            std::memcpy(&v, p, sizeof v);
+            p += sizeof v;
+            return v;
+        }
+        template <typename Layout, typename S> void Fields(S& s) {
+            if (p > end || static_cast<size_t>(end - p) < Layout::SIZE) { ok = false; p = end; return; }
+            Layout::Read(p, s);
+            p += Layout::SIZE;
+        }
+        uint64_t Varint() {
+            if (p != end && *p < 0x80) return *p++;
+            uint64_t v = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7) {
+                if (p == end) break;
+                const uint8_t b = *p++;
+                v |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if (!(b & 0x80)) return v;
+            }
+            ok = false;
+            return 0;
+        }
+    };
+
+    // ---- timestamps: delta-of-delta of the bit patterns
+
+    template <typename Get>
+    void EncodeTimes(Writer& w, uint32_t count, Get get)
+    {
+        if (count == 0) return;
+        uint64_t prev = Bits(get(0)), delta = 0;
+        w.Raw(prev);
+        for (uint32_t i = 1; i < count; ++i) {
+            const uint64_t bits = Bits(get(i)), d = bits - prev;
+            w.Varint(ZigZag(static_cast<int64_t>(d - delta)));
+            prev  = bits;
+            delta = d;
+        }
+    }
+
+    template <typename Set>
+    void DecodeTimes(Reader& r, uint32_t count, Set set)
+    {
+        if (count == 0) return;
+        uint64_t bits = r.Raw<uint64_t>(), delta = 0;
+        set(0, Double(bits));
+        for (uint32_t i = 1; i < count && r.ok; ++i) {
+            delta += static_cast<uint64_t>(UnZigZag(r.Varint()));
+            bits  += delta;
+            set(i, Double(bits));
+        }
+    }
+
+    // ---- channel rows: a width byte, then 8 zigzag deltas of that many bits (so the row is `width` bytes)
+
+    struct RowLayout {
+        uint64_t shift[CH];   // bit offset of lane k within the word loaded at byte[k]
+        uint32_t byte [CH];
+        uint64_t mask;
+    };
+
+    struct RowLayouts {
+        RowLayout width[33];
+
+        RowLayouts() {
+            for (unsigned w = 0; w <= 32; ++w) {
+                width[w].mask = (1ull << w) - 1;
+                for (unsigned k = 0; k < CH; ++k) {
+                    width[w].byte [k] = (k * w) >> 3;
+                    width[w].shift[k] = (k * w) & 7;
+                }
+            }
+        }
+    };
+
+    const RowLayouts& Layouts()
+    {
+        static const RowLayouts layouts;
+        return layouts;
+    }
+
+    // Both unpackers: rows from src, which has its padding before end; returns the end of the rows or nullptr
+    const uint8_t* UnpackRowsScalar(const uint8_t* src, const uint8_t* end, size_t rows, CDataPacket* items)
+    {
+        const RowLayouts& layouts = Layouts();
+        uint32_t acc[CH];
+        std::memcpy(acc, items[0].channel, sizeof acc);
+
+        for (size_t r = 0; r < rows; ++r) {
+            const unsigned width = src < end ? *src++ : 255;
+            if (width > 32 || static_cast<size_t>(end - src) < width + CBlockCodec::PADDING) return nullptr;
+
+            const RowLayout& l = layouts.width[width];
+            for (unsigned k = 0; k < CH; ++k) {
+                const uint32_t z = static_cast<uint32_t>((Load64(src + l.byte[k]) >> l.shift[k]) & l.mask);
+                acc[k] += (z >> 1) ^ (0u - (z & 1));
+            }
+            std::memcpy(items[r + 1].channel, acc, sizeof acc);
+            src += width;
+        }
+        return src;
+    }
+
+#ifdef CPU_X64
+    CPU_TARGET_AVX2
+    const uint8_t* UnpackRowsAvx2(const uint8_t* src, const uint8_t* end, size_t rows, CDataPacket* items)
+    {
+        const RowLayouts& layouts = Layouts();
+        const __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);   // low halves of the 64-bit lanes
+        const __m256i one  = _mm256_set1_epi32(1);
+        __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(items[0].channel));
+
+        for (size_t r = 0; r < rows; ++r) {
+            const unsigned width = src < end ? *src++ : 255;
+            if (width > 32 || static_cast<size_t>(end - src) < width + CBlockCodec::PADDING) return nullptr;
+
+            const RowLayout& l = layouts.width[width];
+            const __m256i mask = _mm256_set1_epi64x(static_cast<int64_t>(l.mask));
+            __m256i lo = _mm256_setr_epi64x(static_cast<int64_t>(Load64(src + l.byte[0])), static_cast<int64_t>(Load64(src + l.byte[1])),
+                                            static_cast<int64_t>(Load64(src + l.byte[2])), static_cast<int64_t>(Load64(src + l.byte[3])));
+            __m256i hi = _mm256_setr_epi64x(static_cast<int64_t>(Load64(src + l.byte[4])), static_cast<int64_t>(Load64(src + l.byte[5])),
+                                            static_cast<int64_t>(Load64(src + l.byte[6])), static_cast<int64_t>(Load64(src + l.byte[7])));
+            lo = _mm256_and_si256(_mm256_srlv_epi64(lo, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(l.shift))), mask);
+            hi = _mm256_and_si256(_mm256_srlv_epi64(hi, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(l.shift + 4))), mask);
+
+            // 4 + 4 values below 2^32 -> one row of 8 x uint32, then zigzag back and accumulate
+            const __m256i z = _mm256_permute2x128_si256(_mm256_permutevar8x32_epi32(lo, even),
+                                                        _mm256_permutevar8x32_epi32(hi, even), 0x20);
+            const __m256i d = _mm256_xor_si256(_mm256_srli_epi32(z, 1), _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_and_si256(z, one)));
+            acc = _mm256_add_epi32(acc, d);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(items[r + 1].channel), acc);
+            src += width;
+        }
+        return src;
+    }
+#endif
+}
+
+
+// ------------------------------------------------------------------ encode
+
+void CBlockCodec::Encode(const CBlockPacket& block, std::vector<uint8_t>& out)
+{
+    const uint32_t count = block.count, numEvents = block.numEvents;
+    const CDataPacket* items = block.blockData;
+
+    Writer w{ out };
+    w.Raw(CBlockPacket::packedStart);
+    BlockHeaderLayout::Append(out, block);
+    const size_t lengthAt = out.size();
+    w.Raw(uint32_t(0));                                   // body bytes, patched below
+    const size_t bodyAt = out.size();
+
+    EncodeTimes(w, count, [&](uint32_t i) { return items[i].timeStamp; });
+    EncodeTimes(w, count, [&](uint32_t i) { return items[i].stateTime; });
+
+    // hardwareState runs
+    uint32_t runs = 0;
+    for (uint32_t i = 0; i < count; ++i) runs += (i == 0 || items[i].hardwareState != items[i - 1].hardwareState);
+    w.Varint(runs);
+    for (uint32_t i = 0; i < count; ) {
+        uint32_t j = i + 1;
+        while (j < count && items[j].hardwareState == items[i].hardwareState) ++j;
+        w.Varint(j - i);
+        w.Raw(items[i].hardwareState);
+        i = j;
+    }
+
+    if (count > 0) {
+        w.Raw(items[0].sensorState);
+        for (uint32_t i = 1; i < count; ++i)
+            w.Varint(ZigZag(static_cast<int32_t>(items[i].sensorState - items[i - 1].sensorState)));
+
+        // Channel rows, each at the narrowest width that holds its 8 zigzag deltas
+        w.Raw(items[0].channel);
+        for (uint32_t i = 1; i < count; ++i) {
+            uint32_t z[CH], all = 0;
+            for (size_t k = 0; k < CH; ++k)
+                all |= z[k] = static_cast<uint32_t>(ZigZag(static_cast<int32_t>(items[i].channel[k] - items[i - 1].channel[k])));
+            unsigned width = 0;
+            while (width < 32 && (all >> width)) ++width;
+
+            out.push_back(static_cast<uint8_t>(width));
+            const size_t rowAt = out.size();
+            out.resize(rowAt + width + sizeof(uint64_t), 0);   // room for the last lane's whole word
+            const RowLayout& l = Layouts().width[width];
+            for (unsigned k = 0; k < CH; ++k) {
+                uint64_t word = Load64(out.data() + rowAt + l.byte[k]);
+                word |= static_cast<uint64_t>(z[k]) << l.shift[k];
+                std::memcpy(out.data() + rowAt + l.byte[k], &word, sizeof word);
+            }
+            out.resize(rowAt + width);
+        }
+        out.resize(out.size() + PADDING, 0);
+    }
+
+    for (uint32_t i = 0; i < numEvents; ++i)
+        BlockEventLayout::Append(out, block.eventData[i]);
+
+    const uint32_t bodyBytes = static_cast<uint32_t>(out.size() - bodyAt);
+    std::memcpy(out.data() + lengthAt, &bodyBytes, sizeof bodyBytes);
+    w.Raw(CBlockPacket::packedEnd);
+}
+
+size_t CBlockCodec::MaxBodySize(size_t count, size_t numEvents)
+{
+    // per sample: two 10-byte varints, a run of its own (varint + 8), a 5-byte varint, a 33-byte row
+    return 64 + count * (10 + 10 + 18 + 5 + 33) + PADDING + numEvents * BlockEventLayout::SIZE;
+}
+
+
+// ------------------------------------------------------------------ decode
+
+bool CBlockCodec::Decode(const uint8_t* body, size_t bodyBytes, uint32_t state, uint32_t count, uint32_t numEvents,
+                         CDataPacket* items, CEventPacket* events, bool allowSimd)
+{
+    Reader r{ body, body + bodyBytes };
+
+    DecodeTimes(r, count, [&](uint32_t i, double t) { items[i].timeStamp = t; });
+    DecodeTimes(r, count, [&](uint32_t i, double t) { items[i].stateTime = t; });
+
+    const uint64_t runs = r.Varint();
+    uint32_t filled = 0;
+    for (uint64_t n = 0; n < runs && r.ok; ++n) {
+        const uint64_t length = r.Varint();
+        const uint64_t value  = r.Raw<uint64_t>();
+        if (length == 0 || length > count - filled) return false;
+        for (uint64_t k = 0; k < length; ++k) items[filled++].hardwareState = value;
+    }
+    if (!r.ok || filled != count) return false;
+
+    if (count > 0) {
+        uint32_t sensor = r.Raw<uint32_t>();
+        items[0].sensorState = sensor;
+        for (uint32_t i = 1; i < count && r.ok; ++i) {
+            sensor += static_cast<uint32_t>(UnZigZag(r.Varint()));
+            items[i].sensorState = sensor;
+        }
+
+        for (size_t k = 0; k < CH; ++k) items[0].channel[k] = r.Raw<uint32_t>();
+        if (!r.ok) return false;
+
+        const uint8_t* rowsEnd;
+#ifdef CPU_X64
+        if (allowSimd && HasAvx2()) rowsEnd = UnpackRowsAvx2(r.p, r.end, count - 1, items);
+        else
+#endif
+            rowsEnd = UnpackRowsScalar(r.p, r.end, count - 1, items);
+        if (!rowsEnd || static_cast<size_t>(r.end - rowsEnd) < PADDING) return false;   // count 1 has no row to check it
+        r.p = rowsEnd + PADDING;
+    }
+
+    for (uint32_t i = 0; i < numEvents && r.ok; ++i)
+        r.Fields<BlockEventLayout>(events[i]);
+
+    if (!r.ok || r.p != r.end) return false;
+    for (uint32_t i = 0; i < count; ++i) items[i].state = state;
+    return true;
+}
+
+bool CBlockCodec::HasAvx2()
+{
+    return CCpuFeatures::HasAvx2();
+}
+
+#pragma managed(pop)
@@ -0,0 +1,43 @@
+#pragma once
+#pragma managed(push, off)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CPackets.h"
+#include "CWireLayout.h"
+
+// The packed Block frame (CBlockPacket::packedStart / packedEnd).  Same header as the plain frame plus the body
+// length, then a body that exploits how slowly the samples change:
+//
+//   sampleTime, stateTime   first value raw, then zigzag varint delta-of-delta of the double's bit pattern
+//                           (exact: smoothly increasing doubles have near-linear bit patterns)
+//   hardwareState           varint run count, then (varint run length, raw uint64) per run
+//   sensorState             zigzag varint deltas after a raw first value
+//   channels                first row raw, then each following row as a width byte and 8 zigzag deltas of
+//                           that many bits (so `width` bytes), then 8 bytes of padding
+//   events                  raw, as in the plain frame
+//
+// A channel row is unpacked 8 lanes at once with AVX2 when the CPU has it.
+class CBlockCodec
+{
+public:
+    static constexpr size_t HEADER_SIZE = BlockHeaderLayout::SIZE + sizeof(uint32_t);  // + body bytes
+    static constexpr size_t PADDING     = 8;   // after the channel rows, so unpacking may load whole words
+
+    // Appends the whole frame, magic to magic
+    static void Encode(const CBlockPacket& block, std::vector<uint8_t>& out);
+
+    // Largest body a frame of this many samples / events can have; a longer length field means a corrupt header
+    static size_t MaxBodySize(size_t count, size_t numEvents);
+
+    // Fills items / events (room for count / numEvents) from a body; false if it is malformed
+    static bool Decode(const uint8_t* body, size_t bodyBytes, uint32_t state, uint32_t count, uint32_t numEvents,
+                       CDataPacket* items, CEventPacket* events, bool allowSimd = true);
+
+    static bool HasAvx2();
+
+    static void DoTest();
+};
+
+#pragma managed(pop)
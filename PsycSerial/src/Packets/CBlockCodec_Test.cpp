@@ -0,0 +1,178 @@
+#include "CBlockCodec.h"
+#include "CDecoder.h"
+#include "CEncoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+constexpr uint32_t BLOCK  = 164;      // MAX_BLOCKSIZE
+constexpr size_t   BLOCKS = 2'000;
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// Firmware-like samples: 900 us reads with a little jitter, the head's hardware state changing a few times per
+// block, sensors and channels drifting with the odd jump.  random = every field random instead.
+static void MakeBlock(std::mt19937_64& rng, uint32_t index, bool random, std::vector<CDataPacket>& items,
+                      std::vector<CEventPacket>& events, CBlockPacket& block)
+{
+    std::uniform_int_distribution<int> jitter(-3, 3), drift(-200, 200), chance(0, 99);
+    items.resize(BLOCK);
+    events.resize(12);
+
+    static uint32_t channel[CDataPacket::A2D_NUM_CHANNELS]{}, sensor = 0x0100'0200;
+    static uint64_t hardware = 0x1234'5600'0000'0000ull;
+    for (uint32_t i = 0; i < BLOCK; ++i) {
+        CDataPacket& s = items[i];
+        const uint64_t n = uint64_t(index) * BLOCK + i;
+        s.state = 0x10;
+        if (random) {
+            const uint64_t a = rng(), b = rng();
+            std::memcpy(&s.timeStamp, &a, sizeof a);
+            std::memcpy(&s.stateTime, &b, sizeof b);
+            s.hardwareState = rng();
+            s.sensorState   = static_cast<uint32_t>(rng());
+            for (auto& c : s.channel) c = static_cast<uint32_t>(rng());
+            continue;
+        }
+        s.timeStamp = 86'400.0 + n * 900e-6 + jitter(rng) * 1e-6;
+        s.stateTime = (n % 3) * 900e-6 + jitter(rng) * 1e-6;
+        if (chance(rng) == 0) hardware += 0x0100'0000;
+        s.hardwareState = hardware;
+        if (chance(rng) < 10) sensor += drift(rng) / 50;
+        s.sensorState = sensor;
+        for (auto& c : channel) c += (chance(rng) == 0) ? static_cast<uint32_t>(rng()) : static_cast<uint32_t>(drift(rng));
+        std::memcpy(s.channel, channel, sizeof channel);
+    }
+    for (uint32_t i = 0; i < events.size(); ++i) events[i] = CEventPacket{ 0x11u + i % 3, i * 250e-6 };
+
+    block = CBlockPacket{};
+    block.state     = 0x10;
+    block.timeStamp = items[0].timeStamp;
+    block.count     = BLOCK;
+    block.numEvents = static_cast<uint32_t>(events.size());
+    block.blockData = items.data();
+    block.eventData = events.data();
+}
+
+// Feeds a stream through the decoder in 4 KB reads; returns seconds, counts samples
+static double DecodeStream(const std::vector<uint8_t>& stream, size_t& samples, uint64_t& checksum)
+{
+    CDecoder decoder;
+    auto* out = new CDecodedPacket;
+    CPacket packet;
+    packet.data.resize(4096);
+    samples = 0;
+
+    const double start = GetTime();
+    for (size_t pos = 0; pos < stream.size(); pos += packet.data.size()) {
+        packet.bytesRead = static_cast<uint32_t>(std::min(packet.data.size(), stream.size() - pos));
+        std::memcpy(packet.data.data(), stream.data() + pos, packet.bytesRead);
+        for (PacketKind kind; (kind = decoder.process(packet, *out)) != PacketKind::Unknown; packet.bytesRead = 0) {
+            if (kind != PacketKind::Block) continue;
+            samples  += out->block.count;
+            checksum += out->block.blockData[out->block.count - 1].channel[7];
+        }
+        packet.bytesRead = 0;
+    }
+    const double elapsed = GetTime() - start;
+    delete out;
+    return elapsed;
+}
+
+
+void CBlockCodec::DoTest()
+{
+    std::cout << "=== CBlockCodec test ===\n";
+    std::cout << "AVX2 available: " << (HasAvx2() ? "yes" : "no") << "\n";
+
+    std::mt19937_64 rng(5);
+    std::vector<CDataPacket>  items, decoded(BLOCK);
+    std::vector<CEventPacket> events, decodedEvents(64);
+    CBlockPacket block;
+
+    // Exact round trip, smooth and random data, SIMD and scalar unpacking
+    for (bool random : { false, true }) {
+        size_t bad = 0, bytes = 0;
+        for (uint32_t b = 0; b < 200; ++b) {
+            MakeBlock(rng, b, random, items, events, block);
+            std::vector<uint8_t> frame;
+            Encode(block, frame);
+            bytes += frame.size();
+
+            for (bool simd : { true, false }) {
+                std::fill(decoded.begin(), decoded.end(), CDataPacket{});
+                const bool ok = Decode(frame.data() + 4 + HEADER_SIZE, frame.size() - 8 - HEADER_SIZE, block.state, block.count,
+                                       block.numEvents, decoded.data(), decodedEvents.data(), simd);
+                bad += !ok || std::memcmp(decoded.data(), items.data(), BLOCK * sizeof(CDataPacket)) != 0
+                           || std::memcmp(decodedEvents.data(), events.data(), events.size() * sizeof(CEventPacket)) != 0;
+            }
+        }
+        std::cout << (random ? "Random data: " : "Firmware-like: ") << bad << " bad of 400 decodes, "
+                  << double(bytes) / (200 * BLOCK) << " B/sample on the wire (plain 60 + events)\n";
+    }
+
+    // Cut short or padded bodies are refused
+    MakeBlock(rng, 0, false, items, events, block);
+    std::vector<uint8_t> frame;
+    Encode(block, frame);
+    const uint8_t* body = frame.data() + 4 + HEADER_SIZE;
+    const size_t   size = frame.size() - 8 - HEADER_SIZE;
+    size_t refused = 0;
+    for (size_t cut : { size_t(1), size_t(8), size / 2, size - 1 })
+        refused += !Decode(body, size - cut, block.state, block.count, block.numEvents, decoded.data(), decodedEvents.data());
+    std::cout << "Truncated bodies refused: " << refused << " of 4\n";
+
+    // One sample has no channel rows: a body that stops where its padding should start is refused, not read past
+    {
+        CBlockPacket single = block;
+        single.count = 1;
+        std::vector<uint8_t> oneFrame;
+        Encode(single, oneFrame);
+        const size_t full = oneFrame.size() - 8 - HEADER_SIZE;
+        const std::vector<uint8_t> cutBody(oneFrame.begin() + 4 + HEADER_SIZE,
+                                           oneFrame.begin() + 4 + HEADER_SIZE + full - PADDING - single.numEvents * BlockEventLayout::SIZE);
+        const bool whole = Decode(oneFrame.data() + 4 + HEADER_SIZE, full, single.state, 1, single.numEvents, decoded.data(),
+                                  decodedEvents.data());
+        const bool cut = Decode(cutBody.data(), cutBody.size(), single.state, 1, single.numEvents, decoded.data(),
+                                decodedEvents.data());
+        std::cout << "Single sample: whole " << (whole ? "decoded" : "REFUSED") << ", without padding and events "
+                  << (cut ? "DECODED" : "refused") << "\n";
+    }
+
+    // Same samples through the decoder, plain against packed frames
+    std::vector<uint8_t> plain, packed;
+    for (uint32_t b = 0; b < BLOCKS; ++b) {
+        MakeBlock(rng, b, false, items, events, block);
+        CEncoder::encodeBlock(block, plain);   // the plain frame, as the firmware sends it today
+        Encode(block, packed);
+    }
+    size_t samplesPlain = 0, samplesPacked = 0;
+    uint64_t checksum = 0;
+    const double tPlain  = DecodeStream(plain , samplesPlain , checksum);
+    const double tPacked = DecodeStream(packed, samplesPacked, checksum);
+    std::cout << "Plain:  " << plain .size() / 1e6 << " MB, " << samplesPlain  << " samples, " << tPlain  / samplesPlain  * 1e9 << " ns/sample\n";
+    std::cout << "Packed: " << packed.size() / 1e6 << " MB, " << samplesPacked << " samples, " << tPacked / samplesPacked * 1e9 << " ns/sample"
+              << "  (" << double(plain.size()) / packed.size() << "x the samples per link byte)\n";
+
+    // Unpacking alone
+    std::vector<uint8_t> one;
+    Encode(block, one);
+    for (bool simd : { false, true }) {
+        const double start = GetTime();
+        for (size_t k = 0; k < BLOCKS; ++k)
+            Decode(one.data() + 4 + HEADER_SIZE, one.size() - 8 - HEADER_SIZE, block.state, block.count, block.numEvents,
+                   decoded.data(), decodedEvents.data(), simd);
+        const double t = GetTime() - start;
+        std::cout << "Decode " << (simd ? "AVX2:   " : "scalar: ") << t / (BLOCKS * BLOCK) * 1e9 << " ns/sample\n";
+    }
+    std::cout << "(checksum " << checksum << ")\n\n";
+}
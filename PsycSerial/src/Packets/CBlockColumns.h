@@ -0,0 +1,98 @@
+#pragma once
+#pragma managed(push, off)
+
+#include <type_traits>
+#include <vector>
+#include "CPackets.h"
+#include "CWireLayout.h"
+
+// A block's samples as columns, one contiguous array per field.  The wire layout is one packed CDataPacket per
+// sample; anything that sweeps a single field over the whole block (plot vertices, filters) reads this instead.
+// Load transposes every field of BlockItemLayout into the column Column<member>() names for it.
+struct CBlockColumns
+{
+    static constexpr size_t CHANNELS = CDataPacket::A2D_NUM_CHANNELS;
+
+    uint32_t state{};
+    double   timeStamp{};
+    uint32_t count{};
+    size_t   capacity{};
+
+    double*   sampleTime   {};   // per-sample timeStamp
+    double*   stateTime    {};
+    uint64_t* hardwareState{};
+    uint32_t* sensorState  {};
+    uint32_t* channel[CHANNELS]{};
+
+    CBlockColumns() = default;
+    CBlockColumns(const CBlockColumns&) = delete;
+    CBlockColumns& operator=(const CBlockColumns&) = delete;
+
+    // Room for n samples.  Only grows, so it allocates only when the negotiated block size goes up.
+    void Reserve(size_t n)
+    {
+        if (n <= capacity) return;
+
+        m_doubles.assign(2 * n, 0.0);
+        m_u64    .assign(n, 0);
+        m_u32    .assign((1 + CHANNELS) * n, 0);
+        capacity = n;
+        count    = 0;
+
+        sampleTime    = m_doubles.data();
+        stateTime     = m_doubles.data() + n;
+        hardwareState = m_u64.data();
+        sensorState   = m_u32.data();
+        for (size_t ch = 0; ch < CHANNELS; ++ch)
+            channel[ch] = m_u32.data() + (1 + ch) * n;
+    }
+
+    void Load(const CBlockPacket& block)
+    {
+        Reserve(block.count);
+
+        state     = block.state;
+        timeStamp = block.timeStamp;
+        count     = block.count;
+
+        const uint32_t n = count;   // a local: stores into the uint32_t columns could otherwise change count
+        for (uint32_t i = 0; i < n; ++i) {
+            const CDataPacket& row = block.blockData[i];
+            BlockItemLayout::ForEachField([&](auto field) { StoreField<decltype(field)::member>(row, i); });
+        }
+    }
+
+private:
+    template <auto Member>
+    auto Column() noexcept
+    {
+        using WireLayoutDetail::SameMember;
+        if constexpr      (SameMember<Member, &CDataPacket::timeStamp    >()) return sampleTime;
+        else if constexpr (SameMember<Member, &CDataPacket::stateTime    >()) return stateTime;
+        else if constexpr (SameMember<Member, &CDataPacket::hardwareState>()) return hardwareState;
+        else if constexpr (SameMember<Member, &CDataPacket::sensorState  >()) return sensorState;
+        else if constexpr (SameMember<Member, &CDataPacket::channel      >()) return channel;
+        else static_assert(SameMember<Member, Member>() && false, "no column for this field of BlockItemLayout");
+    }
+
+    template <auto Member>
+    void StoreField(const CDataPacket& row, uint32_t i) noexcept
+    {
+        using Value = typename WireLayoutDetail::MemberOf<decltype(Member)>::Value;
+        auto column = Column<Member>();
+
+        if constexpr (std::is_array_v<Value>) {
+            for (size_t k = 0; k < std::extent_v<Value>; ++k)
+                column[k][i] = (row.*Member)[k];
+        }
+        else {
+            column[i] = row.*Member;
+        }
+    }
+
+    std::vector<double>   m_doubles;   // sampleTime, stateTime
+    std::vector<uint64_t> m_u64;       // hardwareState
+    std::vector<uint32_t> m_u32;       // sensorState, channels
+};
+
+#pragma managed(pop)
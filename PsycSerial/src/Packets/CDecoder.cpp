@@ -1,9 +1,18 @@
 #define NOMINMAX
 #include "CDecoder.h"
+#include "CBlockCodec.h"
+#include "CWireLayout.h"
 #include <cstring>   // memcpy
 #include <algorithm> // min
 #include <exception>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>   // OutputDebugString
+#else
+static void OutputDebugString(const wchar_t*) {}
+#endif
+
 #pragma managed(push, off)
 
 #ifndef _DEBUG
@@ -15,35 +24,18 @@ namespace
 {
     constexpr size_t kFrameSize = sizeof(Frame);
 
-    constexpr size_t kBlockHeaderSize      = sizeof(uint32_t)                                  // block state
-                                           + sizeof(double)                                    // block timeStamp
-                                           + sizeof(uint32_t)                                  // block count
-                                           + sizeof(uint32_t);                                 // block numEvents
-
-    constexpr size_t kBlockStateOffset     =  0u;
-    constexpr size_t kBlockTimeStampOffset = sizeof(uint32_t);                  // after state
-    constexpr size_t kBlockCountOffset     = sizeof(uint32_t) + sizeof(double); // after state + timeStamp
-	constexpr size_t kBlockNumEvOffset     = kBlockCountOffset + sizeof(uint32_t); // after count
-
-	// this is the size of the incoming data for each block item.
-    // It does not include the state field, (as it's the same for the whole block).
-    constexpr size_t kBlockItemSize        = sizeof(double)                                    // timeStamp
-                                           + sizeof(double)                                    // stateTime
-                                           + sizeof(uint64_t)                                  // hardwareState
-                                           + sizeof(uint32_t)                                  // sensorState
-                                           + CDataPacket::A2D_NUM_CHANNELS * sizeof(uint32_t); // channel data
-
-    constexpr size_t kBlockEventSize       = sizeof(uint8_t)  // eventKind
-                                   		   + sizeof(double);   // eventTimeStamp
-
-    constexpr size_t kTelemetryPayloadSize = sizeof(double)   // timeStamp
-                                           + sizeof(uint8_t)  // group
-                                           + sizeof(uint8_t)  // subGroup
-                                           + sizeof(uint16_t) // id
-                                           + sizeof(float);   // value
+    // Payload sizes and field offsets come from the layouts in CWireLayout.h
 
 	constexpr uint8_t kFrameStart[2] = {0xB4, 0xFA}; // common start bytes of all framing
 
+    // The decoder's block storage, handed down to the block parser
+    struct BlockStorage {
+        CDataPacket*  items;
+        size_t        maxItems;
+        CEventPacket* events;
+        size_t        maxEvents;
+    };
+
     enum class FrameParseResult {
 		TooShortForHeader,  // not enough bytes to decide
         NoHeader,           // doesnt even start with kFrameStart
@@ -51,6 +43,8 @@ namespace
 		IncompletePacket,   // header + enough bytes, but not full packet yet
 		InvalidHeader,      // header present, but unknown type
 		InvalidFooter,      // ending frame invalid for frame type
+		Dropped,            // full framed packet we can't use (larger than the block storage, or a packed body
+		                    // that doesn't decode); usedBytes set to skip it
         ValidPacket         // full valid frame; out.kind set, usedBytes set
     };
 
@@ -66,16 +60,19 @@ namespace
     inline FrameParseResult readDouble(const uint8_t* payload, double  & out) noexcept;
 
     FrameParseResult readDataPayload (const uint8_t* payload, size_t payloadBytes, CDecodedPacket& out, size_t& consumed) noexcept;
-    FrameParseResult readBlockPayload(const uint8_t* payload, size_t payloadBytes, CDecodedPacket& out, size_t& consumed) noexcept;
+    FrameParseResult readBlockPayload(const uint8_t* payload, size_t payloadBytes, const BlockStorage& storage, CDecodedPacket& out, size_t& consumed) noexcept;
     FrameParseResult readTextPayload (const uint8_t* payload, size_t payloadBytes, CDecodedPacket& out, size_t& consumed) noexcept;
 	FrameParseResult readTelePayload (const uint8_t* payload, size_t payloadBytes, CDecodedPacket& out, size_t& consumed) noexcept;
 
 
 
-    FrameParseResult quickFrameCheck   (const uint8_t* buf, size_t len, CDecodedPacket& out, size_t& usedBytes) noexcept;
+    FrameParseResult quickFrameCheck   (const uint8_t* buf, size_t len, const BlockStorage& storage, CDecodedPacket& out, size_t& usedBytes) noexcept;
     FrameParseResult tryParseDataFrame (const uint8_t* buf, size_t len, CDecodedPacket& out, size_t& usedBytes) noexcept;
-    FrameParseResult tryParseBlockFrame(const uint8_t* buf, size_t len, CDecodedPacket& out, size_t& usedBytes) noexcept;
+    FrameParseResult tryParseBlockFrame(const uint8_t* buf, size_t len, const BlockStorage& storage, CDecodedPacket& out, size_t& usedBytes) noexcept;
+    FrameParseResult tryParsePackedFrame(const uint8_t* buf, size_t len, const BlockStorage& storage, CDecodedPacket& out, size_t& usedBytes) noexcept;
 	FrameParseResult tryParseTeleFrame (const uint8_t* buf, size_t len, CDecodedPacket& out, size_t& usedBytes) noexcept;
+    FrameParseResult tryParseTeleBatchFrame(const uint8_t* buf, size_t len, CDecodedPacket& out, size_t& usedBytes) noexcept;
+    FrameParseResult tryParseCommandFrame  (const uint8_t* buf, size_t len, CDecodedPacket& out, size_t& usedBytes) noexcept;
 
     static PacketKind classify(const uint8_t* buf, size_t n) noexcept;
 
@@ -89,28 +86,54 @@ PacketKind CDecoder::process(const CPacket& in, CDecodedPacket& out) noexcept
 
     out.kind = PacketKind::Unknown;
 
-    // 1) Append new data
+    // 1) Append new data.  Consumed bytes are only shifted out once there are enough of them (and they are at least
+    //    half the buffer), so a stream of small packets does not move the rest of the buffer every time.
     if (in.bytesRead > 0 && !in.data.empty()) {
+        if (m_head == m_buf.size()) {
+            m_buf.clear();
+            m_head = m_scan = m_sync = 0;
+        }
+        else if (m_head >= COMPACT_AT && m_head * 2 >= m_buf.size()) {
+            m_buf.erase(m_buf.begin(), m_buf.begin() + m_head);
+            m_scan = m_scan > m_head ? m_scan - m_head : 0;
+            m_sync = m_sync > m_head ? m_sync - m_head : 0;
+            m_head = 0;
+        }
+
         const size_t oldSize = m_buf.size();
         m_buf.resize(oldSize + in.bytesRead);
         std::memcpy(m_buf.data() + oldSize, in.data.data(), in.bytesRead);
+
+        m_reads[m_readCount++ % READ_MARKS] = ReadMark{ m_headOffset + size(), in.bytesRead, in.readNs, in.spanNs };
+        m_startNs = in.startNs;
     }
 
-    if (m_buf.empty())
+    if (size() == 0)
         return PacketKind::Unknown;
 
+    applyBlockCapacity();
+    const BlockStorage storage{ m_blockItems.data(), m_blockItems.size(), m_blockEvents.data(), m_blockEvents.size() };
+
     size_t usedBytes = 0;
 
     // 2) Check for complete frame at the start of the buffer
-	FrameParseResult res = quickFrameCheck(m_buf.data(), m_buf.size(), out, usedBytes);
+	FrameParseResult res = quickFrameCheck(data(), size(), storage, out, usedBytes);
 
     switch (res)
     {
         case FrameParseResult::ValidPacket:
-            m_buf.erase(m_buf.begin(), m_buf.begin() + usedBytes);
+            consume(usedBytes);
 			m_badHeaderAttempts = 0;
+            out.arrivalNs = arrivalAt(m_headOffset);
             return out.kind;
 
+        case FrameParseResult::Dropped:
+            // A well-framed block we can't use: skip all of it and carry on with the rest of the buffer
+            consume(usedBytes);
+			m_badHeaderAttempts = 0;
+            m_droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+            return process(CPacket{}, out);
+
         case FrameParseResult::IncompleteHeader:
         case FrameParseResult::IncompletePacket:
             return PacketKind::Unknown; // need more data
@@ -119,31 +142,37 @@ PacketKind CDecoder::process(const CPacket& in, CDecodedPacket& out) noexcept
 		case FrameParseResult::NoHeader:
 		case FrameParseResult::InvalidHeader:
         {
-            if (m_buf.size() < kFrameSize)
+            if (size() < kFrameSize)
 				return PacketKind::Unknown; // need more data
 
-            uint32_t test;	readU32(m_buf.data(), test);
-            if (test == CDataPacket::frameEnd || test == CBlockPacket::frameEnd || test == CTelemetryPacket::frameEnd)
+            uint32_t test;	readU32(data(), test);
+            if (test == CDataPacket::frameEnd || test == CBlockPacket::frameEnd || test == CBlockPacket::packedEnd || test == CTelemetryPacket::frameEnd
+                || test == CTelemetryPacket::batchEnd || test == CCommandPacket::frameEnd)
             {
                 // Found a frame end where we expected a start: drop it
-                m_buf.erase(m_buf.begin(), m_buf.begin() + kFrameSize);
+                consume(kFrameSize);
 				m_badHeaderAttempts = 0;
 				return PacketKind::Unknown;
             }
 
-            // 3) Try text line (newline-terminated)
-            auto itNL = std::find(m_buf.begin(), m_buf.end(), '\n');
-            if (itNL != m_buf.end()) {
-                size_t lineBytes = static_cast<size_t>((itNL - m_buf.begin()) + 1); // include '\n'
+            // 3) Try text line (newline-terminated), searching only bytes not already searched
+            const size_t from = std::max(m_scan, m_head);
+            const void*  nl   = std::memchr(m_buf.data() + from, '\n', m_buf.size() - from);
+            m_scan = nl ? static_cast<size_t>(static_cast<const uint8_t*>(nl) - m_buf.data()) : m_buf.size();
+
+            if (nl) {
+                size_t lineBytes = m_scan - m_head + 1; // include '\n'
 
                 size_t usedBytesText = 0;
-                readTextPayload(m_buf.data(), lineBytes, out, usedBytesText);
+                readTextPayload(data(), lineBytes, out, usedBytesText);
 
-                if (out.kind == PacketKind::Text && out.text.timeStamp == 0)
-                    out.text.timeStamp = static_cast<uint32_t>(in.timestamp);
+                parseFields(out.text);
 
-                m_buf.erase(m_buf.begin(), m_buf.begin() + usedBytesText);
+                consume(usedBytesText);
 				m_badHeaderAttempts = 0;
+                out.arrivalNs = arrivalAt(m_headOffset);
+                if (out.kind == PacketKind::Text && out.text.timeStamp == 0)
+                    out.text.timeStamp = static_cast<uint32_t>((out.arrivalNs - m_startNs) / 1'000'000);   // host ms since the read loop started, as before
                 return out.kind;
             }
 
@@ -157,42 +186,114 @@ PacketKind CDecoder::process(const CPacket& in, CDecodedPacket& out) noexcept
             break;
     }
     
-    if (m_badHeaderAttempts > MAX_BADHEADER_ATTEMPTS && !m_buf.empty()) {
-        m_buf.erase(m_buf.begin());  // drop 1 byte, not the whole header
+    if (m_badHeaderAttempts > MAX_BADHEADER_ATTEMPTS && size() > 0) {
+        consume(1);  // drop 1 byte, not the whole header
         m_badHeaderAttempts = 0;
         return PacketKind::Unknown;
     }
 
-    // 4) resynch on the header pattern further in the buffer
-    if (m_buf.size() >= sizeof(kFrameStart)) {
-        auto it = std::search(m_buf.begin() + 1, m_buf.end(),
-                              std::begin(kFrameStart), std::end(kFrameStart));
+    // 4) resynch on the header pattern further in the buffer, again skipping what was already searched
+    if (size() >= sizeof(kFrameStart)) {
+        const uint8_t* begin = data();
+        const uint8_t* end   = begin + size();
+        const uint8_t* from  = m_buf.data() + std::max(m_sync, m_head + 1);
+        const uint8_t* it    = std::search(from, end, std::begin(kFrameStart), std::end(kFrameStart));
 
-        if (it != m_buf.end()) {
+        if (it == end)
+            m_sync = m_buf.size() - (sizeof(kFrameStart) - 1);  // a header may still start in the last byte(s)
+
+        if (it != end) {
             // Drop junk before this candidate header
-            m_buf.erase(m_buf.begin(), it);
+            consume(static_cast<size_t>(it - begin));
 
             // Try again to parse a full frame at the start
-            if (quickFrameCheck(m_buf.data(), m_buf.size(), out, usedBytes) == FrameParseResult::ValidPacket) {
-                m_buf.erase(m_buf.begin(), m_buf.begin() + usedBytes);
+            res = quickFrameCheck(data(), size(), storage, out, usedBytes);
+            if (res == FrameParseResult::ValidPacket) {
+                consume(usedBytes);
+                out.arrivalNs = arrivalAt(m_headOffset);
                 return out.kind;
             }
+            if (res == FrameParseResult::Dropped) {
+                consume(usedBytes);
+                m_droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+            }
         }
-        else if (m_buf.size() > bloat_cutoff_size) {
+        else if (size() > bloat_cutoff_size) {
             // No header at all in a bloated buffer: keep only last kFrameStartSize-1 bytes
-            m_buf.erase(m_buf.begin(), m_buf.end() - (sizeof(kFrameStart) - 1));
+            consume(size() - (sizeof(kFrameStart) - 1));
         }
     }
 
     return PacketKind::Unknown;
 }
 
+void CDecoder::parseFields(CTextPacket& text) noexcept
+{
+    bool isFields = false;
+    try {
+        isFields = m_fields.Parse(text.utf8Bytes, text.length);
+    }
+    catch (const std::exception&) {}  // out of memory for the field arrays: pass the line on as plain text
+
+    text.fieldCount  = isFields ? static_cast<uint32_t>(m_fields.GetCount()) : 0;
+    text.fieldIds    = isFields ? m_fields.GetIds()    : nullptr;
+    text.fieldValues = isFields ? m_fields.GetValues() : nullptr;
+}
+
+void CDecoder::setBlockCapacity(size_t maxItems, size_t maxEvents) noexcept
+{
+    m_wantItems .store(static_cast<uint32_t>(std::min(maxItems , CBlockPacket::CAPACITY_LIMIT)), std::memory_order_relaxed);
+    m_wantEvents.store(static_cast<uint32_t>(std::min(maxEvents, CBlockPacket::CAPACITY_LIMIT)), std::memory_order_relaxed);
+}
+
+void CDecoder::applyBlockCapacity() noexcept
+{
+    const size_t items  = m_wantItems .load(std::memory_order_relaxed);
+    const size_t events = m_wantEvents.load(std::memory_order_relaxed);
+    if (items == m_blockItems.size() && events == m_blockEvents.size()) return;
+
+    try {
+        m_blockItems .resize(items);
+        m_blockEvents.resize(events);
+        m_blockItems .shrink_to_fit();
+        m_blockEvents.shrink_to_fit();
+    }
+    catch (const std::exception&) {  // out of memory: keep what fits, larger frames are dropped
+        m_wantItems .store(static_cast<uint32_t>(m_blockItems .size()), std::memory_order_relaxed);
+        m_wantEvents.store(static_cast<uint32_t>(m_blockEvents.size()), std::memory_order_relaxed);
+    }
+}
+
+void CDecoder::consume(size_t n) noexcept
+{
+    n = std::min(n, size());
+    m_head       += n;
+    m_headOffset += n;
+}
+
+int64_t CDecoder::arrivalAt(uint64_t offset) const noexcept
+{
+    // Bytes of a read are taken to have arrived evenly over its span, the last one at readNs
+    const size_t oldest = m_readCount > READ_MARKS ? m_readCount - READ_MARKS : 0;
+    for (size_t i = m_readCount; i-- > oldest; ) {
+        const ReadMark& r = m_reads[i % READ_MARKS];
+        if (offset > r.end - r.bytes || i == oldest) {
+            const uint64_t after = offset < r.end ? std::min<uint64_t>(r.end - offset, r.bytes) : 0;
+            return r.readNs - static_cast<int64_t>(static_cast<double>(r.spanNs) * after / r.bytes);
+        }
+    }
+    return 0;
+}
 
 
 void CDecoder::reset() noexcept
 {
     m_buf.clear();
+    m_head = m_scan = m_sync = 0;
 	m_badHeaderAttempts = 0;
+    m_headOffset = 0;
+    m_readCount  = 0;
+    m_startNs    = 0;
 }
 
 namespace
@@ -208,12 +309,15 @@ namespace
         {
             case      CDataPacket::frameStart: return PacketKind::Data;
             case     CBlockPacket::frameStart: return PacketKind::Block;
+            case     CBlockPacket::packedStart: return PacketKind::Block;
             case CTelemetryPacket::frameStart: return PacketKind::Telemetry;
+            case CTelemetryPacket::batchStart: return PacketKind::TelemetryBatch;
+            case   CCommandPacket::frameStart: return PacketKind::Command;
             default: return PacketKind::Unknown;
         }
     }
 
-    FrameParseResult quickFrameCheck(const uint8_t* buf, size_t len, CDecodedPacket& out, size_t& usedBytes) noexcept {
+    FrameParseResult quickFrameCheck(const uint8_t* buf, size_t len, const BlockStorage& storage, CDecodedPacket& out, size_t& usedBytes) noexcept {
         usedBytes = 0;
         out.kind = PacketKind::Unknown;
 
@@ -231,8 +335,10 @@ namespace
         switch (classify(buf, len))
         {
             case PacketKind::Data     : return tryParseDataFrame (buf, len, out, usedBytes);
-            case PacketKind::Block    : return tryParseBlockFrame(buf, len, out, usedBytes);
+            case PacketKind::Block    : return tryParseBlockFrame(buf, len, storage, out, usedBytes);
             case PacketKind::Telemetry: return tryParseTeleFrame (buf, len, out, usedBytes); 
+            case PacketKind::TelemetryBatch: return tryParseTeleBatchFrame(buf, len, out, usedBytes);
+            case PacketKind::Command  : return tryParseCommandFrame(buf, len, out, usedBytes);
             default                   : return FrameParseResult::InvalidHeader;
         }
     }
@@ -255,13 +361,13 @@ namespace
     {
         usedBytes = 0;
 
-        constexpr size_t need = kFrameSize + sizeof(CDataPacket) + kFrameSize;
+        constexpr size_t need = kFrameSize + DataLayout::SIZE + kFrameSize;
         if (n < need) return FrameParseResult::IncompletePacket;
 
         uint32_t start = 0; readU32(buf + 0, start);                                                    if (start != CDataPacket::frameStart) return FrameParseResult::InvalidHeader;
-        uint32_t end   = 0; readU32(buf + kFrameSize + sizeof(CDataPacket), end);                       if (end   != CDataPacket::frameEnd  ) return FrameParseResult::InvalidFooter;
+        uint32_t end   = 0; readU32(buf + kFrameSize + DataLayout::SIZE, end);                          if (end   != CDataPacket::frameEnd  ) return FrameParseResult::InvalidFooter;
 
-		FrameParseResult result = readDataPayload(buf + kFrameSize, sizeof(CDataPacket), out, usedBytes);
+		FrameParseResult result = readDataPayload(buf + kFrameSize, DataLayout::SIZE, out, usedBytes);
 
         if (result == FrameParseResult::ValidPacket)
             usedBytes = kFrameSize + usedBytes + kFrameSize;
@@ -269,40 +375,76 @@ namespace
         return result;
     }
 
-    FrameParseResult tryParseBlockFrame(const uint8_t* buf, size_t n, CDecodedPacket& out, size_t& usedBytes) noexcept
+    FrameParseResult tryParseBlockFrame(const uint8_t* buf, size_t n, const BlockStorage& storage, CDecodedPacket& out, size_t& usedBytes) noexcept
     {
         usedBytes = 0;
 
-        constexpr size_t minNeed = kFrameSize + kBlockHeaderSize + kFrameSize;                          if (n < minNeed) return FrameParseResult::IncompletePacket;
+        constexpr size_t minNeed = kFrameSize + BlockHeaderLayout::SIZE + kFrameSize;                   if (n < minNeed) return FrameParseResult::IncompletePacket;
 
-        uint32_t start = 0; readU32(buf + 0, start);                                                    if (start != CBlockPacket::frameStart) return FrameParseResult::InvalidHeader;
-        uint32_t count = 0; readU32(buf + kFrameSize + kBlockCountOffset, count);
-        uint32_t numEv = 0; readU32(buf + kFrameSize + kBlockNumEvOffset, numEv);
+        uint32_t start = 0; readU32(buf + 0, start);                                                    if (start == CBlockPacket::packedStart) return tryParsePackedFrame(buf, n, storage, out, usedBytes);
+                                                                                                        if (start != CBlockPacket::frameStart) return FrameParseResult::InvalidHeader;
+        CBlockPacket header{}; BlockHeaderLayout::Read(buf + kFrameSize, header);
 
-        const size_t data_bytes = static_cast<size_t>(count) * kBlockItemSize;
-        const size_t eventbytes = static_cast<size_t>(numEv) * kBlockEventSize;
+        const size_t data_bytes = static_cast<size_t>(header.count)     * BlockItemLayout::SIZE;
+        const size_t eventbytes = static_cast<size_t>(header.numEvents) * BlockEventLayout::SIZE;
 
-        const size_t payloadBytes = kBlockHeaderSize + data_bytes + eventbytes;
+        const size_t payloadBytes = BlockHeaderLayout::SIZE + data_bytes + eventbytes;
         const size_t need = kFrameSize + payloadBytes + kFrameSize;                                     if (n < need)  return FrameParseResult::IncompletePacket;
 
         uint32_t end = 0; readU32(buf + kFrameSize + payloadBytes, end);                                if (end != CBlockPacket::frameEnd) return FrameParseResult::InvalidFooter;
 
-        FrameParseResult result = readBlockPayload(buf + kFrameSize, payloadBytes, out, usedBytes);
+        FrameParseResult result = readBlockPayload(buf + kFrameSize, payloadBytes, storage, out, usedBytes);
 
-        if (result == FrameParseResult::ValidPacket)
+        if (result == FrameParseResult::ValidPacket || result == FrameParseResult::Dropped)
             usedBytes = kFrameSize + usedBytes + kFrameSize;
 
         return result;
     }
 
+    FrameParseResult tryParsePackedFrame(const uint8_t* buf, size_t n, const BlockStorage& storage, CDecodedPacket& out, size_t& usedBytes) noexcept
+    {
+        usedBytes = 0;
+
+        constexpr size_t minNeed = kFrameSize + CBlockCodec::HEADER_SIZE + kFrameSize;                 if (n < minNeed) return FrameParseResult::IncompletePacket;
+
+        const uint8_t* payload = buf + kFrameSize;
+        CBlockPacket header{}; BlockHeaderLayout::Read(payload, header);
+        uint32_t bytes = 0;    readU32(payload + BlockHeaderLayout::SIZE, bytes);   // packed frames: body length next
+        const uint32_t count = header.count, numEv = header.numEvents;
+
+        // A length no such block could need is a corrupt header; don't wait for it to arrive
+        if (bytes > CBlockCodec::MaxBodySize(count, numEv)) return FrameParseResult::InvalidFooter;
+
+        const size_t need = kFrameSize + CBlockCodec::HEADER_SIZE + bytes + kFrameSize;                if (n < need)  return FrameParseResult::IncompletePacket;
+        uint32_t end = 0; readU32(buf + need - kFrameSize, end);                                        if (end != CBlockPacket::packedEnd) return FrameParseResult::InvalidFooter;
+
+        usedBytes = need;
+        if (count > storage.maxItems || numEv > storage.maxEvents) {
+            if (_DEBUG) ::OutputDebugString(L"CDecoder: Block frame larger than the negotiated block size, dropped.\r\n");
+            return FrameParseResult::Dropped;
+        }
+
+        if (!CBlockCodec::Decode(payload + CBlockCodec::HEADER_SIZE, bytes, header.state, count, numEv, storage.items, storage.events)) {
+            if (_DEBUG) ::OutputDebugString(L"CDecoder: Packed Block frame does not decode, dropped.\r\n");
+            return FrameParseResult::Dropped;
+        }
+
+        CBlockPacket& bp = out.block;
+        bp           = header;
+        bp.blockData = storage.items;
+        bp.eventData = storage.events;
+        out.kind     = PacketKind::Block;
+        return FrameParseResult::ValidPacket;
+    }
+
     FrameParseResult tryParseTeleFrame(const uint8_t* buf, size_t n, CDecodedPacket& out, size_t& usedBytes) noexcept
     {
         usedBytes = 0;
-        constexpr size_t need = kFrameSize + kTelemetryPayloadSize + kFrameSize;                        if (n < need) return FrameParseResult::IncompletePacket;
+        constexpr size_t need = kFrameSize + TelemetryLayout::SIZE + kFrameSize;                        if (n < need) return FrameParseResult::IncompletePacket;
         uint32_t start = 0; readU32(buf + 0, start);                                                    if (start != CTelemetryPacket::frameStart) return FrameParseResult::InvalidHeader;
-		uint32_t end   = 0; readU32(buf + kFrameSize + kTelemetryPayloadSize, end);                     if (end != CTelemetryPacket::frameEnd) return FrameParseResult::InvalidFooter;
+		uint32_t end   = 0; readU32(buf + kFrameSize + TelemetryLayout::SIZE, end);                     if (end != CTelemetryPacket::frameEnd) return FrameParseResult::InvalidFooter;
 
-        FrameParseResult result = readTelePayload(buf + kFrameSize, kTelemetryPayloadSize, out, usedBytes);
+        FrameParseResult result = readTelePayload(buf + kFrameSize, TelemetryLayout::SIZE, out, usedBytes);
 
         if (result == FrameParseResult::ValidPacket)
             usedBytes = kFrameSize + usedBytes + kFrameSize;
@@ -310,12 +452,51 @@ namespace
         return result;
     }
 
+    FrameParseResult tryParseTeleBatchFrame(const uint8_t* buf, size_t n, CDecodedPacket& out, size_t& usedBytes) noexcept
+    {
+        usedBytes = 0;
+
+        constexpr size_t minNeed = kFrameSize + TelemetryBatchLayout::SIZE + kFrameSize;                if (n < minNeed) return FrameParseResult::IncompletePacket;
+
+        const uint8_t* payload = buf + kFrameSize;
+        CTelemetryBatch header{}; TelemetryBatchLayout::Read(payload, header);
+
+        // More entries than we offered is a corrupt header; don't wait for it to arrive
+        if (header.count > CTelemetryBatch::MAX_ENTRIES) return FrameParseResult::InvalidFooter;
+
+        const size_t need = kFrameSize + TelemetryBatchLayout::SIZE + header.count * TelemetryEntryLayout::SIZE + kFrameSize; if (n < need) return FrameParseResult::IncompletePacket;
+        uint32_t end = 0; readU32(buf + need - kFrameSize, end);                                        if (end != CTelemetryPacket::batchEnd) return FrameParseResult::InvalidFooter;
+
+        // The entries are read in place, like text lines
+        CTelemetryBatch& tb = out.telemetryBatch;
+        tb         = header;
+        tb.entries = reinterpret_cast<const CTelemetryEntry*>(payload + TelemetryBatchLayout::SIZE);
+        out.kind   = PacketKind::TelemetryBatch;
+
+        usedBytes = need;
+        return FrameParseResult::ValidPacket;
+    }
+
+    FrameParseResult tryParseCommandFrame(const uint8_t* buf, size_t n, CDecodedPacket& out, size_t& usedBytes) noexcept
+    {
+        usedBytes = 0;
+        constexpr size_t need = kFrameSize + CommandLayout::SIZE + kFrameSize;                          if (n < need) return FrameParseResult::IncompletePacket;
+        uint32_t start = 0; readU32(buf + 0, start);                                                    if (start != CCommandPacket::frameStart) return FrameParseResult::InvalidHeader;
+        uint32_t end   = 0; readU32(buf + kFrameSize + CommandLayout::SIZE, end);                       if (end != CCommandPacket::frameEnd) return FrameParseResult::InvalidFooter;
+
+        out.command = CCommandPacket{};
+        CommandLayout::Read(buf + kFrameSize, out.command);
+        out.kind  = PacketKind::Command;
+        usedBytes = need;
+        return FrameParseResult::ValidPacket;
+    }
+
     
     FrameParseResult readDataPayload(const uint8_t* payload, size_t payloadBytes, CDecodedPacket& out, size_t& consumed) noexcept
     {
-                                                                                                		if (payloadBytes < sizeof(CDataPacket)) return FrameParseResult::IncompletePacket;
-    	consumed = sizeof(CDataPacket);
-		CDataPacket dp{}; memcpy(&dp, payload, consumed);
+                                                                                                		if (payloadBytes < DataLayout::SIZE) return FrameParseResult::IncompletePacket;
+    	consumed = DataLayout::SIZE;
+		CDataPacket dp{}; DataLayout::Read(payload, dp);
         
         out.data = dp;
         out.kind = PacketKind::Data;
@@ -325,43 +506,40 @@ namespace
 	double lastTimeStamp = 0;
 
 
-    FrameParseResult readBlockPayload(const uint8_t* payload, size_t payloadBytes, CDecodedPacket& out, size_t& consumed) noexcept
+    FrameParseResult readBlockPayload(const uint8_t* payload, size_t payloadBytes, const BlockStorage& storage, CDecodedPacket& out, size_t& consumed) noexcept
     {
-                                                                                                        if (payloadBytes < kBlockHeaderSize) return FrameParseResult::IncompleteHeader;
-        uint32_t state = 0; readU32   (payload + kBlockStateOffset,     state);
-        double   ts    = 0; readDouble(payload + kBlockTimeStampOffset, ts   );
-		uint32_t count = 0; readU32   (payload + kBlockCountOffset,     count);                         if (count > CBlockPacket::MAX_BLOCK_SIZE       && _DEBUG) ::OutputDebugString(L"CDecoder: Block count exceeds maximum allowed size.");
-   		uint32_t numEv = 0; readU32   (payload + kBlockNumEvOffset,     numEv);                         if (numEv > CBlockPacket::MAX_EVENTS_PER_BLOCK && _DEBUG) ::OutputDebugString(L"CDecoder: Event count exceeds maximum allowed size.");
-
-        const size_t itemsBytes = static_cast<size_t>(count) * kBlockItemSize;
-        const size_t eventbytes = static_cast<size_t>(numEv) * kBlockEventSize;
-        const size_t need = kBlockHeaderSize + itemsBytes + eventbytes;
+                                                                                                        if (payloadBytes < BlockHeaderLayout::SIZE) return FrameParseResult::IncompleteHeader;
+        CBlockPacket header{}; BlockHeaderLayout::Read(payload, header);
+        const uint32_t state = header.state, count = header.count, numEv = header.numEvents;
+
+        const size_t itemsBytes = static_cast<size_t>(count) * BlockItemLayout::SIZE;
+        const size_t eventbytes = static_cast<size_t>(numEv) * BlockEventLayout::SIZE;
+        const size_t need = BlockHeaderLayout::SIZE + itemsBytes + eventbytes;
         
         if (payloadBytes < need) return FrameParseResult::IncompletePacket;
 
+        if (count > storage.maxItems || numEv > storage.maxEvents) {
+            if (_DEBUG) ::OutputDebugString(L"CDecoder: Block frame larger than the negotiated block size, dropped.\r\n");
+            consumed = need;
+            return FrameParseResult::Dropped;
+        }
+
 		CBlockPacket& bp = out.block;
 
-        bp.state     = state;
-        bp.timeStamp = ts;
-        bp.count     = count;
-		bp.numEvents = numEv;
+        bp           = header;
+        bp.blockData = storage.items;
+        bp.eventData = storage.events;
 
         // Copy the packed Data items
-        const uint8_t* rP = payload + kBlockHeaderSize;
+        const uint8_t* rP = payload + BlockHeaderLayout::SIZE;
 
 //        uint32_t lastValue;
-        for (uint32_t i = 0; i < count; ++i)
+        for (uint32_t i = 0; i < count; ++i, rP += BlockItemLayout::SIZE)
         {
             CDataPacket& dp = bp.blockData[i];
             dp.state = state; // shared block state
 
-			readDouble(rP, dp.timeStamp    ); rP += sizeof(double  );
-            readDouble(rP, dp.stateTime    ); rP += sizeof(double  );
-            readU64   (rP, dp.hardwareState); rP += sizeof(uint64_t);
-            readU32   (rP, dp.sensorState  ); rP += sizeof(uint32_t);
-
-            for (size_t ch = 0; ch < CDataPacket::A2D_NUM_CHANNELS; ++ch, rP += sizeof(uint32_t))
-                readU32(rP, dp.channel[ch]);
+            BlockItemLayout::Read(rP, dp);
         }
 
         for (uint32_t i = 0; i < count; ++i)
@@ -374,17 +552,8 @@ namespace
         }
 
 
-        for (uint32_t i = 0; i < numEv; ++i)
-        {
-            CEventPacket& ep = bp.eventData[i];
-
-			uint8_t eventKind;
-
-            readU8    (rP,    eventKind ); rP += sizeof(uint8_t);
-            readDouble(rP, ep.stateTime ); rP += sizeof(double);
-
-			ep.eventKind = static_cast<uint32_t>(eventKind);
-        }
+        for (uint32_t i = 0; i < numEv; ++i, rP += BlockEventLayout::SIZE)
+            BlockEventLayout::Read(rP, bp.eventData[i]);
 
 
 
@@ -400,15 +569,14 @@ namespace
 
     FrameParseResult readTextPayload(const uint8_t* payload, size_t payloadBytes, CDecodedPacket& out, size_t& consumed) noexcept
     {
-        CTextPacket tp{};
-        size_t len = std::min(payloadBytes, CTextPacket::MAX_TEXT_SIZE - 1u);
+        // A view into the decoder's buffer, not a copy
+        const size_t len = std::min(payloadBytes, CTextPacket::MAX_TEXT_SIZE);
 
-        memcpy_s(tp.utf8Bytes, CTextPacket::MAX_TEXT_SIZE, payload, len);
-        tp.utf8Bytes[len] = '\0';
-        tp.length = static_cast<uint32_t>(len-1);  // ignore terminator
+        out.text = CTextPacket{};
+        out.text.utf8Bytes = payload;
+        out.text.length    = static_cast<uint32_t>(len - (len > 0 && payload[len - 1] == '\n'));  // ignore terminator
 
         consumed = len;
-        out.text = tp;
         out.kind = PacketKind::Text;
 
         return FrameParseResult::ValidPacket;
@@ -416,18 +584,12 @@ namespace
 
 	FrameParseResult readTelePayload(const uint8_t* payload, size_t payloadBytes, CDecodedPacket& out, size_t& consumed) noexcept
     {
-                                                                                                        if (payloadBytes < kTelemetryPayloadSize) return FrameParseResult::IncompletePacket;
+                                                                                                        if (payloadBytes < TelemetryLayout::SIZE) return FrameParseResult::IncompletePacket;
         CTelemetryPacket tp{};
-        size_t offset = 0, storedOffset = 0;
-		readDouble(payload + offset, tp.timeStamp); offset += sizeof(double); storedOffset = offset;
-        readU8    (payload + offset, tp.group    ); offset += sizeof(uint8_t);
-		readU8    (payload + offset, tp.subGroup ); offset += sizeof(uint8_t);
-        readU16   (payload + offset, tp.id       ); offset += sizeof(uint16_t);
-        readFloat (payload + offset, tp.value    ); offset += sizeof(float);
-
-		readU32(payload + storedOffset, tp.key); // includes group, subGroup, id, not value
+        TelemetryLayout::Read(payload, tp);
+        tp.key = TelemetryKey(tp.group, tp.subGroup, tp.id);   // not value
 
-        consumed = offset;
+        consumed = TelemetryLayout::SIZE;
         out.telemetry = tp;
         out.kind = PacketKind::Telemetry;
         return FrameParseResult::ValidPacket;
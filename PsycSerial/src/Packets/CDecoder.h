@@ -1,10 +1,12 @@
 #pragma once
 #pragma managed(push, off)
 
+#include <atomic>
 #include <cstdint>
 #include <cstddef>
 #include <vector>
 #include "CPackets.h"
+#include "CTextFieldParser.h"
 
 class CDecoder
 {
@@ -15,8 +17,47 @@ public:
 
     void reset() noexcept;
 
+    // Most samples / events a block frame may carry, as negotiated in the handshake; clamped to
+    // CBlockPacket::CAPACITY_LIMIT.  Safe from any thread: the storage is resized by the next process() call, so
+    // frames are never decoded into storage that is being replaced.  Larger frames, and packed frames that do not
+    // decode, are dropped and counted.
+    void     setBlockCapacity(size_t maxItems, size_t maxEvents) noexcept;
+    size_t   blockCapacity() const noexcept { return m_wantItems.load(std::memory_order_relaxed); }
+    uint64_t droppedBlocks() const noexcept { return m_droppedBlocks.load(std::memory_order_relaxed); }
+
+    static void DoTest();
+
 private:
+    static constexpr size_t COMPACT_AT = 4096;  // consumed bytes before the buffer is shifted down
+
     std::vector<uint8_t> m_buf;
+    size_t m_head = 0;   // start of the unconsumed bytes in m_buf
+    size_t m_scan = 0;   // no '\n' in [m_head, m_scan): the newline search resumes here
+    size_t m_sync = 0;   // no frame start begins in (m_head, m_sync): the resynch search resumes here
+
+    // Recent reads, for the arrival time of a frame's last byte.  Offsets count bytes since reset(); a frame that
+    // ends before the oldest read kept gets that read's start.
+    struct ReadMark { uint64_t end; uint32_t bytes; int64_t readNs, spanNs; };
+    static constexpr size_t READ_MARKS = 4;
+    ReadMark m_reads[READ_MARKS]{};
+    size_t   m_readCount = 0;      // reads since reset(); the last one is m_reads[(m_readCount - 1) % READ_MARKS]
+    uint64_t m_headOffset = 0;     // stream offset of m_head
+    int64_t  m_startNs = 0;        // CPacket::startNs of the latest read
+
+    CTextFieldParser m_fields;
+
+    std::vector<CDataPacket>  m_blockItems;    // what CBlockPacket::blockData / eventData point into
+    std::vector<CEventPacket> m_blockEvents;
+    std::atomic<uint32_t>     m_wantItems { static_cast<uint32_t>(CBlockPacket::MAX_BLOCK_SIZE) };
+    std::atomic<uint32_t>     m_wantEvents{ static_cast<uint32_t>(CBlockPacket::MAX_EVENTS_PER_BLOCK) };
+    std::atomic<uint64_t>     m_droppedBlocks{};
+
+    const uint8_t* data() const noexcept { return m_buf.data() + m_head; }
+    size_t         size() const noexcept { return m_buf.size() - m_head; }
+    void           consume(size_t n) noexcept;
+    int64_t        arrivalAt(uint64_t offset) const noexcept;
+    void           parseFields(CTextPacket& text) noexcept;
+    void           applyBlockCapacity() noexcept;
 
 	static constexpr int MAX_BADHEADER_ATTEMPTS = 3;
 	int m_badHeaderAttempts = 0;   
@@ -0,0 +1,375 @@
+#include "CDecoder.h"
+#include "CEncoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+constexpr size_t LINES = 200'000;
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// Firmware debug logging: printable lines of mixed length, with a telemetry frame after every tenth line
+static std::vector<uint8_t> MakeStream(std::vector<std::string>& lines, size_t& frames, size_t minLen, size_t maxLen, size_t count)
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<size_t> length(minLen, maxLen);
+    std::uniform_int_distribution<int>    chars(' ', '~');
+
+    std::vector<uint8_t> stream;
+    lines.clear();
+    frames = 0;
+    for (size_t i = 0; i < count; ++i) {
+        std::string line(length(rng), ' ');
+        for (char& c : line) c = static_cast<char>(chars(rng));
+        stream.insert(stream.end(), line.begin(), line.end());
+        stream.push_back('\n');
+        lines.push_back(std::move(line));
+
+        if (i % 10 == 9) {
+            CEncoder::encodeTelemetry(CTelemetryPacket{ i * 1e-3, 0x11, 1, 2, 1.5f }, stream);
+            ++frames;
+        }
+    }
+    return stream;
+}
+
+// A burst of keys telemetry values sampled at time: one frame per key, or one batched frame
+static void AppendTelemetry(std::vector<uint8_t>& v, bool batched, double time, uint32_t keys, uint32_t count = 0)
+{
+    std::vector<CTelemetryEntry> entries(keys);
+    for (uint32_t k = 0; k < keys; ++k) {
+        entries[k] = CTelemetryEntry{ 0x11 | (k << 8) | ((0x100 + k) << 16), float(time * k) };
+        if (!batched)
+            CEncoder::encodeTelemetry(CTelemetryPacket{ time, 0x11, uint8_t(k), uint16_t(0x100 + k), entries[k].value }, v);
+    }
+    if (!batched) return;
+
+    const size_t at = v.size();
+    CEncoder::encodeTelemetryBatch(CTelemetryBatch{ time, keys, entries.data() }, v);
+    if (count) std::memcpy(v.data() + at + sizeof(Frame) + sizeof(double), &count, sizeof count);   // a corrupt header
+}
+
+// Telemetry values out of a stream, from either frame kind; bad counts values that don't match AppendTelemetry
+static double DecodeTelemetry(const std::vector<uint8_t>& stream, size_t chunk, size_t& packets, size_t& values, size_t& bad)
+{
+    CDecoder decoder;
+    auto* out = new CDecodedPacket;
+    CPacket packet;
+    packet.data.resize(chunk);
+    packets = values = bad = 0;
+
+    auto check = [&](double time, uint32_t key, float value) {
+        const uint32_t k = (key >> 8) & 0xFF;
+        bad += (key & 0xFF) != 0x11 || (key >> 16) != 0x100 + k || value != float(time * k);
+        ++values;
+    };
+
+    const double start = GetTime();
+    for (size_t pos = 0; pos < stream.size(); pos += packet.data.size()) {
+        packet.bytesRead = static_cast<uint32_t>(std::min(packet.data.size(), stream.size() - pos));
+        std::memcpy(packet.data.data(), stream.data() + pos, packet.bytesRead);
+        for (PacketKind kind; (kind = decoder.process(packet, *out)) != PacketKind::Unknown; packet.bytesRead = 0) {
+            ++packets;
+            if (kind == PacketKind::Telemetry)
+                check(out->telemetry.timeStamp, out->telemetry.key, out->telemetry.value);
+            else if (kind == PacketKind::TelemetryBatch)
+                for (uint32_t i = 0; i < out->telemetryBatch.count; ++i)
+                    check(out->telemetryBatch.timeStamp, out->telemetryBatch.entries[i].key, out->telemetryBatch.entries[i].value);
+        }
+        packet.bytesRead = 0;
+    }
+    const double elapsed = GetTime() - start;
+    delete out;
+    return elapsed;
+}
+
+// A block frame as the firmware sends it: header, packed samples without their state, then the events
+static void AppendBlock(std::vector<uint8_t>& v, uint32_t state, uint32_t count, uint32_t numEvents, uint32_t seed)
+{
+    static std::vector<CDataPacket>  items;
+    static std::vector<CEventPacket> events;
+    items .resize(count);
+    events.resize(numEvents);
+    for (uint32_t i = 0; i < count; ++i) {
+        CDataPacket& s = items[i];
+        s.timeStamp     = seed + i * 1e-5;
+        s.stateTime     = i * 1e-5;
+        s.hardwareState = uint64_t(seed) << 32 | i;
+        s.sensorState   = seed ^ i;
+        for (uint32_t ch = 0; ch < CDataPacket::A2D_NUM_CHANNELS; ++ch) s.channel[ch] = seed + i * 8 + ch;
+    }
+    for (uint32_t i = 0; i < numEvents; ++i) events[i] = CEventPacket{ 0x11 + i % 3, i * 1e-4 };
+
+    CEncoder::encodeBlock(CBlockPacket{ state, seed * 1e-3, count, numEvents, items.data(), events.data() }, v);
+}
+
+static bool CheckBlock(const CBlockPacket& b, uint32_t seed)
+{
+    for (uint32_t i = 0; i < b.count; ++i) {
+        const CDataPacket& s = b.blockData[i];
+        if (s.state != b.state || s.hardwareState != (uint64_t(seed) << 32 | i) || s.sensorState != (seed ^ i)) return false;
+        for (uint32_t ch = 0; ch < CDataPacket::A2D_NUM_CHANNELS; ++ch)
+            if (s.channel[ch] != seed + i * 8 + ch) return false;
+    }
+    for (uint32_t i = 0; i < b.numEvents; ++i)
+        if (b.eventData[i].eventKind != 0x11 + i % 3 || b.eventData[i].stateTime != i * 1e-4) return false;
+    return true;
+}
+
+// Feeds stream to decoder in reads of chunk bytes; counts blocks, samples and (if verify) blocks whose contents are wrong
+static double DecodeBlocks(CDecoder& decoder, const std::vector<uint8_t>& stream, size_t chunk, bool verify,
+                           size_t& blocks, size_t& samples, size_t& bad, size_t& lines)
+{
+    auto* out = new CDecodedPacket;
+    CPacket packet;
+    packet.data.resize(chunk);
+    blocks = samples = bad = lines = 0;
+
+    const double start = GetTime();
+    for (size_t pos = 0; pos < stream.size(); pos += chunk) {
+        packet.bytesRead = static_cast<uint32_t>(std::min(chunk, stream.size() - pos));
+        std::memcpy(packet.data.data(), stream.data() + pos, packet.bytesRead);
+
+        for (PacketKind kind; (kind = decoder.process(packet, *out)) != PacketKind::Unknown; packet.bytesRead = 0) {
+            if (kind == PacketKind::Text) { ++lines; continue; }
+            if (kind != PacketKind::Block) continue;
+            ++blocks;
+            samples += out->block.count;
+            if (verify) bad += !CheckBlock(out->block, static_cast<uint32_t>(out->block.timeStamp * 1e3 + 0.5));
+        }
+        packet.bytesRead = 0;
+    }
+    const double elapsed = GetTime() - start;
+    delete out;
+    return elapsed;
+}
+
+// Feeds stream in reads of chunk bytes, as CSerial does; counts lines that do not match and telemetry frames
+static double Decode(const std::vector<uint8_t>& stream, size_t chunk, const std::vector<std::string>& lines,
+                     size_t& badLines, size_t& frames)
+{
+    CDecoder decoder;
+    auto* out = new CDecodedPacket;
+    CPacket packet;
+    packet.data.resize(chunk);
+    size_t line = 0;
+    badLines = frames = 0;
+
+    const double start = GetTime();
+    for (size_t pos = 0; pos < stream.size(); pos += chunk) {
+        packet.bytesRead = static_cast<uint32_t>(std::min(chunk, stream.size() - pos));
+        std::memcpy(packet.data.data(), stream.data() + pos, packet.bytesRead);
+
+        for (PacketKind kind; (kind = decoder.process(packet, *out)) != PacketKind::Unknown; packet.bytesRead = 0) {
+            if (kind == PacketKind::Telemetry) { ++frames; continue; }
+            if (kind != PacketKind::Text) continue;
+            static const std::string none;
+            const std::string& expect = line < lines.size() ? lines[line] : none;
+            badLines += (out->text.length != expect.size() || std::memcmp(out->text.utf8Bytes, expect.data(), expect.size()) != 0);
+            ++line;
+        }
+        packet.bytesRead = 0;
+    }
+    const double elapsed = GetTime() - start;
+
+    badLines += lines.size() - std::min(line, lines.size());
+    delete out;
+    return elapsed;
+}
+
+// The previous text path: a zeroed 4 KB packet per line, the line copied in, the struct copied out, the buffer
+// shifted down and searched from the start on every call.  Text only.
+static double DecodeLegacy(const std::vector<uint8_t>& stream, size_t chunk, size_t& lines)
+{
+    struct LegacyText { uint32_t timeStamp; uint32_t length; uint8_t utf8Bytes[CTextPacket::MAX_TEXT_SIZE]; };
+    auto* out = new LegacyText;
+    std::vector<uint8_t> buf;
+    lines = 0;
+
+    const double start = GetTime();
+    for (size_t pos = 0; pos < stream.size(); pos += chunk) {
+        const size_t n = std::min(chunk, stream.size() - pos);
+        buf.insert(buf.end(), stream.begin() + pos, stream.begin() + pos + n);
+        for (;;) {
+            auto nl = std::find(buf.begin(), buf.end(), '\n');
+            if (nl == buf.end()) break;
+            const size_t len = std::min<size_t>(nl - buf.begin() + 1, CTextPacket::MAX_TEXT_SIZE - 1);
+            LegacyText tp{};
+            std::memcpy(tp.utf8Bytes, buf.data(), len);
+            tp.utf8Bytes[len] = '\0';
+            tp.length = static_cast<uint32_t>(len - 1);
+            std::memcpy(out, &tp, sizeof tp);
+            buf.erase(buf.begin(), buf.begin() + len);
+            lines += (out->length != 0xFFFF'FFFF);
+        }
+    }
+    const double elapsed = GetTime() - start;
+    delete out;
+    return elapsed;
+}
+
+
+void CDecoder::DoTest()
+{
+    std::cout << "=== CDecoder test ===\n";
+
+    std::vector<std::string> lines;
+    size_t frames = 0, badLines = 0, gotFrames = 0;
+
+    // Mixed text and telemetry, through USB-sized and tiny reads
+    std::vector<uint8_t> stream = MakeStream(lines, frames, 20, 160, LINES);
+    for (size_t chunk : { 1, 7, 64, 512, 4096 }) {
+        const double t = Decode(stream, chunk, lines, badLines, gotFrames);
+        std::cout << "Reads of " << chunk << " B: bad lines " << badLines << ", telemetry " << gotFrames << " of "
+                  << frames << ", " << t * 1e3 << " ms\n";
+    }
+
+    // Text only: decoder against the previous copy-per-line path
+    auto textOnly = [](size_t minLen, size_t maxLen, size_t count, std::vector<std::string>& l) {
+        std::vector<uint8_t> s;
+        std::mt19937 rng(9);
+        std::uniform_int_distribution<size_t> length(minLen, maxLen);
+        l.clear();
+        for (size_t i = 0; i < count; ++i) {
+            std::string line(length(rng), 'x');
+            s.insert(s.end(), line.begin(), line.end());
+            s.push_back('\n');
+            l.push_back(std::move(line));
+        }
+        return s;
+    };
+
+    struct Case { const char* name; size_t minLen, maxLen, count, chunk; };
+    for (const Case& c : { Case{ "debug log, 512 B reads  ", 20,  160,  LINES, 512 },
+                           Case{ "long lines, 16 B reads  ", 2000, 4000, 2'000, 16  } }) {
+        stream = textOnly(c.minLen, c.maxLen, c.count, lines);
+        size_t legacyLines = 0;
+        const double tNew = Decode(stream, c.chunk, lines, badLines, gotFrames);
+        const double tOld = DecodeLegacy(stream, c.chunk, legacyLines);
+        std::cout << c.name << stream.size() / 1e6 << " MB: " << tNew * 1e3 << " ms (bad " << badLines << "), previous "
+                  << tOld * 1e3 << " ms (" << legacyLines << " lines)\n";
+    }
+
+    // Block storage follows the handshake: frames past it are dropped whole, the stream carries on behind them
+    std::vector<uint8_t> blocks;
+    for (uint32_t seed : { 1, 2, 3, 4 }) {
+        AppendBlock(blocks, 0x1, seed == 2 ? 400 : 100, seed == 4 ? 600 : 20, seed);
+        const char line[] = "between blocks\n";
+        blocks.insert(blocks.end(), line, line + sizeof line - 1);
+    }
+    for (size_t capacity : { size_t(CBlockPacket::MAX_BLOCK_SIZE), size_t(1024) }) {
+        CDecoder decoder;
+        decoder.setBlockCapacity(capacity, capacity);
+        size_t gotBlocks = 0, samples = 0, bad = 0, gotLines = 0;
+        DecodeBlocks(decoder, blocks, 64, true, gotBlocks, samples, bad, gotLines);
+        std::cout << "Capacity " << capacity << ": blocks " << gotBlocks << " of 4 (bad " << bad << "), dropped "
+                  << decoder.droppedBlocks() << ", lines " << gotLines << " of 4\n";
+    }
+
+    // Telemetry bursts of 40 keys, a frame per key against one batched frame
+    constexpr uint32_t BURSTS = 20'000, KEYS = 40;
+    for (bool batched : { false, true }) {
+        stream.clear();
+        for (uint32_t b = 0; b < BURSTS; ++b) AppendTelemetry(stream, batched, b * 1e-3, KEYS);
+        size_t packets = 0, values = 0, bad = 0;
+        const double t = DecodeTelemetry(stream, 4096, packets, values, bad);
+        std::cout << (batched ? "Batched telemetry: " : "Single telemetry:  ") << stream.size() / 1e6 << " MB, " << packets
+                  << " packets, " << values << " of " << BURSTS * KEYS << " values (bad " << bad << "), "
+                  << t / values * 1e9 << " ns/value\n";
+    }
+
+    // A batch claiming more entries than offered is not waited for; the stream resyncs on the next frame
+    stream.clear();
+    AppendTelemetry(stream, true, 1.0, 4, 1'000'000);
+    AppendTelemetry(stream, true, 2.0, 4);
+    AppendTelemetry(stream, false, 3.0, 4);
+    size_t packets = 0, values = 0, bad = 0;
+    DecodeTelemetry(stream, 16, packets, values, bad);
+    std::cout << "Corrupt batch header: " << values << " of 8 good values after it (bad " << bad << ")\n";
+
+    // Per-sample cost against block size, the same number of samples each time, USB-sized reads
+    constexpr size_t SAMPLES = 400'000;
+    for (uint32_t size : { 16, 64, 164, 512, 2048, 8192 }) {
+        stream.clear();
+        for (uint32_t seed = 1; seed * size <= SAMPLES; ++seed) AppendBlock(stream, 0x1, size, 8, seed);
+
+        CDecoder decoder;
+        decoder.setBlockCapacity(size, 512);
+        size_t gotBlocks = 0, samples = 0, bad = 0, gotLines = 0, unchecked = 0;
+        DecodeBlocks(decoder, stream, 4096, true, gotBlocks, samples, bad, gotLines);
+        const double t = DecodeBlocks(decoder, stream, 4096, false, gotBlocks, samples, unchecked, gotLines);
+        std::cout << "Blocks of " << size << ": " << gotBlocks << " frames, " << t / samples * 1e9 << " ns/sample, "
+                  << t / gotBlocks * 1e9 << " ns/frame (bad " << bad << ")\n";
+    }
+
+    // Arrival times: frames of one read spread over its span, in order; a frame split over two reads arrives with
+    // the second.  Read 1 (t 1000..2000) holds lines 0-3 and half of line 4, read 2 (7 ms on) the rest of it.
+    // Text time stamps are host ms since the read loop started, a day into the host clock here.
+    {
+        std::vector<uint8_t> lines;
+        for (int i = 0; i < 6; ++i) { const char l[] = "line\n"; lines.insert(lines.end(), l, l + 5); }
+        CDecoder decoder;
+        auto* out = new CDecodedPacket;
+        CPacket packet;
+        std::vector<int64_t> arrivals;
+        std::vector<uint32_t> stamps;
+        const size_t split = 22;
+        const int64_t startNs = 86'400'000'000'000, readNs[2] = { 2000, 7'006'000 };
+        for (int r = 0; r < 2; ++r) {
+            packet.data.assign(lines.begin() + (r ? split : 0), r ? lines.end() : lines.begin() + split);
+            packet.bytesRead = static_cast<uint32_t>(packet.data.size());
+            packet.readNs    = startNs + readNs[r];
+            packet.spanNs    = 1000;
+            packet.startNs   = startNs;
+            for (; decoder.process(packet, *out) != PacketKind::Unknown; packet.bytesRead = 0) {
+                arrivals.push_back(out->arrivalNs - startNs);
+                stamps.push_back(out->text.timeStamp);
+            }
+        }
+        delete out;
+        std::cout << "Arrival ns:";
+        for (int64_t a : arrivals) std::cout << ' ' << a;
+        std::cout << (std::is_sorted(arrivals.begin(), arrivals.end()) && arrivals.size() == 6 && arrivals[3] <= 2000
+                      && arrivals[4] > 7'005'000 && arrivals[5] == 7'006'000 ? " (ok)\n" : " (WRONG)\n");
+        std::cout << "Text ms since start:";
+        for (uint32_t t : stamps) std::cout << ' ' << t;
+        std::cout << (stamps.size() == 6 && stamps[3] == 0 && stamps[4] == 7 && stamps[5] == 7 ? " (ok)\n" : " (WRONG)\n");
+    }
+
+    // Two ports in one process, as the soak harness runs them: each read thread decodes its own stream with its own
+    // decoder and capacity.  The host's blocks fit; the other port's do not, and only it counts them dropped.
+    {
+        std::vector<uint8_t> hostStream, otherStream;
+        for (uint32_t seed = 1; seed <= 2'000; ++seed) {
+            AppendBlock(hostStream, 0x1, 164, 8, seed);
+            AppendBlock(otherStream, 0x2, 164, 8, seed);
+            const char line[] = "cmd ok\n";
+            otherStream.insert(otherStream.end(), line, line + 7);
+        }
+        CDecoder host, other;
+        host .setBlockCapacity(164, 64);
+        other.setBlockCapacity(64, 64);
+        size_t hostBlocks = 0, hostSamples = 0, hostBad = 0, hostLines = 0;
+        size_t otherBlocks = 0, otherSamples = 0, otherBad = 0, otherLines = 0;
+        std::thread reader([&] { DecodeBlocks(other, otherStream, 512, true, otherBlocks, otherSamples, otherBad, otherLines); });
+        DecodeBlocks(host, hostStream, 4096, true, hostBlocks, hostSamples, hostBad, hostLines);
+        reader.join();
+        std::cout << "Two decoders at once: host " << hostBlocks << " blocks (bad " << hostBad << "), " << hostLines
+                  << " lines, dropped " << host.droppedBlocks() << "; other " << otherBlocks << " blocks, " << otherLines
+                  << " lines, dropped " << other.droppedBlocks()
+                  << (hostBlocks == 2'000 && hostBad == 0 && hostLines == 0 && host.droppedBlocks() == 0 && otherBlocks == 0
+                      && otherLines == 2'000 && other.droppedBlocks() == 2'000 ? " (ok)\n" : " (WRONG)\n");
+    }
+    std::cout << "\n";
+}
@@ -0,0 +1,91 @@
+#include "CEncoder.h"
+#pragma managed(push, off)
+
+#include <cstring>
+#include "CBlockCodec.h"
+#include "CWireLayout.h"
+
+
+namespace
+{
+    inline void AppendFrame(std::vector<uint8_t>& out, Frame frame)
+    {
+        const size_t at = out.size();
+        out.resize(at + sizeof frame);
+        std::memcpy(out.data() + at, &frame, sizeof frame);
+    }
+}
+
+
+bool CEncoder::encode(const CDecodedPacket& packet, std::vector<uint8_t>& out, BlockFormat blocks)
+{
+    switch (packet.kind)
+    {
+        case PacketKind::Data          : encodeData          (packet.data,           out);         return true;
+        case PacketKind::Block         : encodeBlock         (packet.block,          out, blocks); return true;
+        case PacketKind::Telemetry     : encodeTelemetry     (packet.telemetry,      out);         return true;
+        case PacketKind::TelemetryBatch: encodeTelemetryBatch(packet.telemetryBatch, out);         return true;
+        case PacketKind::Text          : encodeText          (packet.text.utf8Bytes, packet.text.length, out); return true;
+        case PacketKind::Command       : encodeCommand       (packet.command,        out);         return true;
+        default                        : return false;
+    }
+}
+
+void CEncoder::encodeData(const CDataPacket& packet, std::vector<uint8_t>& out)
+{
+    AppendFrame(out, CDataPacket::frameStart);
+    DataLayout::Append(out, packet);
+    AppendFrame(out, CDataPacket::frameEnd);
+}
+
+void CEncoder::encodeBlock(const CBlockPacket& packet, std::vector<uint8_t>& out, BlockFormat format)
+{
+    if (format == BlockFormat::Packed) {
+        CBlockCodec::Encode(packet, out);
+        return;
+    }
+
+    const size_t at = out.size();
+    out.resize(at + sizeof(Frame) + BlockHeaderLayout::SIZE + packet.count * BlockItemLayout::SIZE
+                  + packet.numEvents * BlockEventLayout::SIZE + sizeof(Frame));
+
+    uint8_t* p = out.data() + at;
+    std::memcpy(p, &CBlockPacket::frameStart, sizeof(Frame));  p += sizeof(Frame);
+    BlockHeaderLayout::Write(p, packet);                         p += BlockHeaderLayout::SIZE;
+    for (uint32_t i = 0; i < packet.count; ++i, p += BlockItemLayout::SIZE)
+        BlockItemLayout::Write(p, packet.blockData[i]);
+    for (uint32_t i = 0; i < packet.numEvents; ++i, p += BlockEventLayout::SIZE)
+        BlockEventLayout::Write(p, packet.eventData[i]);
+    std::memcpy(p, &CBlockPacket::frameEnd, sizeof(Frame));
+}
+
+void CEncoder::encodeTelemetry(const CTelemetryPacket& packet, std::vector<uint8_t>& out)
+{
+    AppendFrame(out, CTelemetryPacket::frameStart);
+    TelemetryLayout::Append(out, packet);
+    AppendFrame(out, CTelemetryPacket::frameEnd);
+}
+
+void CEncoder::encodeTelemetryBatch(const CTelemetryBatch& batch, std::vector<uint8_t>& out)
+{
+    AppendFrame(out, CTelemetryPacket::batchStart);
+    TelemetryBatchLayout::Append(out, batch);
+    for (uint32_t i = 0; i < batch.count; ++i)
+        TelemetryEntryLayout::Append(out, batch.entries[i]);
+    AppendFrame(out, CTelemetryPacket::batchEnd);
+}
+
+void CEncoder::encodeText(const uint8_t* utf8, size_t length, std::vector<uint8_t>& out)
+{
+    if (length) out.insert(out.end(), utf8, utf8 + length);
+    out.push_back('\n');
+}
+
+void CEncoder::encodeCommand(const CCommandPacket& command, std::vector<uint8_t>& out)
+{
+    AppendFrame(out, CCommandPacket::frameStart);
+    CommandLayout::Append(out, command);
+    AppendFrame(out, CCommandPacket::frameEnd);
+}
+
+#pragma managed(pop)
@@ -0,0 +1,30 @@
+#pragma once
+#pragma managed(push, off)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CPackets.h"
+
+// The other direction of CDecoder: appends each frame exactly as the decoder reads it, payloads written through
+// the layouts in CWireLayout.h.  The host uses it for Command frames; tests and tools use it to build device
+// streams.
+class CEncoder
+{
+public:
+    enum class BlockFormat { Plain, Packed };
+
+    // Appends packet as its frame, a Text packet as its line and '\n'; false for Unknown
+    static bool encode(const CDecodedPacket& packet, std::vector<uint8_t>& out, BlockFormat blocks = BlockFormat::Plain);
+
+    static void encodeData          (const CDataPacket&      packet, std::vector<uint8_t>& out);
+    static void encodeBlock         (const CBlockPacket&     packet, std::vector<uint8_t>& out, BlockFormat format = BlockFormat::Plain);
+    static void encodeTelemetry     (const CTelemetryPacket& packet, std::vector<uint8_t>& out);   // group, subGroup, id; key is not sent
+    static void encodeTelemetryBatch(const CTelemetryBatch&  batch , std::vector<uint8_t>& out);
+    static void encodeText          (const uint8_t* utf8, size_t length, std::vector<uint8_t>& out);
+    static void encodeCommand       (const CCommandPacket&   command, std::vector<uint8_t>& out);
+
+    static void DoTest();
+};
+
+#pragma managed(pop)
@@ -0,0 +1,181 @@
+#include "CEncoder.h"
+#include "CDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+template <typename T>
+static void Append(std::vector<uint8_t>& v, const T& x)
+{
+    const auto* p = reinterpret_cast<const uint8_t*>(&x);
+    v.insert(v.end(), p, p + sizeof x);
+}
+
+static void MakeSamples(std::mt19937& rng, uint32_t count, std::vector<CDataPacket>& items, std::vector<CEventPacket>& events)
+{
+    std::uniform_int_distribution<uint32_t> u32;
+    items.resize(count);
+    events.resize(count / 16);
+    for (uint32_t i = 0; i < count; ++i) {
+        CDataPacket& s = items[i];
+        s.state         = 0x10;
+        s.timeStamp     = 100.0 + i * 900e-6;
+        s.stateTime     = (i % 3) * 900e-6;
+        s.hardwareState = uint64_t(u32(rng) & 0xFF) << 40;
+        s.sensorState   = u32(rng) & 0xFFF;
+        for (auto& c : s.channel) c = 0x8000'0000u + (u32(rng) & 0xFFFF);
+    }
+    for (uint32_t i = 0; i < events.size(); ++i) events[i] = CEventPacket{ 0x11u + i % 3, i * 250e-6 };
+}
+
+
+void CEncoder::DoTest()
+{
+    std::cout << "=== CEncoder test ===\n";
+
+    // Each frame against the bytes written out field by field
+    size_t wrong = 0;
+    {
+        std::vector<uint8_t> got, want;
+
+        CDecodedPacket tele{};
+        tele.kind = PacketKind::Telemetry;
+        tele.telemetry = CTelemetryPacket{ 1.25, 0x11, 2, 0x103, 4.5f };
+        encode(tele, got);
+        Append(want, CTelemetryPacket::frameStart); Append(want, 1.25); Append(want, uint8_t(0x11)); Append(want, uint8_t(2));
+        Append(want, uint16_t(0x103)); Append(want, 4.5f); Append(want, CTelemetryPacket::frameEnd);
+        wrong += got != want;
+
+        got.clear(); want.clear();
+        const CTelemetryEntry entries[] = { { 0x0001'0011, 1.0f }, { 0x0002'0011, -2.0f } };
+        encodeTelemetryBatch(CTelemetryBatch{ 2.5, 2, entries }, got);
+        Append(want, CTelemetryPacket::batchStart); Append(want, 2.5); Append(want, uint32_t(2));
+        for (const CTelemetryEntry& e : entries) { Append(want, e.key); Append(want, e.value); }
+        Append(want, CTelemetryPacket::batchEnd);
+        wrong += got != want;
+
+        got.clear(); want.clear();
+        encodeCommand(CCommandPacket{ 7, CCommandPacket::Set, 12, 440.0 }, got);
+        Append(want, CCommandPacket::frameStart); Append(want, uint32_t(7)); Append(want, uint16_t(CCommandPacket::Set));
+        Append(want, uint16_t(12)); Append(want, 440.0); Append(want, CCommandPacket::frameEnd);
+        wrong += got != want;
+
+        got.clear(); want.clear();
+        std::mt19937 rng(3);
+        std::vector<CDataPacket>  items;
+        std::vector<CEventPacket> events;
+        MakeSamples(rng, 5, items, events);
+        events = { CEventPacket{ 0x12, 0.5 } };
+        encodeBlock(CBlockPacket{ 0x10, 100.0, 5, 1, items.data(), events.data() }, got);
+        Append(want, CBlockPacket::frameStart); Append(want, uint32_t(0x10)); Append(want, 100.0); Append(want, uint32_t(5)); Append(want, uint32_t(1));
+        for (const CDataPacket& s : items) {
+            Append(want, s.timeStamp); Append(want, s.stateTime); Append(want, s.hardwareState); Append(want, s.sensorState);
+            Append(want, s.channel);
+        }
+        Append(want, uint8_t(0x12)); Append(want, 0.5); Append(want, CBlockPacket::frameEnd);
+        wrong += got != want;
+    }
+    std::cout << "Frames differing from the field-by-field bytes: " << wrong << " of 4\n";
+
+    // A mixed stream, decoded and encoded again, must come back byte for byte whatever the read size
+    std::mt19937 rng(11);
+    std::vector<uint8_t> stream;
+    std::vector<BlockFormat> formats;
+    std::vector<CDataPacket>  items;
+    std::vector<CEventPacket> events;
+    std::vector<CTelemetryEntry> entries(24);
+    size_t frames = 0;
+    for (uint32_t i = 0; i < 2'000; ++i, ++frames) {
+        CDecodedPacket p{};
+        switch (i % 7) {
+            case 0: {
+                MakeSamples(rng, 1, items, events);
+                p.kind = PacketKind::Data;
+                p.data = items[0];
+                break;
+            }
+            case 1:
+            case 2: {
+                MakeSamples(rng, 20 + i % 100, items, events);
+                p.kind  = PacketKind::Block;
+                p.block = CBlockPacket{ 0x10, items[0].timeStamp, uint32_t(items.size()), uint32_t(events.size()), items.data(), events.data() };
+                formats.push_back(i % 7 == 1 ? BlockFormat::Plain : BlockFormat::Packed);
+                break;
+            }
+            case 3: {
+                p.kind      = PacketKind::Telemetry;
+                p.telemetry = CTelemetryPacket{ i * 1e-3, 0x13, uint8_t(i), uint16_t(i), float(i) };
+                break;
+            }
+            case 4: {
+                for (uint32_t k = 0; k < entries.size(); ++k) entries[k] = CTelemetryEntry{ 0x14u | (k << 8), float(i + k) };
+                p.kind           = PacketKind::TelemetryBatch;
+                p.telemetryBatch = CTelemetryBatch{ i * 1e-3, uint32_t(entries.size()), entries.data() };
+                break;
+            }
+            case 5: {
+                static std::string line;
+                line = "Line " + std::to_string(i) + "\tA2D:" + std::to_string(i * 3);
+                p.kind = PacketKind::Text;
+                p.text.utf8Bytes = reinterpret_cast<const uint8_t*>(line.data());
+                p.text.length    = static_cast<uint32_t>(line.size());
+                break;
+            }
+            default: {
+                p.kind    = PacketKind::Command;
+                p.command = CCommandPacket{ i, CCommandPacket::Get, uint16_t(i % 40), 0.0 };
+                break;
+            }
+        }
+        encode(p, stream, p.kind == PacketKind::Block ? formats.back() : BlockFormat::Plain);
+    }
+
+    for (size_t chunk : { size_t(1), size_t(7), size_t(64), size_t(4096) }) {
+        CDecoder decoder;
+        decoder.setBlockCapacity(256, 64);
+        auto* out = new CDecodedPacket;
+        CPacket packet;
+        packet.data.resize(chunk);
+        std::vector<uint8_t> again;
+        size_t decoded = 0, block = 0;
+        for (size_t pos = 0; pos < stream.size(); pos += chunk) {
+            packet.bytesRead = static_cast<uint32_t>(std::min(chunk, stream.size() - pos));
+            std::memcpy(packet.data.data(), stream.data() + pos, packet.bytesRead);
+            for (PacketKind kind; (kind = decoder.process(packet, *out)) != PacketKind::Unknown; packet.bytesRead = 0) {
+                encode(*out, again, kind == PacketKind::Block ? formats[block++] : BlockFormat::Plain);
+                ++decoded;
+            }
+        }
+        delete out;
+        std::cout << "Reads of " << chunk << " B: " << decoded << " of " << frames << " frames, stream "
+                  << (again == stream ? "identical" : "DIFFERENT") << "\n";
+    }
+
+    // Encoding cost
+    MakeSamples(rng, 164, items, events);
+    const CBlockPacket block{ 0x10, items[0].timeStamp, 164, uint32_t(events.size()), items.data(), events.data() };
+    std::vector<uint8_t> out;
+    out.reserve(16 * 1024);
+    const size_t N = 20'000;
+    double start = GetTime();
+    for (size_t i = 0; i < N; ++i) { out.clear(); encodeBlock(block, out); }
+    const double tBlock = GetTime() - start;
+
+    start = GetTime();
+    for (size_t i = 0; i < N * 100; ++i) { out.clear(); encodeCommand(CCommandPacket{ uint32_t(i), CCommandPacket::Set, 3, double(i) }, out); }
+    const double tCommand = GetTime() - start;
+    std::cout << "Block of 164: " << tBlock / N * 1e9 << " ns, command: " << tCommand / (N * 100) * 1e9 << " ns\n";
+    std::cout << "\n";
+}
@@ -1,8 +1,6 @@
 #pragma once
 #pragma managed(push, off)
 
-#define WIN32_LEAN_AND_MEAN
-#include <Windows.h>
 #include <cstdint>
 #include <cstddef>
 #include <type_traits>
@@ -12,8 +10,11 @@ using Frame = uint32_t;
 
 // ----------------------------- Native carrier --------------------------------
 struct CPacket {
-    double                timestamp{};  // arrival time (optional)
-    std::vector<BYTE>     data{};       // raw bytes from device
+    int64_t               readNs{};     // CHostClock time the read completed: arrival of the last byte
+    int64_t               spanNs{};     // estimated time from the first byte to the last, 0 if unknown
+    uint64_t              readTicks{};  // CTrace::Ticks() at the same moment, when tracing
+    int64_t               startNs{};    // CHostClock time the read loop started: text lines count host ms from it
+    std::vector<uint8_t>  data{};       // raw bytes from device
     uint32_t              bytesRead{};  // valid byte count in data
 
     inline bool isEmpty() const { return bytesRead == 0; }
@@ -45,36 +46,30 @@ struct CEventPacket
     double   stateTime{};
 };
 
-struct CBlockPacket
-{
-    static constexpr size_t MAX_BLOCK_SIZE = 164;
-	static constexpr size_t MAX_EVENTS_PER_BLOCK = 512;
-
-	static constexpr Frame frameStart = 0xED'B1'FA'B4;  // B1/B2 = Block Packet
-    static constexpr Frame frameEnd   = 0xED'B2'FA'B4;
-
-    uint32_t state{};
-    double   timeStamp{};
-    uint32_t count{}; // number of valid entries in blockData
-    CDataPacket   blockData[MAX_BLOCK_SIZE]{};
-
-	uint32_t numEvents{}; // number of valid entries in eventData
-	CEventPacket  eventData[MAX_EVENTS_PER_BLOCK]{};
-};
-
+// One text line, without its '\n'.  utf8Bytes points into the decoder's buffer and is only valid until the next
+// CDecoder::process() call; it is not null-terminated.  Longer lines are cut at MAX_TEXT_SIZE, the rest
+// follows as another line.  Lines of tab-separated "name:value" fields also come parsed (see CTextFieldParser):
+// fieldIds / fieldValues are then set, with the same lifetime, and are null for any other line.
 struct CTextPacket
 {
     static constexpr size_t MAX_TEXT_SIZE = 4096;
 
 	uint32_t timeStamp{};
 	uint32_t length{}; // number of valid bytes in text
-    uint8_t  utf8Bytes[MAX_TEXT_SIZE]{};
+    const uint8_t* utf8Bytes{};
+
+    uint32_t        fieldCount{};
+    const uint32_t* fieldIds{};
+    const double*   fieldValues{};
 };
 
 struct CTelemetryPacket
 {
 	static constexpr Frame frameStart = 0xED'71'FA'B4;  // 71/72 = Telemetry Packet
     static constexpr Frame frameEnd   = 0xED'72'FA'B4;
+
+	static constexpr Frame batchStart = 0xED'73'FA'B4;  // 73/74 = batched Telemetry, see CTelemetryBatch
+    static constexpr Frame batchEnd   = 0xED'74'FA'B4;
   
     double   timeStamp{};
 	uint8_t  group{};
@@ -85,31 +80,91 @@ struct CTelemetryPacket
     uint32_t key{};
 };
 
+// One (key, value) pair of a batched telemetry frame, exactly as on the wire; key as CTelemetryPacket::key
+struct CTelemetryEntry
+{
+    uint32_t key{};
+    float    value{};
+};
+
+// A command from the host: set or read one device parameter, or ping.  The device answers with a Command frame
+// carrying the same requestId and the parameter's value after the command.  parameter ids are the firmware's.
+struct CCommandPacket
+{
+	static constexpr Frame frameStart = 0xED'E1'FA'B4;  // E1/E2 = Command Packet
+    static constexpr Frame frameEnd   = 0xED'E2'FA'B4;
+
+    enum Code : uint16_t { Ping = 0, Get = 1, Set = 2 };
+
+    uint32_t requestId{};
+    uint16_t code{};
+    uint16_t parameter{};
+    double   value{};
+};
+
 #pragma pack(pop)
 
+// Telemetry for many keys sampled at the same time: one frame of count (key, value) entries instead of count
+// Telemetry frames.  entries points into the decoder's buffer and is only valid until the next CDecoder::process()
+// call.  The host offers MAX_ENTRIES in the handshake (TELEMETRY_BATCH); a frame claiming more is corrupt.
+struct CTelemetryBatch
+{
+    static constexpr size_t MAX_ENTRIES = 1024;
+
+    double                 timeStamp{};
+    uint32_t               count{};
+    const CTelemetryEntry* entries{};
+};
+
+// A block of samples and the events that went with them.  blockData / eventData point into storage owned by the
+// decoder, sized from the device handshake (CDecoder::setBlockCapacity), and are only valid until the next
+// CDecoder::process() call.  Frames with more entries than that are dropped whole.
+struct CBlockPacket
+{
+    static constexpr size_t MAX_BLOCK_SIZE       = 164;      // capacities until the handshake says otherwise
+	static constexpr size_t MAX_EVENTS_PER_BLOCK = 512;
+    static constexpr size_t CAPACITY_LIMIT       = 65'536;   // most entries of either kind a handshake may ask for
+
+	static constexpr Frame frameStart = 0xED'B1'FA'B4;  // B1/B2 = Block Packet
+    static constexpr Frame frameEnd   = 0xED'B2'FA'B4;
+
+	static constexpr Frame packedStart = 0xED'B3'FA'B4; // B3/B4 = packed Block Packet, see CBlockCodec
+    static constexpr Frame packedEnd   = 0xED'B4'FA'B4;
+
+    uint32_t state{};
+    double   timeStamp{};
+    uint32_t count{};     // number of valid entries in blockData
+	uint32_t numEvents{}; // number of valid entries in eventData
+
+    CDataPacket*  blockData{};
+	CEventPacket* eventData{};
+};
+
 // Sizes & sanity checks (same endianness is assumed by design)
 static_assert(std::is_trivially_copyable_v<CDataPacket> , "CDataPacket must be POD");
 static_assert(std::is_trivially_copyable_v<CBlockPacket>, "CBlockPacket must be POD");
+static_assert(sizeof(CTelemetryEntry) == sizeof(uint32_t) + sizeof(float), "Unexpected CTelemetryEntry layout/packing");
 
 static_assert(sizeof(CDataPacket) ==
     sizeof(uint32_t) + sizeof(double) + sizeof(double) + sizeof(uint64_t) + sizeof(uint32_t) + CDataPacket::A2D_NUM_CHANNELS * sizeof(uint32_t),
     "Unexpected CDataPacket layout/packing");
 
-static_assert(offsetof(CBlockPacket, blockData) ==
-	sizeof(uint32_t) + sizeof(double) + sizeof(uint32_t),
-    "Unexpected CBlockPacket header layout");
 
 // ----------------------------- Tagged result ---------------------------------
-enum class PacketKind : uint8_t { Unknown = 0, Data = 1, Block = 2, Telemetry = 3, Text = 4 };
+enum class PacketKind : uint8_t { Unknown = 0, Data = 1, Block = 2, Telemetry = 3, Text = 4, TelemetryBatch = 5, Command = 6 };
 
 struct CDecodedPacket
 {
     PacketKind kind{ PacketKind::Unknown };
+    int64_t    arrivalNs{};   // CHostClock time the frame's last byte arrived, interpolated within its read
+    uint32_t   traceId{};     // CTrace id while tracing, else 0
     union {
         CDataPacket      data;
         CBlockPacket     block;
         CTextPacket      text;
 		CTelemetryPacket telemetry;
+        CTelemetryBatch  telemetryBatch;
+        CCommandPacket   command;
     };
 
     CDecodedPacket() noexcept {} // POD; union members are zero-inited by caller when used
@@ -0,0 +1,145 @@
+#include "CTextFieldParser.h"
+#pragma managed(push, off)
+
+#include <charconv>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+
+namespace
+{
+    struct SharedNames {
+        std::mutex                                mutex;
+        std::vector<std::string>                  names;
+        std::unordered_map<std::string, uint32_t> ids;
+    };
+
+    SharedNames& Shared()
+    {
+        static SharedNames s;
+        return s;
+    }
+
+    // The white space double.TryParse skips: tab, LF, VT, FF, CR and space
+    inline bool IsSpace(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+}
+
+
+uint64_t CTextFieldParser::Hash(std::string_view name)
+{
+    uint64_t h = 0xCBF2'9CE4'8422'2325ull;   // FNV-1a
+    for (char c : name) { h ^= static_cast<uint8_t>(c); h *= 0x100'0000'01B3ull; }
+    return h;
+}
+
+uint32_t CTextFieldParser::InternShared(std::string_view name)
+{
+    SharedNames& s = Shared();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto [it, added] = s.ids.try_emplace(std::string(name), static_cast<uint32_t>(s.names.size()));
+    if (added) s.names.emplace_back(name);
+    return it->second;
+}
+
+bool CTextFieldParser::GetName(uint32_t id, std::string& name)
+{
+    SharedNames& s = Shared();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    if (id >= s.names.size()) return false;
+    name = s.names[id];
+    return true;
+}
+
+size_t CTextFieldParser::GetNameCount()
+{
+    SharedNames& s = Shared();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.names.size();
+}
+
+void CTextFieldParser::GrowCache()
+{
+    std::vector<Slot> old = std::move(m_cache);
+    m_cache.assign(old.empty() ? 64 : old.size() * 2, Slot{});
+
+    const size_t mask = m_cache.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.id == UINT32_MAX) continue;
+        size_t i = slot.hash & mask;
+        while (m_cache[i].id != UINT32_MAX) i = (i + 1) & mask;
+        m_cache[i] = slot;
+    }
+}
+
+uint32_t CTextFieldParser::Intern(std::string_view name)
+{
+    if (m_cached * 2 >= m_cache.size()) GrowCache();
+
+    const uint64_t hash = Hash(name);
+    const size_t   mask = m_cache.size() - 1;
+    size_t i = hash & mask;
+
+    for (;; i = (i + 1) & mask) {
+        const Slot& slot = m_cache[i];
+        if (slot.id == UINT32_MAX) break;
+        if (slot.hash == hash && std::string_view(m_names).substr(slot.nameOffset, slot.nameLength) == name)
+            return slot.id;
+    }
+
+    // First sighting by this parser
+    const uint32_t id = InternShared(name);
+    m_cache[i] = Slot{ hash, id, static_cast<uint32_t>(m_names.size()), static_cast<uint32_t>(name.size()) };
+    m_names.append(name);
+    m_cached++;
+    return id;
+}
+
+bool CTextFieldParser::ParseValue(const char* begin, const char* end, double& value)
+{
+    while (begin < end && IsSpace(*begin))    ++begin;
+    while (end > begin && IsSpace(end[-1]))   --end;
+    if (begin < end && *begin == '+') {
+        ++begin;
+        if (begin < end && *begin == '-') return false;   // "+-1"
+    }
+    if (begin == end) return false;
+
+    const auto [ptr, ec] = std::from_chars(begin, end, value, std::chars_format::general);
+    return ec == std::errc() && ptr == end;
+}
+
+bool CTextFieldParser::Parse(const uint8_t* text, size_t length)
+{
+    m_count = 0;
+
+    const char* p   = reinterpret_cast<const char*>(text);
+    const char* end = p + length;
+    if (length == 0 || !std::memchr(p, '\t', length)) return false;   // not our format
+
+    if (m_ids.size() < length / 2 + 1) {   // a field needs at least "x:1" plus a tab, more than two bytes
+        m_ids   .resize(length / 2 + 1);
+        m_values.resize(length / 2 + 1);
+    }
+
+    for (;;) {
+        const char* tab = static_cast<const char*>(std::memchr(p, '\t', static_cast<size_t>(end - p)));
+        const char* partEnd = tab ? tab : end;
+
+        const char* colon = static_cast<const char*>(std::memchr(p, ':', static_cast<size_t>(partEnd - p)));
+        double value;
+        if (colon && colon > p && ParseValue(colon + 1, partEnd, value)) {
+            m_ids   [m_count] = Intern(std::string_view(p, static_cast<size_t>(colon - p)));
+            m_values[m_count] = value;
+            m_count++;
+        }
+
+        if (!tab) break;
+        p = tab + 1;
+    }
+    return true;
+}
+
+#pragma managed(pop)
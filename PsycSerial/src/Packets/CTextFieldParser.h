@@ -0,0 +1,56 @@
+#pragma once
+#pragma managed(push, off)
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Text telemetry lines of tab-separated "name:value" fields, parsed from the raw UTF-8 bytes.  Field names are
+// interned once into small integer ids, shared by all parsers; each parser keeps its own lock-free cache of the
+// names it has seen, so only a name's first sighting touches the shared table.  A line gives parallel (id, value)
+// arrays, owned by the parser and overwritten by the next Parse.  Values follow double.TryParse with
+// NumberStyles.Float: surrounding white space and a leading sign allowed, no thousands separators.
+class CTextFieldParser
+{
+public:
+    // true if the line is in the field format (contains a tab); the arrays then hold its valid fields, in order
+    bool Parse(const uint8_t* text, size_t length);
+
+    const uint32_t* GetIds()    const { return m_ids.data(); }
+    const double*   GetValues() const { return m_values.data(); }
+    size_t          GetCount()  const { return m_count; }
+
+    uint32_t Intern(std::string_view name);
+
+    // Shared name table, safe from any thread
+    static bool   GetName(uint32_t id, std::string& name);
+    static size_t GetNameCount();
+
+    static bool ParseValue(const char* begin, const char* end, double& value);
+
+    static void DoTest();
+
+private:
+    struct Slot {
+        uint64_t hash{};
+        uint32_t id{ UINT32_MAX };   // UINT32_MAX = empty
+        uint32_t nameOffset{}, nameLength{};
+    };
+
+    std::vector<uint32_t> m_ids;
+    std::vector<double>   m_values;
+    size_t                m_count{};
+
+    std::vector<Slot>     m_cache;   // open addressing, power-of-two size, at most half full
+    size_t                m_cached{};
+    std::string           m_names;   // cached names back to back
+
+    static uint64_t Hash(std::string_view name);
+    static uint32_t InternShared(std::string_view name);
+
+    void GrowCache();
+};
+
+#pragma managed(pop)
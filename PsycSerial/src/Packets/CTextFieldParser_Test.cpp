@@ -0,0 +1,134 @@
+#include "CTextFieldParser.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+
+constexpr size_t LINES = 200'000;
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// The managed path, natively: split into strings, look the name up in a map, strtod the value
+static size_t NaiveParse(const std::string& line, std::unordered_map<std::string, double>& out)
+{
+    out.clear();
+    size_t start = 0;
+    for (;;) {
+        const size_t tab  = line.find('\t', start);
+        const std::string part = line.substr(start, tab == std::string::npos ? std::string::npos : tab - start);
+        const size_t colon = part.find(':');
+        if (colon != std::string::npos && colon > 0) {
+            const std::string value = part.substr(colon + 1);
+            char* end = nullptr;
+            const double v = std::strtod(value.c_str(), &end);
+            if (end != value.c_str()) out[part.substr(0, colon)] = v;
+        }
+        if (tab == std::string::npos) break;
+        start = tab + 1;
+    }
+    return out.size();
+}
+
+
+void CTextFieldParser::DoTest()
+{
+    std::cout << "=== CTextFieldParser test ===\n";
+
+    // Values as double.TryParse(NumberStyles.Float, InvariantCulture) takes them
+    struct Value { const char* text; bool ok; double value; };
+    const Value values[] = {
+        { "1.5", true, 1.5 }, { " -2 ", true, -2.0 }, { "+3e2", true, 300.0 }, { ".25", true, 0.25 },
+        { "7.\r", true, 7.0 }, { "1,5", false, 0 }, { "", false, 0 }, { "+", false, 0 }, { "+-1", false, 0 },
+        { "0x10", false, 0 }, { "12abc", false, 0 }, { "-0.0", true, -0.0 },
+    };
+    size_t valueErrors = 0;
+    for (const Value& v : values) {
+        double got = 0.0;
+        const bool ok = ParseValue(v.text, v.text + std::strlen(v.text), got);
+        if (ok != v.ok || (ok && got != v.value)) {
+            std::cout << "  value \"" << v.text << "\": " << (ok ? "ok " : "fail ") << got << "\n";
+            ++valueErrors;
+        }
+    }
+    std::cout << "Value cases wrong: " << valueErrors << "\n";
+
+    // Lines: format detection, bad fields skipped, names interned once
+    CTextFieldParser parser;
+    const std::string line = "Time:12.5\tA2D:1024\tbad\t:7\tTemp: 36.6\r";
+    const bool isFields = parser.Parse(reinterpret_cast<const uint8_t*>(line.data()), line.size());
+    std::cout << "Fields line: " << (isFields ? "yes" : "no") << ", " << parser.GetCount() << " fields:";
+    for (size_t i = 0; i < parser.GetCount(); ++i) {
+        std::string name;
+        GetName(parser.GetIds()[i], name);
+        std::cout << " " << name << "=" << parser.GetValues()[i];
+    }
+    std::cout << "\n";
+
+    const std::string plain = "Hello: not fields";
+    std::cout << "Plain line is fields: " << (parser.Parse(reinterpret_cast<const uint8_t*>(plain.data()), plain.size()) ? "yes" : "no")
+              << "\n";
+
+    CTextFieldParser other;
+    std::cout << "Same id from another parser: " << (other.Intern("Temp") == parser.Intern("Temp") ? "yes" : "no") << "\n";
+
+    // Firmware-like telemetry: 6 to 12 fields from a set of 40 names, against the reference
+    std::mt19937 rng(21);
+    std::uniform_int_distribution<int>    nameIndex(0, 39), fieldCount(6, 12);
+    std::uniform_real_distribution<double> value(-5000.0, 5000.0);
+    std::vector<std::string> lines;
+    size_t bytes = 0;
+    for (size_t i = 0; i < LINES; ++i) {
+        std::string l = "Time:" + std::to_string(i * 0.001);
+        for (int f = fieldCount(rng); f > 0; --f) {
+            char buf[64];
+            std::snprintf(buf, sizeof buf, "\tField%02d:%.6g", nameIndex(rng), value(rng));
+            l += buf;
+        }
+        bytes += l.size();
+        lines.push_back(std::move(l));
+    }
+
+    size_t mismatches = 0;
+    std::unordered_map<std::string, double> reference;
+    for (size_t i = 0; i < 2'000; ++i) {
+        parser.Parse(reinterpret_cast<const uint8_t*>(lines[i].data()), lines[i].size());
+        NaiveParse(lines[i], reference);
+        std::unordered_map<std::string, double> got;
+        for (size_t f = 0; f < parser.GetCount(); ++f) {
+            std::string name;
+            GetName(parser.GetIds()[f], name);
+            got[name] = parser.GetValues()[f];
+        }
+        mismatches += (got != reference);
+    }
+    std::cout << "Lines differing from reference: " << mismatches << ", names interned: " << GetNameCount() << "\n";
+
+    double start = GetTime();
+    size_t fields = 0;
+    for (const std::string& l : lines) {
+        parser.Parse(reinterpret_cast<const uint8_t*>(l.data()), l.size());
+        fields += parser.GetCount();
+    }
+    const double tParser = GetTime() - start;
+
+    start = GetTime();
+    size_t naiveFields = 0;
+    for (const std::string& l : lines) naiveFields += NaiveParse(l, reference);
+    const double tNaive = GetTime() - start;
+
+    std::cout << LINES << " lines, " << bytes / 1e6 << " MB, " << fields << " fields: "
+              << tParser / LINES * 1e9 << " ns/line (" << bytes / tParser / 1e6 << " MB/s), split + map + strtod "
+              << tNaive / LINES * 1e9 << " ns/line (" << naiveFields << " fields)\n";
+    std::cout << "\n";
+}
@@ -0,0 +1,200 @@
+#pragma once
+#pragma managed(push, off)
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "CPackets.h"
+
+// Wire layouts, declared once per frame payload as a list of fields in wire order.  Everything that reads or
+// writes a payload (CDecoder, CBlockCodec, CBlockColumns, the encoder) goes through these, so sizes and offsets
+// are computed by the compiler instead of being spelled out by hand in each place.
+//
+//   WireField<&S::member>            the member as it is in memory (arrays included)
+//   WireField<&S::member, uint8_t>   stored narrower (or wider) on the wire, converted on read / write
+//
+// Read / Write unroll to one fixed-offset load or store per field.  Payloads are little endian, as the host.
+
+namespace WireLayoutDetail
+{
+    template <typename T> struct MemberOf;
+    template <typename S, typename V> struct MemberOf<V S::*> { using Struct = S; using Value = V; };
+
+    // Member pointers of different types are never the same member
+    template <auto A, auto B>
+    constexpr bool SameMember() noexcept
+    {
+        if constexpr (std::is_same_v<decltype(A), decltype(B)>) return A == B;
+        else                                                     return false;
+    }
+}
+
+template <auto Member, typename Wire = typename WireLayoutDetail::MemberOf<decltype(Member)>::Value>
+struct WireField
+{
+    using Struct = typename WireLayoutDetail::MemberOf<decltype(Member)>::Struct;
+    using Value  = typename WireLayoutDetail::MemberOf<decltype(Member)>::Value;
+
+    static constexpr auto   member = Member;
+    static constexpr size_t SIZE   = sizeof(Wire);
+
+    static_assert(std::is_trivially_copyable_v<Wire>, "wire fields are copied as bytes");
+    static_assert(std::is_same_v<Wire, Value> || (std::is_arithmetic_v<Wire> && std::is_arithmetic_v<Value>),
+                  "only arithmetic fields can change width on the wire");
+
+    static void Read(const uint8_t* p, Struct& s) noexcept
+    {
+        if constexpr (std::is_same_v<Wire, Value>) {
+            std::memcpy(&(s.*Member), p, SIZE);
+        }
+        else {
+            Wire w; std::memcpy(&w, p, SIZE);
+            s.*Member = static_cast<Value>(w);
+        }
+    }
+
+    static void Write(uint8_t* p, const Struct& s) noexcept
+    {
+        if constexpr (std::is_same_v<Wire, Value>) {
+            std::memcpy(p, &(s.*Member), SIZE);
+        }
+        else {
+            const Wire w = static_cast<Wire>(s.*Member);
+            std::memcpy(p, &w, SIZE);
+        }
+    }
+};
+
+template <typename... Fields>
+struct WireLayout
+{
+    static constexpr size_t COUNT = sizeof...(Fields);
+    static constexpr size_t SIZE  = (size_t(0) + ... + Fields::SIZE);
+
+    template <size_t I> using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    // Byte offset of the I'th field
+    template <size_t I>
+    static constexpr size_t Offset() noexcept
+    {
+        constexpr size_t sizes[] = { Fields::SIZE... };
+        size_t offset = 0;
+        for (size_t i = 0; i < I; ++i) offset += sizes[i];
+        return offset;
+    }
+
+    // Byte offset of a member's field
+    template <auto Member>
+    static constexpr size_t OffsetOf() noexcept
+    {
+        constexpr size_t index = IndexOf<Member>();
+        static_assert(index < COUNT, "member is not in this layout");
+        return Offset<index>();
+    }
+
+    template <typename S>
+    static void Read(const uint8_t* p, S& s) noexcept { ReadAll(p, s, std::index_sequence_for<Fields...>{}); }
+
+    template <typename S>
+    static void Write(uint8_t* p, const S& s) noexcept { WriteAll(p, s, std::index_sequence_for<Fields...>{}); }
+
+    template <typename S>
+    static void Append(std::vector<uint8_t>& out, const S& s)
+    {
+        const size_t at = out.size();
+        out.resize(at + SIZE);
+        Write(out.data() + at, s);
+    }
+
+    // f(field) for every field, in wire order; field is a default-constructed WireField
+    template <typename F>
+    static void ForEachField(F&& f) { (f(Fields{}), ...); }
+
+private:
+    template <auto Member>
+    static constexpr size_t IndexOf() noexcept
+    {
+        constexpr bool match[] = { WireLayoutDetail::SameMember<Fields::member, Member>()... };
+        for (size_t i = 0; i < COUNT; ++i)
+            if (match[i]) return i;
+        return COUNT;
+    }
+
+    template <typename S, size_t... I>
+    static void ReadAll(const uint8_t* p, S& s, std::index_sequence<I...>) noexcept { (Field<I>::Read(p + Offset<I>(), s), ...); }
+
+    template <typename S, size_t... I>
+    static void WriteAll(uint8_t* p, const S& s, std::index_sequence<I...>) noexcept { (Field<I>::Write(p + Offset<I>(), s), ...); }
+};
+
+
+// ----------------------------- Frame payloads --------------------------------
+
+// Data frame: a whole CDataPacket
+using DataLayout = WireLayout<
+    WireField<&CDataPacket::state>,
+    WireField<&CDataPacket::timeStamp>,
+    WireField<&CDataPacket::stateTime>,
+    WireField<&CDataPacket::hardwareState>,
+    WireField<&CDataPacket::sensorState>,
+    WireField<&CDataPacket::channel>>;
+
+// Block frame: header, count items, numEvents events.  Items leave out the state, which is the block's.
+using BlockHeaderLayout = WireLayout<
+    WireField<&CBlockPacket::state>,
+    WireField<&CBlockPacket::timeStamp>,
+    WireField<&CBlockPacket::count>,
+    WireField<&CBlockPacket::numEvents>>;
+
+using BlockItemLayout = WireLayout<
+    WireField<&CDataPacket::timeStamp>,
+    WireField<&CDataPacket::stateTime>,
+    WireField<&CDataPacket::hardwareState>,
+    WireField<&CDataPacket::sensorState>,
+    WireField<&CDataPacket::channel>>;
+
+using BlockEventLayout = WireLayout<
+    WireField<&CEventPacket::eventKind, uint8_t>,
+    WireField<&CEventPacket::stateTime>>;
+
+// Telemetry frame.  key is not sent on its own: it is group, subGroup and id read as one uint32 (see TelemetryKey)
+using TelemetryLayout = WireLayout<
+    WireField<&CTelemetryPacket::timeStamp>,
+    WireField<&CTelemetryPacket::group>,
+    WireField<&CTelemetryPacket::subGroup>,
+    WireField<&CTelemetryPacket::id>,
+    WireField<&CTelemetryPacket::value>>;
+
+// Batched telemetry frame: header, then count entries read in place
+using TelemetryBatchLayout = WireLayout<
+    WireField<&CTelemetryBatch::timeStamp>,
+    WireField<&CTelemetryBatch::count>>;
+
+using TelemetryEntryLayout = WireLayout<
+    WireField<&CTelemetryEntry::key>,
+    WireField<&CTelemetryEntry::value>>;
+
+// Command frame, both directions
+using CommandLayout = WireLayout<
+    WireField<&CCommandPacket::requestId>,
+    WireField<&CCommandPacket::code>,
+    WireField<&CCommandPacket::parameter>,
+    WireField<&CCommandPacket::value>>;
+
+inline constexpr uint32_t TelemetryKey(uint8_t group, uint8_t subGroup, uint16_t id) noexcept
+{
+    return uint32_t(group) | (uint32_t(subGroup) << 8) | (uint32_t(id) << 16);
+}
+
+static_assert(DataLayout::SIZE == sizeof(CDataPacket), "Data frames are whole CDataPackets");
+static_assert(BlockItemLayout::SIZE == DataLayout::SIZE - sizeof(uint32_t), "Block items are Data packets without the state");
+static_assert(TelemetryEntryLayout::SIZE == sizeof(CTelemetryEntry), "batched telemetry entries are read in place");
+static_assert(TelemetryLayout::OffsetOf<&CTelemetryPacket::subGroup>() == TelemetryLayout::OffsetOf<&CTelemetryPacket::group>() + 1
+           && TelemetryLayout::OffsetOf<&CTelemetryPacket::id>()       == TelemetryLayout::OffsetOf<&CTelemetryPacket::group>() + 2,
+              "a telemetry key is the uint32 over group, subGroup and id");
+
+#pragma managed(pop)
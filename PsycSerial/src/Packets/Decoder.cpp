@@ -1,4 +1,5 @@
 #include "Decoder.h"
+#include "CBlockColumns.h"
 #include "../Utilities.h"
 
 
@@ -14,6 +15,7 @@ namespace PsycSerial
 				DataPacket^ pkt = DataPacket::Rent();
 
 				pkt->TimeStamp     = nativePacket.data.timeStamp;
+				pkt->ArrivalNs     = nativePacket.arrivalNs;
 				pkt->StateTime     = nativePacket.data.stateTime;
 				pkt->State         = static_cast<HeadState>(nativePacket.data.state);
 				pkt->HardwareState = nativePacket.data.hardwareState;
@@ -30,11 +32,26 @@ namespace PsycSerial
 				BlockPacket^ blockPkt = BlockPacket::Rent();
 
 				blockPkt->TimeStamp = nativePacket.block.timeStamp;
+				blockPkt->ArrivalNs = nativePacket.arrivalNs;
 				blockPkt->State     = static_cast<HeadState>(nativePacket.block.state);
 
 				blockPkt->Count		= nativePacket.block.count;
 				blockPkt->NumEvents = nativePacket.block.numEvents;
 
+				// Pooled packets keep their arrays; they only grow when the handshake raised the block size
+				if (blockPkt->BlockData->Length < blockPkt->Count)
+				{
+					array<DataPacket^>^ items = blockPkt->BlockData;
+					Array::Resize(items, blockPkt->Count);
+					blockPkt->BlockData = items;
+				}
+				if (blockPkt->EventData->Length < blockPkt->NumEvents)
+				{
+					array<EventPacket^>^ events = blockPkt->EventData;
+					Array::Resize(events, blockPkt->NumEvents);
+					blockPkt->EventData = events;
+				}
+
 				for (size_t i = 0; i < nativePacket.block.count; ++i)
 				{
 					DataPacket^ dataPkt = blockPkt->BlockData[i];
@@ -44,6 +61,7 @@ namespace PsycSerial
 						dataPkt->Reset();
 
 					dataPkt->TimeStamp     = nativePacket.block.blockData[i].timeStamp;
+					dataPkt->ArrivalNs     = nativePacket.arrivalNs;
 					dataPkt->StateTime     = nativePacket.block.blockData[i].stateTime;
 					dataPkt->State         = static_cast<HeadState>(nativePacket.block.blockData[i].state);
 					dataPkt->HardwareState = nativePacket.block.blockData[i].hardwareState;
@@ -70,6 +88,8 @@ namespace PsycSerial
 					blockPkt->EventData[i] = eventPkt;
 				}
 
+				blockPkt->Columns->Load(nativePacket.block);
+
 				return blockPkt;
 			}
 
@@ -79,7 +99,29 @@ namespace PsycSerial
 				const uint8_t* utf8Bytes = nativePacket.text.utf8Bytes;
 
 				textPkt->TimeStamp  = nativePacket.text.timeStamp;
+				textPkt->ArrivalNs  = nativePacket.arrivalNs;
 				textPkt->State      = HeadState::None;
+
+				if (nativePacket.text.fieldIds != nullptr)
+				{
+					// Parsed natively; no need to decode the line
+					const int n = static_cast<int>(nativePacket.text.fieldCount);
+					if (textPkt->FieldIds->Length < n)
+					{
+						textPkt->FieldIds    = gcnew array<int>(n);
+						textPkt->FieldValues = gcnew array<double>(n);
+					}
+					for (int i = 0; i < n; ++i)
+					{
+						textPkt->FieldIds[i]    = static_cast<int>(nativePacket.text.fieldIds[i]);
+						textPkt->FieldValues[i] = nativePacket.text.fieldValues[i];
+					}
+					textPkt->FieldCount = n;
+					textPkt->Text       = AString::Rent();
+					textPkt->Length     = 0;
+					return textPkt;
+				}
+
 				textPkt->Text       = AString::FromUtf8(utf8Bytes, 0, nativePacket.text.length);
 				textPkt->Length		= textPkt->Text->Length;
 
@@ -90,6 +132,7 @@ namespace PsycSerial
 			{
 				TelemetryPacket^ telePkt = TelemetryPacket::Rent();
 				telePkt->TimeStamp = nativePacket.telemetry.timeStamp;
+				telePkt->ArrivalNs = nativePacket.arrivalNs;
 				telePkt->State     = HeadState::None;
 				telePkt->Group     = static_cast<TelemetryPacket::TeleGroup>(nativePacket.telemetry.group);
 				telePkt->SubGroup  = nativePacket.telemetry.subGroup;
@@ -99,6 +142,18 @@ namespace PsycSerial
 				return telePkt;
 			}
 
+			case PacketKind::Command:
+			{
+				CommandPacket^ cmdPkt = CommandPacket::Rent();
+				cmdPkt->State     = HeadState::None;
+				cmdPkt->ArrivalNs = nativePacket.arrivalNs;
+				cmdPkt->RequestId = nativePacket.command.requestId;
+				cmdPkt->Code      = static_cast<CommandPacket::CommandCode>(nativePacket.command.code);
+				cmdPkt->Parameter = nativePacket.command.parameter;
+				cmdPkt->Value     = nativePacket.command.value;
+				return cmdPkt;
+			}
+
 		default:
 			// Unknown packet type
 			return nullptr;
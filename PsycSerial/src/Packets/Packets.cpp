@@ -1,4 +1,6 @@
 #include "Packets.h"
+#include "CBlockColumns.h"
+#include "CTextFieldParser.h"
 #include "../_Config.h"
 
 namespace PsycSerial
@@ -63,6 +65,7 @@ namespace PsycSerial
     {
         State = HeadState::None;
         TimeStamp = 0.0;
+        ArrivalNs = 0;
 		StateTime = 0.0;
         HardwareState = 0;
 		// Channel array is reused, and no need to clean it.
@@ -103,6 +106,8 @@ namespace PsycSerial
     {
         BlockData = gcnew array<DataPacket ^>( Config::MAX_BLOCKSIZE        );
 		EventData = gcnew array<EventPacket^>( Config::MAX_EVENTS_PER_BLOCK );
+		Columns   = new CBlockColumns();
+		Columns->Reserve(Config::MAX_BLOCKSIZE);
 
         Reset();
 	}
@@ -119,14 +124,16 @@ namespace PsycSerial
 	}
 	
     BlockPacket::~BlockPacket(){ Cleanup(); GC::SuppressFinalize(this);	}
-    BlockPacket::!BlockPacket() { }
+    BlockPacket::!BlockPacket() { delete Columns; Columns = nullptr; }
 
     void BlockPacket::Reset()
     {
         State = HeadState::None;
         TimeStamp = 0.0;
+        ArrivalNs = 0;
         Count = 0;
 		NumEvents = 0;
+        if (Columns) Columns->count = 0;
         // BlockData array is reused, no need to clean it.
 	}
 
@@ -134,6 +141,8 @@ namespace PsycSerial
     TextPacket::TextPacket()
     {
 		Text = AString::Rent();
+        FieldIds    = gcnew array<int>(16);
+        FieldValues = gcnew array<double>(16);
         Reset();
     }
     
@@ -158,9 +167,32 @@ namespace PsycSerial
         State = HeadState::None;
 		Length = 0;
         TimeStamp = 0.0;
+        ArrivalNs = 0;
+        FieldCount = -1;
         // release Text in cleanup
     }
 
+    String^ TextPacket::FieldName(int id)
+    {
+        array<String^>^ names = s_fieldNames;
+        if (id >= 0 && id < names->Length) return names[id];
+        if (id < 0) return nullptr;
+
+        // Interned since the last refresh: copy the shared table up to here
+        const int count = static_cast<int>(CTextFieldParser::GetNameCount());
+        if (id >= count) return nullptr;
+
+        array<String^>^ grown = gcnew array<String^>(count);
+        Array::Copy(names, grown, names->Length);
+        std::string name;
+        for (int i = names->Length; i < count; ++i) {
+            CTextFieldParser::GetName(static_cast<uint32_t>(i), name);
+            grown[i] = System::Text::Encoding::UTF8->GetString(reinterpret_cast<const unsigned char*>(name.data()), static_cast<int>(name.size()));
+        }
+        s_fieldNames = grown;   // readers keep whichever table they loaded
+        return grown[id];
+    }
+
     
 
     TelemetryPacket::TelemetryPacket()
@@ -186,10 +218,41 @@ namespace PsycSerial
     {
         State = HeadState::None;
         TimeStamp = 0.0;
+        ArrivalNs = 0;
         Group = TeleGroup::NONE;
 		SubGroup = 0;
         ID = 0;
         Value = 0.0f;
         Key = 0;
 	}
+
+    CommandPacket::CommandPacket()
+    {
+        Reset();
+    }
+    CommandPacket^ CommandPacket::Rent()
+    {
+        CommandPacket^ p; if (s_pool->TryDequeue(p)) return p;
+        return gcnew CommandPacket();
+    }
+
+    void CommandPacket::Cleanup()
+    {
+        Reset();
+        s_pool->Enqueue(this);
+    }
+
+    CommandPacket::~CommandPacket() { Cleanup(); GC::SuppressFinalize(this); }
+    CommandPacket::!CommandPacket() {}
+
+    void CommandPacket::Reset()
+    {
+        State = HeadState::None;
+        TimeStamp = 0.0;
+        ArrivalNs = 0;
+        RequestId = 0;
+        Code = CommandCode::Ping;
+        Parameter = 0;
+        Value = 0.0;
+    }
 }
@@ -3,6 +3,8 @@
 
 #include "..\AString.h"
 
+struct CBlockColumns;
+
 using namespace System;
 using namespace System::Collections::Concurrent;
 
@@ -43,6 +45,7 @@ namespace PsycSerial
     {
         property double    TimeStamp;
         property HeadState State;
+        property Int64     ArrivalNs;   // host time the frame arrived, CHostClock nanoseconds
 
         virtual void Cleanup();
     };
@@ -78,6 +81,7 @@ namespace PsycSerial
 
         virtual property HeadState State;
         virtual property double    TimeStamp;
+        virtual property Int64     ArrivalNs;
 
 		property double         StateTime;
         property System::UInt64 HardwareState;
@@ -169,12 +173,16 @@ namespace PsycSerial
 
         virtual property HeadState    State;
         virtual property double       TimeStamp;
+        virtual property Int64        ArrivalNs;
 
         property int                  Count;
 		property int				  NumEvents;
         property array<DataPacket^>^  BlockData;
 		property array<EventPacket^>^ EventData;
 
+	internal:
+		CBlockColumns* Columns = nullptr;   // native column copy of BlockData, filled by Decoder::Convert
+
 	protected:
 		BlockPacket();
 
@@ -194,13 +202,23 @@ namespace PsycSerial
 
         virtual property HeadState State;
         virtual property double    TimeStamp;
+        virtual property Int64     ArrivalNs;
 
         property AString^   Text;
 		property int        Length;
 
+        // Lines of tab-separated "name:value" fields come parsed by the decoder: FieldCount pairs of interned
+        // name id and value, Text left empty.  FieldCount is -1 for any other line.
+        property int              FieldCount;
+        property array<int>^      FieldIds;
+        property array<double>^   FieldValues;
+
+        static String^ FieldName(int id);
+
     protected:
         TextPacket();
         static ConcurrentQueue<TextPacket^>^ s_pool = gcnew ConcurrentQueue<TextPacket^>();
+        static array<String^>^ s_fieldNames = gcnew array<String^>(0);   // managed copies of the interned names, by id
 	};
 
     public ref class TelemetryPacket : IPacket, IDisposable
@@ -230,6 +248,7 @@ namespace PsycSerial
         void Reset();
         virtual property HeadState State;
         virtual property double    TimeStamp;
+        virtual property Int64     ArrivalNs;
 
 		property TeleGroup Group;
         property int       SubGroup;
@@ -241,6 +260,37 @@ namespace PsycSerial
         TelemetryPacket();
         static ConcurrentQueue<TelemetryPacket^>^ s_pool = gcnew ConcurrentQueue<TelemetryPacket^>();
 	};
+
+    // The device's reply to SerialHelper::SendCommand, matched by RequestId
+    public ref class CommandPacket : IPacket, IDisposable
+    {
+    public:
+        enum class CommandCode : UInt16
+        {
+            Ping = 0,
+            Get  = 1,
+            Set  = 2,
+        };
+
+        static CommandPacket^ Rent();
+        virtual void Cleanup();
+
+        ~CommandPacket();
+        !CommandPacket();
+
+        void Reset();
+        virtual property HeadState State;
+        virtual property double    TimeStamp;   // command frames carry no time stamp; always 0
+        virtual property Int64     ArrivalNs;
+
+        property UInt32      RequestId;
+        property CommandCode Code;
+        property UInt16      Parameter;
+        property double      Value;
+    protected:
+        CommandPacket();
+        static ConcurrentQueue<CommandPacket^>^ s_pool = gcnew ConcurrentQueue<CommandPacket^>();
+    };
 }
 
 #pragma managed(pop)
\ No newline at end of file
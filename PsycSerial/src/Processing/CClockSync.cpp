@@ -0,0 +1,179 @@
+#include "CClockSync.h"
+#pragma managed(push, off)
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+
+void CClockSync::Process(const CDecodedPacket& packet)
+{
+    if (packet.arrivalNs == 0) return;   // not stamped by a read
+
+    switch (packet.kind) {
+        case PacketKind::Block:
+            if (packet.block.count > 0) Observe(packet.block.blockData[packet.block.count - 1].timeStamp, packet.arrivalNs);
+            break;
+        case PacketKind::Data:           Observe(packet.data.timeStamp, packet.arrivalNs);           break;
+        case PacketKind::Telemetry:      Observe(packet.telemetry.timeStamp, packet.arrivalNs);      break;
+        case PacketKind::TelemetryBatch: Observe(packet.telemetryBatch.timeStamp, packet.arrivalNs); break;
+        default: break;
+    }
+}
+
+void CClockSync::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Restart();
+}
+
+void CClockSync::Restart()
+{
+    m_started = false;
+    m_first = m_count = 0;
+    m_window = Point{};
+    m_frames = 0;
+    m_slope = m_intercept = m_envelopeRms = 0.0;
+    Publish();
+}
+
+void CClockSync::Observe(double deviceTime, int64_t arrivalNs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_started && deviceTime < m_lastDevice - RESTART) {
+        ++m_restarts;
+        Restart();
+    }
+    if (!m_started) {
+        m_started      = true;
+        m_deviceOrigin = m_lastDevice = deviceTime;
+        m_hostOriginNs = arrivalNs;
+    }
+    m_lastDevice = std::max(m_lastDevice, deviceTime);
+
+    const double x = deviceTime - m_deviceOrigin;
+    const double y = static_cast<double>(arrivalNs - m_hostOriginNs) * 1e-9 - x;
+
+    // Windows are aligned to the origin; an empty one (a pause in the stream) leaves no point
+    if (m_window.frames > 0 && std::floor(x / WINDOW) != std::floor(m_window.x / WINDOW))
+        CloseWindow();
+
+    if (m_window.frames == 0 || y < m_window.y) {
+        m_window.x = x;
+        m_window.y = y;
+        if (m_count == 0) {   // until a window closes the fit is level, through the fastest frame so far
+            m_intercept = y;
+            Publish();
+        }
+    }
+
+    const double residual = y - (m_intercept + m_slope * x);
+    m_window.frames++;
+    m_window.residualSum += residual;
+    m_window.residualMax  = std::max(m_window.residualMax, residual);
+    ++m_frames;
+}
+
+void CClockSync::CloseWindow()
+{
+    if (m_count < HISTORY) m_points[(m_first + m_count++) % HISTORY] = m_window;
+    else                 { m_points[m_first] = m_window; m_first = (m_first + 1) % HISTORY; }
+    m_window = Point{};
+
+    Refit();
+    Publish();
+}
+
+void CClockSync::Refit()
+{
+    if (m_count == 1) {
+        m_slope     = 0.0;
+        m_intercept = At(0).y;
+    }
+    else {
+        // Lower hull, points being in x order already (monotone chain)
+        size_t h = 0;
+        double meanX = 0.0;
+        for (size_t i = 0; i < m_count; ++i) {
+            const Point& c = At(i);
+            meanX += c.x;
+            while (h >= 2) {
+                const Point& a = At(m_hull[h - 2]);
+                const Point& b = At(m_hull[h - 1]);
+                if ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x) > 0.0) break;
+                --h;
+            }
+            m_hull[h++] = i;
+        }
+        meanX /= static_cast<double>(m_count);
+
+        size_t k = 0;
+        while (k + 2 < h && At(m_hull[k + 1]).x < meanX) ++k;
+        const Point& a = At(m_hull[k]);
+        const Point& b = At(m_hull[k + 1]);
+        m_slope     = (b.y - a.y) / (b.x - a.x);
+        m_intercept = a.y - m_slope * a.x;
+    }
+
+    double sum2 = 0.0;
+    for (size_t i = 0; i < m_count; ++i) {
+        const double r = At(i).y - (m_intercept + m_slope * At(i).x);
+        sum2 += r * r;
+    }
+    m_envelopeRms = std::sqrt(sum2 / static_cast<double>(m_count));
+}
+
+void CClockSync::Publish()
+{
+    // Single writer (under m_mutex); readers retry while the sequence is odd or has moved
+    const uint64_t seq = m_seq.load(std::memory_order_relaxed);
+    m_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    m_fit.deviceOrigin = m_deviceOrigin;
+    m_fit.hostOriginNs = m_hostOriginNs + std::llround(m_intercept * 1e9);
+    m_fit.rate         = 1.0 + m_slope;
+    m_fit.points       = m_started ? static_cast<uint32_t>(std::max<size_t>(m_count, 1)) : 0;
+
+    m_seq.store(seq + 2, std::memory_order_release);
+}
+
+CClockSync::Fit CClockSync::GetFit() const
+{
+    for (int spins = 0; ; ++spins) {
+        const uint64_t before = m_seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            if (spins > 64) std::this_thread::yield();
+            continue;
+        }
+        const Fit fit = m_fit;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_seq.load(std::memory_order_relaxed) == before) return fit;
+    }
+}
+
+CClockSync::Stats CClockSync::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats s;
+    s.frames      = m_frames;
+    s.points      = static_cast<uint32_t>(m_count);
+    s.restarts    = m_restarts;
+    s.driftPpm    = m_slope * 1e6;
+    s.envelopeRms = m_envelopeRms;
+
+    uint64_t frames = m_window.frames;
+    double   sum    = m_window.residualSum;
+    s.residualMax   = m_window.residualMax;
+    for (size_t i = 0; i < m_count; ++i) {
+        frames       += At(i).frames;
+        sum          += At(i).residualSum;
+        s.residualMax = std::max(s.residualMax, At(i).residualMax);
+    }
+    s.residualMean = frames ? sum / static_cast<double>(frames) : 0.0;
+    s.span         = m_count ? At(m_count - 1).x - At(0).x : 0.0;
+    return s;
+}
+
+#pragma managed(pop)
@@ -0,0 +1,92 @@
+#pragma once
+#pragma managed(push, off)
+
+#include "CPacketStage.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// Device clock against host clock, estimated online from every timed frame: its device time stamp (the last
+// sample's, for a block) and its host arrival (CDecodedPacket::arrivalNs).  USB only ever adds latency, so the
+// frames that arrived fastest bound the true mapping from above.  Each WINDOW of device time contributes its
+// fastest frame; the fit is the edge of the lower convex hull of the last HISTORY of those that lies under their
+// mean device time: the line under every point that is closest to them on average.  Late frames cannot pull it,
+// and its slope is the drift of the device crystal.  O(HISTORY) per window, nothing per frame beyond a compare.
+//
+// The fit is published under a seqlock; GetFit never blocks the read thread, and Fit::ToHostNs maps any number of
+// device times in O(1) each.  Device time stepping back by more than RESTART (a new device, or a reset one) starts
+// over, as does Reset().
+class CClockSync : public CPacketStage
+{
+public:
+    static constexpr double WINDOW  = 0.25;   // device seconds per envelope point
+    static constexpr size_t HISTORY = 128;    // envelope points fitted: 32 s
+    static constexpr double RESTART = 1.0;    // device seconds
+
+    // host = hostOriginNs + (device - deviceOrigin) * rate, in ns; the minimum latency is included
+    struct Fit {
+        double   deviceOrigin{};    // device seconds
+        int64_t  hostOriginNs{};    // CHostClock ns at deviceOrigin
+        double   rate{ 1.0 };       // host seconds per device second
+        uint32_t points{};          // envelope points behind the fit, 0 = no frame seen yet
+
+        int64_t ToHostNs(double deviceTime) const { return hostOriginNs + static_cast<int64_t>((deviceTime - deviceOrigin) * rate * 1e9); }
+        double  DriftPpm() const { return (rate - 1.0) * 1e6; }
+        bool    IsValid()  const { return points != 0; }
+    };
+
+    struct Stats {
+        uint64_t frames{};          // timed frames seen since the last restart
+        uint32_t points{};          // envelope points in the fit
+        uint32_t restarts{};
+        double   driftPpm{};
+        double   span{};            // device seconds covered by the fit
+        double   envelopeRms{};     // of envelope points above the fit: jitter of the fastest frame, seconds
+        double   residualMean{};    // of frames above the fit when they arrived, over the fit's history: latency
+        double   residualMax{};     // beyond the fastest frame's, seconds
+    };
+
+    void Process(const CDecodedPacket& packet) override;
+    void Reset() override;
+
+    // One frame: device time in seconds, host arrival in CHostClock ns
+    void Observe(double deviceTime, int64_t arrivalNs);
+
+    Fit   GetFit() const;
+    Stats GetStats() const;
+
+    static void DoTest();
+
+private:
+    struct Point {
+        double   x{}, y{};          // device seconds since the origin; host minus device seconds, less the origin's
+        uint64_t frames{};
+        double   residualSum{}, residualMax{};
+    };
+
+    mutable std::mutex m_mutex;     // everything below but the published fit
+    bool     m_started{};
+    double   m_deviceOrigin{};
+    int64_t  m_hostOriginNs{};
+    double   m_lastDevice{};
+    Point    m_window;              // open window: its fastest frame so far
+    Point    m_points[HISTORY];     // closed windows, oldest at m_first
+    size_t   m_first{}, m_count{};
+    uint64_t m_frames{};
+    uint32_t m_restarts{};
+    double   m_slope{}, m_intercept{};   // y = m_intercept + m_slope * x
+    double   m_envelopeRms{};
+    size_t   m_hull[HISTORY];       // scratch for the fit
+
+    std::atomic<uint64_t> m_seq{};  // odd while m_fit is written
+    Fit                   m_fit;
+
+    void Restart();
+    void CloseWindow();
+    void Refit();
+    void Publish();
+    const Point& At(size_t i) const { return m_points[(m_first + i) % HISTORY]; }
+};
+
+#pragma managed(pop)
@@ -0,0 +1,127 @@
+#include "CClockSync.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+constexpr double  DRIFT      = 47e-6;           // device crystal fast by this
+constexpr int64_t HOST_START = 5'000'000'000;   // host ns when the device clock read 0
+constexpr double  MIN_LAT    = 125e-6;          // fastest USB delivery
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// Host time a frame stamped d on the device would arrive with no latency at all
+static int64_t TrueHostNs(double d, double drift = DRIFT) { return HOST_START + std::llround(d / (1.0 + drift) * 1e9 + MIN_LAT * 1e9); }
+
+// A frame every ms of device time for seconds: latency exponential over the minimum, 1% of frames held up to
+// 20 ms (the host busy), and every fifth second a 200 ms stall that delivers a backlog all at once
+static void Feed(CClockSync& sync, double from, double seconds, std::mt19937& rng, double drift = DRIFT)
+{
+    std::exponential_distribution<double>  latency(1.0 / 300e-6);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (double d = from; d < from + seconds; d += 1e-3) {
+        double extra = latency(rng);
+        if (uniform(rng) < 0.01) extra += 20e-3 * uniform(rng);
+        const double inSecond = std::fmod(d, 5.0);
+        if (inSecond > 2.0 && inSecond < 2.2) extra += 2.2 - inSecond;
+        sync.Observe(d, TrueHostNs(d, drift) + std::llround(extra * 1e9));
+    }
+}
+
+// What an ordinary least-squares line through every frame makes of the same data
+static double LeastSquaresDriftPpm(double seconds, std::mt19937& rng)
+{
+    std::exponential_distribution<double>  latency(1.0 / 300e-6);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (double d = 0.0; d < seconds; d += 1e-3) {
+        double extra = latency(rng);
+        if (uniform(rng) < 0.01) extra += 20e-3 * uniform(rng);
+        const double inSecond = std::fmod(d, 5.0);
+        if (inSecond > 2.0 && inSecond < 2.2) extra += 2.2 - inSecond;
+        const double y = (TrueHostNs(d) - HOST_START) * 1e-9 + extra - d;
+        n += 1; sx += d; sy += y; sxx += d * d; sxy += d * y;
+    }
+    return (n * sxy - sx * sy) / (n * sxx - sx * sx) * 1e6;
+}
+
+
+void CClockSync::DoTest()
+{
+    std::cout << "=== CClockSync test ===\n";
+
+    CClockSync sync;
+    std::mt19937 rng(11);
+
+    double fed = 0.0;
+    for (double upTo : { 1.0, 5.0, 30.0, 120.0 }) {
+        Feed(sync, fed, upTo - fed, rng);
+        fed = upTo;
+
+        const Fit   fit = sync.GetFit();
+        const Stats s   = sync.GetStats();
+        double worst = 0.0;
+        for (double d = std::max(0.0, upTo - 30.0); d < upTo; d += 0.01)
+            worst = std::max(worst, std::abs(double(fit.ToHostNs(d) - TrueHostNs(d))));
+        std::cout << "After " << upTo << " s: drift " << fit.DriftPpm() << " ppm (true " << -DRIFT / (1.0 + DRIFT) * 1e6
+                  << "), worst mapping error " << worst / 1e3 << " us over the last 30 s, " << s.points
+                  << " points, envelope rms " << s.envelopeRms * 1e6 << " us, residual mean " << s.residualMean * 1e6
+                  << " us, max " << s.residualMax * 1e3 << " ms\n";
+    }
+    std::mt19937 lsRng(11);
+    std::cout << "Least squares through every frame: drift " << LeastSquaresDriftPpm(120.0, lsRng) << " ppm\n";
+
+    // Prediction: the fit from 120 s of data, 30 s ahead of it
+    {
+        const Fit fit = sync.GetFit();
+        std::cout << "Extrapolated 30 s: error " << (fit.ToHostNs(150.0) - TrueHostNs(150.0)) / 1e3 << " us\n";
+    }
+
+    // A different device (its clock from 0 again, another crystal) is a restart
+    Feed(sync, 0.0, 10.0, rng, -20e-6);
+    const Stats s = sync.GetStats();
+    std::cout << "New device clock: restarts " << s.restarts << ", drift " << sync.GetFit().DriftPpm() << " ppm (true "
+              << 20e-6 / (1.0 - 20e-6) * 1e6 << "), " << s.frames << " frames since\n";
+
+    // Through the stage interface: a block's last sample times it; unstamped frames are ignored
+    {
+        CClockSync stage;
+        std::vector<CDataPacket> items(10);
+        CDecodedPacket p;
+        p.kind = PacketKind::Block;
+        p.block = CBlockPacket{ 0, 0.0, uint32_t(items.size()), 0, items.data(), nullptr };
+        for (size_t i = 0; i < items.size(); ++i) items[i].timeStamp = 2.0 + i * 1e-3;
+        p.arrivalNs = 0;
+        stage.Process(p);
+        const bool ignored = !stage.GetFit().IsValid();
+        p.arrivalNs = 7'000'000'000;
+        stage.Process(p);
+        std::cout << "Stage: unstamped ignored " << (ignored ? "yes" : "NO") << ", block maps its last sample to "
+                  << (stage.GetFit().ToHostNs(2.009) - p.arrivalNs) << " ns from its arrival\n";
+    }
+
+    // Costs: per frame on the read thread, per mapped sample on the reader's
+    {
+        CClockSync perf;
+        const int N = 2'000'000;
+        double start = GetTime();
+        for (int i = 0; i < N; ++i) perf.Observe(i * 1e-3, HOST_START + int64_t(i) * 1'000'000 + (int64_t(i) * 7919 % 500) * 1000);
+        const double tObserve = (GetTime() - start) / N;
+
+        const Fit fit = perf.GetFit();
+        int64_t sum = 0;
+        start = GetTime();
+        for (int i = 0; i < N; ++i) sum += fit.ToHostNs(i * 1e-3);
+        const double tMap = (GetTime() - start) / N;
+        std::cout << "Observe: " << tObserve * 1e9 << " ns/frame, ToHostNs: " << tMap * 1e9 << " ns/sample (" << (sum & 1)
+                  << ")\n";
+    }
+    std::cout << "\n";
+}
@@ -0,0 +1,163 @@
+#include "CEventAnalyzer.h"
+#pragma managed(push, off)
+
+#include <algorithm>
+
+
+// ------------------------------------------------------------------ histogram
+
+void CEventAnalyzer::Histogram::Add(double v)
+{
+    const double bin = binWidth > 0.0 ? v / binWidth : static_cast<double>(BINS);
+    if (bin >= 0.0 && bin < static_cast<double>(BINS))
+        bins[static_cast<size_t>(bin)]++;
+    else
+        overflow++;
+
+    if (count == 0) min = max = v;
+    else { min = std::min(min, v); max = std::max(max, v); }
+    count++;
+    sum += v;
+}
+
+void CEventAnalyzer::Histogram::Clear()
+{
+    std::fill(std::begin(bins), std::end(bins), 0u);
+    overflow = 0;
+    count    = 0;
+    sum = min = max = 0.0;
+}
+
+
+// ------------------------------------------------------------------ analyzer
+
+CEventAnalyzer::CEventAnalyzer()
+{
+    // Firmware defaults until the handshake says otherwise (Config::A2D_READING_PERIOD_uS, POT_UPDATE_OFFSET_uS)
+    SetTiming(900e-6, 667e-6);
+}
+
+bool CEventAnalyzer::KindOf(uint32_t eventKind, Kind& kind, bool& isStart)
+{
+    switch (eventKind) {
+        case 0x11: kind = Kind::A2D_DATA_READY; isStart = true;  return true;
+        case 0x12: kind = Kind::A2D_READ;       isStart = true;  return true;
+        case 0x13: kind = Kind::A2D_READ;       isStart = false; return true;
+        case 0x21: kind = Kind::HW_UPDATE;      isStart = true;  return true;
+        case 0x22: kind = Kind::HW_UPDATE;      isStart = false; return true;
+        case 0x31: kind = Kind::SPI_DMA;        isStart = true;  return true;
+        case 0x32: kind = Kind::SPI_DMA;        isStart = false; return true;
+        default:   return false;
+    }
+}
+
+void CEventAnalyzer::SetLimits(Kind kind, double limit, double nominal)
+{
+    Stats& s   = m_kinds[static_cast<size_t>(kind)].stats;
+    s.limit    = limit;
+    s.nominal  = nominal;
+    s.duration.binWidth = 2.0 * limit   / Histogram::BINS;
+    s.interval.binWidth = 2.0 * nominal / Histogram::BINS;
+}
+
+void CEventAnalyzer::SetTiming(double readPeriod, double potUpdateOffset)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Tracker& k : m_kinds) k.stats = Stats{};
+
+    SetLimits(Kind::A2D_DATA_READY, 0.0                         , readPeriod);
+    SetLimits(Kind::A2D_READ      , potUpdateOffset             , readPeriod);
+    SetLimits(Kind::HW_UPDATE     , readPeriod - potUpdateOffset, readPeriod);
+    SetLimits(Kind::SPI_DMA       , readPeriod                  , readPeriod);
+    Restart();
+}
+
+void CEventAnalyzer::Restart()
+{
+    for (Tracker& k : m_kinds) k.open = k.lastStart = -1.0;
+    m_lastTime = 0.0;
+}
+
+void CEventAnalyzer::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Restart();
+    m_state = CDataPacket::STATE_UNSET;
+}
+
+void CEventAnalyzer::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Tracker& k : m_kinds) {
+        Stats& s = k.stats;
+        s.pairs = s.overruns = s.longIntervals = s.orphanStarts = s.orphanCompletes = 0;
+        s.duration.Clear();
+        s.interval.Clear();
+    }
+    Restart();
+}
+
+void CEventAnalyzer::GetStats(Kind kind, Stats& out) const
+{
+    if (kind >= Kind::COUNT) { out = Stats{}; return; }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out = m_kinds[static_cast<size_t>(kind)].stats;
+}
+
+void CEventAnalyzer::OnEvent(Kind kind, bool isStart, double t)
+{
+    Tracker& k = m_kinds[static_cast<size_t>(kind)];
+    Stats&   s = k.stats;
+
+    if (isStart) {
+        if (k.lastStart >= 0.0) {
+            const double interval = t - k.lastStart;
+            s.interval.Add(interval);
+            if (s.nominal > 0.0 && interval > 1.5 * s.nominal) s.longIntervals++;
+        }
+        k.lastStart = t;
+
+        if (kind == Kind::A2D_DATA_READY) { s.pairs++; return; }   // single event, nothing to pair
+
+        if (k.open >= 0.0) s.orphanStarts++;
+        k.open = t;
+        return;
+    }
+
+    if (k.open < 0.0) { s.orphanCompletes++; return; }
+
+    const double duration = t - k.open;
+    k.open = -1.0;
+    s.pairs++;
+    s.duration.Add(duration);
+    if (s.limit > 0.0 && duration > s.limit) s.overruns++;
+}
+
+void CEventAnalyzer::Process(const CDecodedPacket& packet)
+{
+    if (packet.kind != PacketKind::Block) return;
+    const CBlockPacket& block = packet.block;
+    const size_t n = block.eventData ? block.numEvents : 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (block.state != m_state) {
+        m_state = block.state;
+        Restart();
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        const CEventPacket& e = block.eventData[i];
+        Kind kind;
+        bool isStart;
+        if (!KindOf(e.eventKind, kind, isStart)) continue;
+
+        const double t = e.stateTime;
+        if (t < m_lastTime) Restart();   // new state cycle
+        m_lastTime = t;
+
+        OnEvent(kind, isStart, t);
+    }
+}
+
+#pragma managed(pop)
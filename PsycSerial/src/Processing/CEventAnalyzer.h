@@ -0,0 +1,76 @@
+#pragma once
+#pragma managed(push, off)
+
+#include "CPacketStage.h"
+
+#include <cstdint>
+#include <mutex>
+
+// Timing of the firmware's block events.  START/COMPLETE events are paired per kind (pairs may straddle blocks),
+// giving a duration histogram; successive starts give an interval histogram.  A duration over the kind's limit is
+// an overrun, an interval over 1.5x nominal is a missed cycle.  Times are stateTime (seconds), which restarts with
+// every state, so pairing restarts whenever time steps back.  Fixed storage, O(events) per block.
+class CEventAnalyzer : public CPacketStage
+{
+public:
+    enum class Kind : uint32_t { A2D_DATA_READY, A2D_READ, HW_UPDATE, SPI_DMA, COUNT };
+
+    struct Histogram {
+        static constexpr size_t BINS = 64;
+
+        double   binWidth{};      // seconds; BINS bins cover [0, 2 x the kind's limit)
+        uint32_t bins[BINS]{};
+        uint32_t overflow{};
+        uint64_t count{};
+        double   sum{}, min{}, max{};
+
+        void   Add(double v);
+        void   Clear();
+        double Mean() const { return count ? sum / static_cast<double>(count) : 0.0; }
+    };
+
+    struct Stats {
+        uint64_t  pairs{};           // durations measured (or DATA_READY events)
+        uint64_t  overruns{};
+        uint64_t  longIntervals{};
+        uint64_t  orphanStarts{};    // a start with the previous one still open
+        uint64_t  orphanCompletes{}; // a complete with no start
+        double    limit{};           // duration limit, seconds (0 = none)
+        double    nominal{};         // nominal start-to-start interval, seconds
+        Histogram duration, interval;
+    };
+
+    CEventAnalyzer();
+
+    // From the device config: A2D read period and the read -> pot update offset, in seconds.  A read must finish
+    // before its pot update, a pot update before the next read, a DMA within one period.  Clears the statistics.
+    void SetTiming(double readPeriod, double potUpdateOffset);
+
+    void Process(const CDecodedPacket& packet) override;
+    void Reset() override;        // drops open pairs, keeps statistics
+    void Clear();                 // statistics too
+
+    void GetStats(Kind kind, Stats& out) const;
+
+    static bool KindOf(uint32_t eventKind, Kind& kind, bool& isStart);
+
+    static void DoTest();
+
+private:
+    struct Tracker {
+        Stats  stats;
+        double open{ -1.0 };      // start time of the open pair, < 0 if none
+        double lastStart{ -1.0 };
+    };
+
+    mutable std::mutex m_mutex;
+    Tracker            m_kinds[static_cast<size_t>(Kind::COUNT)];
+    uint32_t           m_state{ CDataPacket::STATE_UNSET };
+    double             m_lastTime{};
+
+    void SetLimits(Kind kind, double limit, double nominal);
+    void Restart();
+    void OnEvent(Kind kind, bool isStart, double t);
+};
+
+#pragma managed(pop)
@@ -0,0 +1,116 @@
+#include "CEventAnalyzer.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+constexpr double PERIOD     = 900e-6;     // A2D_READING_PERIOD_uS
+constexpr double POT_OFFSET = 667e-6;     // POT_UPDATE_OFFSET_uS
+constexpr double STATE      = 3050e-6;    // STATE_DURATION_uS
+constexpr size_t BLOCKS     = 20'000;
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+static void Push(CBlockPacket& b, uint32_t kind, double t)
+{
+    if (b.numEvents < CBlockPacket::MAX_EVENTS_PER_BLOCK) b.eventData[b.numEvents++] = CEventPacket{ kind, t };
+}
+
+// One state's worth of firmware events: a read cycle every PERIOD, each with data-ready, the read, the pot update
+// and the DMA.  overrunAt stretches that cycle's read past the pot update; dropAt loses that cycle's read start.
+static void FillState(CBlockPacket& b, uint32_t state, std::mt19937& rng, int overrunAt, int dropAt)
+{
+    std::uniform_real_distribution<double> jitter(-10e-6, 10e-6);
+    b.state = state;
+    b.numEvents = 0;
+
+    int cycle = 0;
+    for (double t = 50e-6; t + PERIOD < STATE; t += PERIOD, ++cycle) {
+        const double read = (cycle == overrunAt) ? 700e-6 : 300e-6 + jitter(rng);
+        Push(b, 0x11, t);
+        if (cycle != dropAt) Push(b, 0x12, t + 5e-6);
+        Push(b, 0x31, t + 6e-6);
+        Push(b, 0x13, t + 5e-6 + read);
+        Push(b, 0x32, t + 400e-6 + jitter(rng));
+        Push(b, 0x21, t + POT_OFFSET + 20e-6);
+        Push(b, 0x22, t + POT_OFFSET + 120e-6 + jitter(rng));
+    }
+    std::stable_sort(b.eventData, b.eventData + b.numEvents,
+                     [](const CEventPacket& l, const CEventPacket& r) { return l.stateTime < r.stateTime; });
+}
+
+
+void CEventAnalyzer::DoTest()
+{
+    std::cout << "=== CEventAnalyzer test ===\n";
+
+    CEventAnalyzer analyzer;
+    analyzer.SetTiming(PERIOD, POT_OFFSET);
+
+    std::mt19937 rng(3);
+    auto* packet = new CDecodedPacket;
+    std::vector<CEventPacket> storage(CBlockPacket::MAX_EVENTS_PER_BLOCK);
+    packet->kind  = PacketKind::Block;
+    packet->block = CBlockPacket{};
+    packet->block.eventData = storage.data();
+
+    // Every 100th state has an overrun, every 250th loses a read start
+    size_t expectOverruns = 0, expectDrops = 0, events = 0;
+    double elapsed = 0.0;
+    for (size_t i = 0; i < BLOCKS; ++i) {
+        const int overrunAt = (i % 100 == 7) ? 1 : -1;
+        const int dropAt    = (i % 250 == 9) ? 1 : -1;
+        expectOverruns += (overrunAt >= 0);
+        expectDrops    += (dropAt    >= 0);
+
+        FillState(packet->block, (i & 1) ? 0x1 : 0x10000, rng, overrunAt, dropAt);
+        events += packet->block.numEvents;
+
+        const double start = GetTime();
+        analyzer.Process(*packet);
+        elapsed += GetTime() - start;
+    }
+
+    Stats read, hw, dma, ready;
+    analyzer.GetStats(Kind::A2D_READ, read);
+    analyzer.GetStats(Kind::HW_UPDATE, hw);
+    analyzer.GetStats(Kind::SPI_DMA, dma);
+    analyzer.GetStats(Kind::A2D_DATA_READY, ready);
+
+    std::cout << "A2D read:   " << read.pairs << " pairs, mean " << read.duration.Mean() * 1e6 << " us, max "
+              << read.duration.max * 1e6 << " us, overruns " << read.overruns << " (expected " << expectOverruns
+              << "), orphan completes " << read.orphanCompletes << " (expected " << expectDrops << ")\n";
+    std::cout << "            interval mean " << read.interval.Mean() * 1e6 << " us, long intervals "
+              << read.longIntervals << " (expected " << expectDrops << ")\n";
+    std::cout << "HW update:  " << hw.pairs << " pairs, mean " << hw.duration.Mean() * 1e6 << " us, overruns "
+              << hw.overruns << "\n";
+    std::cout << "SPI DMA:    " << dma.pairs << " pairs, mean " << dma.duration.Mean() * 1e6 << " us, overruns "
+              << dma.overruns << "\n";
+    std::cout << "Data ready: " << ready.pairs << " events, interval mean " << ready.interval.Mean() * 1e6
+              << " us, min " << ready.interval.min * 1e6 << " us, max " << ready.interval.max * 1e6 << " us\n";
+
+    // The read duration histogram should peak in the 300 us bin, with the overruns past the limit
+    size_t peak = 0;
+    for (size_t k = 1; k < Histogram::BINS; ++k) if (read.duration.bins[k] > read.duration.bins[peak]) peak = k;
+    uint64_t beyond = read.duration.overflow;
+    for (size_t k = static_cast<size_t>(read.limit / read.duration.binWidth); k < Histogram::BINS; ++k)
+        beyond += read.duration.bins[k];
+    std::cout << "Read histogram peak bin " << peak << " (" << peak * read.duration.binWidth * 1e6 << ".."
+              << (peak + 1) * read.duration.binWidth * 1e6 << " us), beyond limit " << beyond << "\n";
+
+    analyzer.Clear();
+    analyzer.GetStats(Kind::A2D_READ, read);
+    std::cout << "After Clear: " << read.pairs << " pairs, limit " << read.limit * 1e6 << " us\n";
+
+    std::cout << events << " events in " << elapsed * 1e3 << " ms (" << elapsed / events * 1e9 << " ns/event)\n";
+    std::cout << "\n";
+
+    delete packet;
+}
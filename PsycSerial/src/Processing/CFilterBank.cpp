@@ -0,0 +1,300 @@
+#include "CFilterBank.h"
+#pragma managed(push, off)
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "../CCpuFeatures.h"
+
+static constexpr size_t CH = CFilterBank::CHANNELS;
+static_assert(CH == 8, "AVX kernels process the channels as two 4-wide halves");
+
+
+// ------------------------------------------------------------------ designs
+
+static void Normalise(CFilterBank::Biquad& b, double a0, double a1, double a2)
+{
+    b.b0 /= a0; b.b1 /= a0; b.b2 /= a0;
+    b.a1  = a1 / a0;
+    b.a2  = a2 / a0;
+}
+
+CFilterBank::Biquad CFilterBank::Biquad::LowPass(double fs, double f, double q)
+{
+    const double w = 2.0 * std::numbers::pi * f / fs, c = std::cos(w), alpha = std::sin(w) / (2.0 * q);
+    Biquad b{ (1.0 - c) / 2.0, 1.0 - c, (1.0 - c) / 2.0 };
+    Normalise(b, 1.0 + alpha, -2.0 * c, 1.0 - alpha);
+    return b;
+}
+
+CFilterBank::Biquad CFilterBank::Biquad::HighPass(double fs, double f, double q)
+{
+    const double w = 2.0 * std::numbers::pi * f / fs, c = std::cos(w), alpha = std::sin(w) / (2.0 * q);
+    Biquad b{ (1.0 + c) / 2.0, -(1.0 + c), (1.0 + c) / 2.0 };
+    Normalise(b, 1.0 + alpha, -2.0 * c, 1.0 - alpha);
+    return b;
+}
+
+CFilterBank::Biquad CFilterBank::Biquad::Notch(double fs, double f, double q)
+{
+    const double w = 2.0 * std::numbers::pi * f / fs, c = std::cos(w), alpha = std::sin(w) / (2.0 * q);
+    Biquad b{ 1.0, -2.0 * c, 1.0 };
+    Normalise(b, 1.0 + alpha, -2.0 * c, 1.0 - alpha);
+    return b;
+}
+
+CFilterBank::Biquad CFilterBank::Biquad::DCBlocker(double r)
+{
+    return { 1.0, -1.0, 0.0, -r, 0.0 };
+}
+
+
+// ------------------------------------------------------------------ kernels
+// values: count rows of CH doubles.  Scalar and AVX versions do the same operations in the same order (no FMA),
+// so they agree bit for bit.
+
+static void BiquadScalar(const CFilterBank::Biquad& q, double* z1, double* z2, double* values, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        double* v = values + i * CH;
+        for (size_t ch = 0; ch < CH; ++ch) {
+            const double x = v[ch];
+            const double y = q.b0 * x + z1[ch];
+            z1[ch] = (q.b1 * x - q.a1 * y) + z2[ch];
+            z2[ch] =  q.b2 * x - q.a2 * y;
+            v[ch] = y;
+        }
+    }
+}
+
+// hist: 2*taps rows, each sample written twice so the newest-first window is always contiguous
+static void FirScalar(const double* taps, size_t n, double* hist, size_t& pos, double* values, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        double* v = values + i * CH;
+        std::copy(v, v + CH, hist + pos * CH);
+        std::copy(v, v + CH, hist + (pos + n) * CH);
+
+        const double* newest = hist + (pos + n) * CH;
+        for (size_t ch = 0; ch < CH; ++ch) {
+            double acc = 0.0;
+            for (size_t k = 0; k < n; ++k)
+                acc += taps[k] * (newest - k * CH)[ch];
+            v[ch] = acc;
+        }
+        if (++pos == n) pos = 0;
+    }
+}
+
+#ifdef CPU_X64
+CPU_TARGET_AVX
+static void BiquadAvx(const CFilterBank::Biquad& q, double* z1, double* z2, double* values, size_t count)
+{
+    const __m256d b0 = _mm256_set1_pd(q.b0), b1 = _mm256_set1_pd(q.b1), b2 = _mm256_set1_pd(q.b2);
+    const __m256d a1 = _mm256_set1_pd(q.a1), a2 = _mm256_set1_pd(q.a2);
+
+    __m256d z1lo = _mm256_loadu_pd(z1), z1hi = _mm256_loadu_pd(z1 + 4);
+    __m256d z2lo = _mm256_loadu_pd(z2), z2hi = _mm256_loadu_pd(z2 + 4);
+
+    for (size_t i = 0; i < count; ++i) {
+        double* v = values + i * CH;
+        const __m256d xlo = _mm256_loadu_pd(v), xhi = _mm256_loadu_pd(v + 4);
+
+        const __m256d ylo = _mm256_add_pd(_mm256_mul_pd(b0, xlo), z1lo);
+        const __m256d yhi = _mm256_add_pd(_mm256_mul_pd(b0, xhi), z1hi);
+
+        z1lo = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(b1, xlo), _mm256_mul_pd(a1, ylo)), z2lo);
+        z1hi = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(b1, xhi), _mm256_mul_pd(a1, yhi)), z2hi);
+        z2lo = _mm256_sub_pd(_mm256_mul_pd(b2, xlo), _mm256_mul_pd(a2, ylo));
+        z2hi = _mm256_sub_pd(_mm256_mul_pd(b2, xhi), _mm256_mul_pd(a2, yhi));
+
+        _mm256_storeu_pd(v, ylo);
+        _mm256_storeu_pd(v + 4, yhi);
+    }
+
+    _mm256_storeu_pd(z1, z1lo); _mm256_storeu_pd(z1 + 4, z1hi);
+    _mm256_storeu_pd(z2, z2lo); _mm256_storeu_pd(z2 + 4, z2hi);
+}
+
+CPU_TARGET_AVX
+static void FirAvx(const double* taps, size_t n, double* hist, size_t& pos, double* values, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        double* v = values + i * CH;
+        const __m256d xlo = _mm256_loadu_pd(v), xhi = _mm256_loadu_pd(v + 4);
+        _mm256_storeu_pd(hist + pos * CH      , xlo); _mm256_storeu_pd(hist + pos * CH + 4      , xhi);
+        _mm256_storeu_pd(hist + (pos + n) * CH, xlo); _mm256_storeu_pd(hist + (pos + n) * CH + 4, xhi);
+
+        const double* newest = hist + (pos + n) * CH;
+        __m256d lo = _mm256_setzero_pd(), hi = _mm256_setzero_pd();
+        for (size_t k = 0; k < n; ++k) {
+            const __m256d t = _mm256_set1_pd(taps[k]);
+            const double* h = newest - k * CH;
+            lo = _mm256_add_pd(lo, _mm256_mul_pd(t, _mm256_loadu_pd(h)));
+            hi = _mm256_add_pd(hi, _mm256_mul_pd(t, _mm256_loadu_pd(h + 4)));
+        }
+        _mm256_storeu_pd(v, lo);
+        _mm256_storeu_pd(v + 4, hi);
+        if (++pos == n) pos = 0;
+    }
+}
+#endif
+
+
+bool CFilterBank::HasAvx()
+{
+    return CCpuFeatures::HasAvx();
+}
+
+
+// ------------------------------------------------------------------ configuration
+
+void CFilterBank::AddBiquad(const Biquad& section)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sections.push_back({ false, section, 0, 0 });
+    Rebuild();
+}
+
+void CFilterBank::AddFir(std::span<const double> taps)
+{
+    if (taps.empty()) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sections.push_back({ true, {}, m_taps.size(), taps.size() });
+    m_taps.insert(m_taps.end(), taps.begin(), taps.end());
+    Rebuild();
+}
+
+void CFilterBank::ClearSections()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sections.clear();
+    m_taps.clear();
+    Rebuild();
+}
+
+void CFilterBank::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_states.clear();
+}
+
+// Lays out per-state filter memory for the current cascade and drops existing state
+void CFilterBank::Rebuild()
+{
+    m_zOffset.clear();
+    m_zSize = 0;
+    for (const Section& s : m_sections) {
+        m_zOffset.push_back(m_zSize);
+        m_zSize += s.fir ? 2 * s.tapCount * CH : 2 * CH;
+    }
+    m_states.clear();
+}
+
+CFilterBank::StateData& CFilterBank::FindOrAdd(uint32_t state)
+{
+    for (auto& sd : m_states)
+        if (sd.state == state) return sd;
+
+    m_states.push_back({ state, std::vector<double>(m_zSize, 0.0), std::vector<size_t>(m_sections.size(), 0), {} });
+    return m_states.back();
+}
+
+
+// ------------------------------------------------------------------ processing
+
+void CFilterBank::Run(StateData& sd, double* values, size_t count)
+{
+    for (size_t s = 0; s < m_sections.size(); ++s) {
+        const Section& sec = m_sections[s];
+        double* z = sd.z.data() + m_zOffset[s];
+
+#ifdef CPU_X64
+        if (m_useAvx) {
+            if (sec.fir) FirAvx   (m_taps.data() + sec.tapOffset, sec.tapCount, z, sd.firPos[s], values, count);
+            else         BiquadAvx(sec.biquad, z, z + CH, values, count);
+            continue;
+        }
+#endif
+        if (sec.fir) FirScalar   (m_taps.data() + sec.tapOffset, sec.tapCount, z, sd.firPos[s], values, count);
+        else         BiquadScalar(sec.biquad, z, z + CH, values, count);
+    }
+}
+
+void CFilterBank::AppendRun(StateData& sd, const CDataPacket* samples, size_t count)
+{
+    Output& out = sd.pending;
+    if (out.size() + count > MAX_PENDING) {
+        const size_t drop = std::min(out.size(), out.size() + count - MAX_PENDING / 2);
+        out.x.erase(out.x.begin(), out.x.begin() + drop);
+        out.values.erase(out.values.begin(), out.values.begin() + drop * CH);
+    }
+
+    const size_t first = out.size();
+    out.x.resize(first + count);
+    out.values.resize((first + count) * CH);
+
+    double* v = out.values.data() + first * CH;
+    for (size_t i = 0; i < count; ++i) {
+        out.x[first + i] = samples[i].timeStamp;
+        for (size_t ch = 0; ch < CH; ++ch)
+            v[i * CH + ch] = static_cast<double>(samples[i].channel[ch]);
+    }
+
+    Run(sd, v, count);
+}
+
+void CFilterBank::Process(const CDecodedPacket& packet)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    switch (packet.kind)
+    {
+        case PacketKind::Block:
+        {
+            const CBlockPacket& block = packet.block;
+            uint32_t i = 0;
+            while (i < block.count) {
+                const uint32_t state = block.blockData[i].state;
+                uint32_t end = i + 1;
+                while (end < block.count && block.blockData[end].state == state) ++end;   // run of one state
+
+                if (state != CDataPacket::STATE_UNSET)
+                    AppendRun(FindOrAdd(state), block.blockData + i, end - i);
+                i = end;
+            }
+            break;
+        }
+
+        case PacketKind::Data:
+            if (packet.data.state != CDataPacket::STATE_UNSET)
+                AppendRun(FindOrAdd(packet.data.state), &packet.data, 1);
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool CFilterBank::Drain(uint32_t state, Output& out)
+{
+    out.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& sd : m_states) {
+        if (sd.state != state) continue;
+        std::swap(out, sd.pending);
+        return true;
+    }
+    return false;
+}
+
+void CFilterBank::Filter(uint32_t state, double* values, size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Run(FindOrAdd(state), values, count);
+}
+
+#pragma managed(pop)
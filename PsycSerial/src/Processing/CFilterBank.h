@@ -0,0 +1,91 @@
+#pragma once
+#pragma managed(push, off)
+
+#include "CPacketStage.h"
+
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+// Filter cascade over the A2D channels of every block sample: biquads (low-pass, high-pass, notch, DC blocker,
+// or raw coefficients) and FIR kernels, applied in the order they were added.  Filter state is kept per HeadState
+// and per channel; output accumulates per state until drained.  All 8 channels are filtered together, with AVX
+// when the CPU has it (checked at runtime) and a scalar path otherwise.
+class CFilterBank : public CPacketStage
+{
+public:
+    static constexpr size_t CHANNELS    = CDataPacket::A2D_NUM_CHANNELS;
+    static constexpr size_t MAX_PENDING = 1 << 14;   // samples per state; undrained output beyond this is dropped
+
+    // Normalised (a0 = 1) direct form II transposed section
+    struct Biquad {
+        double b0{ 1 }, b1{}, b2{}, a1{}, a2{};
+
+        // RBJ audio EQ cookbook designs; fs and f in Hz
+        static Biquad LowPass (double fs, double f, double q = 0.7071067811865476);
+        static Biquad HighPass(double fs, double f, double q = 0.7071067811865476);
+        static Biquad Notch   (double fs, double f, double q = 10.0);
+        // y[n] = x[n] - x[n-1] + r*y[n-1]
+        static Biquad DCBlocker(double r = 0.995);
+    };
+
+    struct Output {
+        std::vector<double> x;        // timestamp per sample
+        std::vector<double> values;   // CHANNELS per sample, interleaved
+
+        size_t size() const { return x.size(); }
+        void   clear() { x.clear(); values.clear(); }
+    };
+
+    CFilterBank() = default;
+
+    // Changing the cascade resets all filter state
+    void AddBiquad(const Biquad& section);
+    void AddFir(std::span<const double> taps);
+    void ClearSections();
+
+    void Process(const CDecodedPacket& packet) override;
+    void Reset() override;
+
+    // Moves the pending output for state into out (out is cleared first).  false if the state has not been seen.
+    bool Drain(uint32_t state, Output& out);
+
+    // Runs count interleaved samples for state through the cascade in place (what Process does per block)
+    void Filter(uint32_t state, double* values, size_t count);
+
+    void SetUseAvx(bool use) { m_useAvx = use && HasAvx(); }
+    bool GetUseAvx() const   { return m_useAvx; }
+
+    static bool HasAvx();
+    static void DoTest();
+
+private:
+    struct Section {
+        bool   fir;
+        Biquad biquad;
+        size_t tapOffset, tapCount;   // into m_taps
+    };
+
+    struct StateData {
+        uint32_t            state;
+        std::vector<double> z;        // per biquad: z1[CHANNELS], z2[CHANNELS]; per FIR: history of 2*taps rows
+        std::vector<size_t> firPos;   // per section (unused for biquads)
+        Output              pending;
+    };
+
+    std::mutex             m_mutex;
+    std::vector<Section>   m_sections;
+    std::vector<double>    m_taps;
+    std::vector<size_t>    m_zOffset;     // per section, into StateData::z
+    size_t                 m_zSize{};
+    std::vector<StateData> m_states;
+    bool                   m_useAvx{ HasAvx() };
+
+    void       Rebuild();
+    StateData& FindOrAdd(uint32_t state);
+    void       Run(StateData& sd, double* values, size_t count);
+    void       AppendRun(StateData& sd, const CDataPacket* samples, size_t count);
+};
+
+#pragma managed(pop)
@@ -0,0 +1,123 @@
+#include "CFilterBank.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <vector>
+
+
+constexpr size_t BLOCK   = CBlockPacket::MAX_BLOCK_SIZE;
+constexpr size_t BLOCKS  = 5'000;
+constexpr double FS      = 1e6 / 3050.0;   // one sample per STATE_DURATION_uS
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// Low-pass cascade, 50 + 60 Hz notches, DC blocker and a 31-tap windowed-sinc FIR
+static void Configure(CFilterBank& fb, double fs)
+{
+    fb.AddBiquad(CFilterBank::Biquad::DCBlocker(0.995));
+    fb.AddBiquad(CFilterBank::Biquad::Notch(fs, 50.0, 10.0));
+    fb.AddBiquad(CFilterBank::Biquad::Notch(fs, 60.0, 10.0));
+    fb.AddBiquad(CFilterBank::Biquad::LowPass(fs, fs / 8.0));
+    fb.AddBiquad(CFilterBank::Biquad::LowPass(fs, fs / 8.0));
+
+    constexpr size_t TAPS = 31;
+    std::vector<double> taps(TAPS);
+    double sum = 0.0;
+    for (size_t k = 0; k < TAPS; ++k) {
+        double m = k - (TAPS - 1) / 2.0;
+        double sinc = (m == 0.0) ? 1.0 : std::sin(std::numbers::pi * m / 4.0) / (std::numbers::pi * m / 4.0);
+        double hann = 0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * k / (TAPS - 1));
+        sum += taps[k] = sinc * hann;
+    }
+    for (double& t : taps) t /= sum;
+    fb.AddFir(taps);
+}
+
+static double Gain(double fs, double f)
+{
+    CFilterBank fb;
+    fb.AddBiquad(CFilterBank::Biquad::Notch(fs, 50.0, 10.0));
+    std::vector<double> v(4000 * CFilterBank::CHANNELS);
+    for (size_t i = 0; i < 4000; ++i)
+        for (size_t ch = 0; ch < CFilterBank::CHANNELS; ++ch)
+            v[i * CFilterBank::CHANNELS + ch] = std::sin(2.0 * std::numbers::pi * f * i / fs);
+    fb.Filter(1, v.data(), 4000);
+
+    double peak = 0.0;
+    for (size_t i = 3000; i < 4000; ++i) peak = std::max(peak, std::fabs(v[i * CFilterBank::CHANNELS]));
+    return peak;
+}
+
+
+void CFilterBank::DoTest()
+{
+    std::cout << "=== CFilterBank test ===\n";
+    std::cout << "AVX available: " << (HasAvx() ? "yes" : "no") << "\n";
+
+    // Notch sanity at 1 kHz sampling: 50 Hz is removed, 20 Hz passes
+    std::cout << "Notch 50 Hz @ 1 kHz: gain at 50 Hz " << Gain(1000.0, 50.0) << ", at 20 Hz " << Gain(1000.0, 20.0) << "\n";
+
+    // Full blocks of raw counts, two alternating head states, through Process()
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<uint32_t> counts(0, 4'000'000'000u);
+
+    auto* packets = new CDecodedPacket[2];
+    std::vector<CDataPacket> samples(2 * BLOCK);
+    for (size_t p = 0; p < 2; ++p) {
+        CBlockPacket& b = packets[p].block;
+        packets[p].kind = PacketKind::Block;
+        b = CBlockPacket{};
+        b.count = BLOCK;
+        b.blockData = samples.data() + p * BLOCK;
+        for (size_t i = 0; i < BLOCK; ++i) {
+            b.blockData[i].state = (p == 0) ? 0x1 : 0x10000;
+            b.blockData[i].timeStamp = static_cast<double>(i);
+            for (size_t ch = 0; ch < CHANNELS; ++ch) b.blockData[i].channel[ch] = counts(rng);
+        }
+    }
+
+    CFilterBank scalar, avx;
+    Configure(scalar, FS);
+    Configure(avx, FS);
+    scalar.SetUseAvx(false);
+    avx.SetUseAvx(true);
+
+    Output outScalar, outAvx;
+    double maxDiff = 0.0;
+    for (size_t n = 0; n < 200; ++n) {
+        scalar.Process(packets[n & 1]);
+        avx   .Process(packets[n & 1]);
+    }
+    for (uint32_t state : { 0x1u, 0x10000u }) {
+        scalar.Drain(state, outScalar);
+        avx   .Drain(state, outAvx);
+        for (size_t i = 0; i < outScalar.values.size() && i < outAvx.values.size(); ++i)
+            maxDiff = std::max(maxDiff, std::fabs(outScalar.values[i] - outAvx.values[i]));
+    }
+    std::cout << "Scalar vs " << (avx.GetUseAvx() ? "AVX" : "scalar") << " max difference: " << maxDiff << "\n";
+
+    auto run = [&](CFilterBank& fb) {
+        Output out;
+        double start = GetTime();
+        for (size_t n = 0; n < BLOCKS; ++n) {
+            fb.Process(packets[n & 1]);
+            if ((n & 63) == 63) { fb.Drain(0x1, out); fb.Drain(0x10000, out); }
+        }
+        return (GetTime() - start) * 1e9 / (BLOCKS * BLOCK);
+    };
+
+    double tScalar = run(scalar);
+    double tAvx    = run(avx);
+    double budget  = 1e9 / FS;   // ns available per sample in real time
+    std::cout << "Per sample (8 channels, 5 biquads + 31-tap FIR): scalar " << tScalar << " ns, "
+              << (avx.GetUseAvx() ? "AVX " : "scalar ") << tAvx << " ns;  real-time budget " << budget << " ns\n\n";
+
+    delete[] packets;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#pragma managed(push, off)
+
+#include "../Packets/CPackets.h"
+
+// Native processing hook.  Stages registered with CSerial::AddStage see every decoded packet on the read thread,
+// before it is converted and queued for managed callbacks.  packet is reused by the decoder, do not store.
+class CPacketStage
+{
+public:
+    virtual ~CPacketStage() = default;
+
+    virtual void Process(const CDecodedPacket& packet) = 0;
+
+    // true if the packet ends here: once every stage has seen it, it is not passed on to managed code
+    virtual bool Consumes(const CDecodedPacket&) const { return false; }
+
+    // Called when the serial stream is cleared
+    virtual void Reset() {}
+};
+
+#pragma managed(pop)
@@ -0,0 +1,134 @@
+#include "CSignalExtractor.h"
+#pragma managed(push, off)
+
+#include <algorithm>
+#include <limits>
+
+static constexpr double INF = std::numeric_limits<double>::infinity();
+
+
+CSignalExtractor::CSignalExtractor(size_t windowSize)
+    : m_window(windowSize ? windowSize : 1)
+    , m_sharedMin(INF)
+    , m_sharedMax(-INF)
+{ }
+
+
+void CSignalExtractor::Process(const CDecodedPacket& packet)
+{
+    if (packet.kind != PacketKind::Block || packet.block.count == 0) return;
+
+    // One point per block, its last sample, keyed by that sample's state: the window spans 512 blocks, as it
+    // always has, not 512 samples
+    const CDataPacket& sample = packet.block.blockData[packet.block.count - 1];
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t idx = FindOrAdd(sample.state);
+    AddSample(idx, sample);
+    UpdateShared(idx);
+}
+
+
+void CSignalExtractor::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_states.clear();
+    m_min.clear();
+    m_max.clear();
+    m_sharedMin =  INF;
+    m_sharedMax = -INF;
+}
+
+
+bool CSignalExtractor::Drain(uint32_t state, Series& out)
+{
+    out.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& sd : m_states) {
+        if (sd.state != state) continue;
+        std::swap(out, sd.pending);   // out was cleared, so pending restarts empty but keeps out's capacity
+        return true;
+    }
+    return false;
+}
+
+
+size_t CSignalExtractor::GetStates(std::span<uint32_t> out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t n = std::min(out.size(), m_states.size());
+    for (size_t i = 0; i < n; ++i) out[i] = m_states[i].state;
+    return m_states.size();
+}
+
+
+double CSignalExtractor::GetSharedMin() const { std::lock_guard<std::mutex> lock(m_mutex); return m_sharedMin; }
+double CSignalExtractor::GetSharedMax() const { std::lock_guard<std::mutex> lock(m_mutex); return m_sharedMax; }
+
+
+size_t CSignalExtractor::FindOrAdd(uint32_t state)
+{
+    for (size_t i = 0; i < m_states.size(); ++i)
+        if (m_states[i].state == state) return i;
+
+    m_states.push_back({ state, CRunningAverageMinMax(m_window), std::vector<double>(m_window, 0.0), 0, {} });
+    m_min.push_back( INF);
+    m_max.push_back(-INF);
+    return m_states.size() - 1;
+}
+
+
+void CSignalExtractor::AddSample(size_t idx, const CDataPacket& sample)
+{
+    StateData& sd = m_states[idx];
+
+    const double stage2Offset = static_cast<double>((sample.hardwareState >> 24) & 0xFF);
+    const double x = sample.timeStamp;
+    const double y = sample.channel[0] * SCALE_C0 + stage2Offset * DELTA_OFFSET2;
+
+    sd.ra.Add(y);
+    sd.x[sd.head] = x;
+    if (++sd.head == m_window) sd.head = 0;
+
+    Series& out = sd.pending;
+    if (out.x.size() >= MAX_PENDING) {
+        const size_t drop = MAX_PENDING / 2;
+        out.x  .erase(out.x  .begin(), out.x  .begin() + drop);
+        out.raw.erase(out.raw.begin(), out.raw.begin() + drop);
+        const size_t dropSignal = std::min(drop, out.signal.size());
+        out.signalX.erase(out.signalX.begin(), out.signalX.begin() + dropSignal);
+        out.signal .erase(out.signal .begin(), out.signal .begin() + dropSignal);
+    }
+
+    out.x  .push_back(x);
+    out.raw.push_back(y);
+
+    if (sd.ra.IsFull()) {
+        const size_t delay = (m_window - 1) / 2;
+        out.signalX.push_back(sd.x[(sd.head + delay) % m_window]);
+        out.signal .push_back(sd.ra.GetDelayed(m_window - 1 - delay) - sd.ra.GetAverage());
+    }
+}
+
+
+// Shared extremes only need a rescan when the state that held one moves away from it
+void CSignalExtractor::UpdateShared(size_t idx)
+{
+    const double oldMin = m_min[idx], newMin = m_states[idx].ra.GetMin();
+    const double oldMax = m_max[idx], newMax = m_states[idx].ra.GetMax();
+    m_min[idx] = newMin;
+    m_max[idx] = newMax;
+
+    if (newMin <= m_sharedMin)
+        m_sharedMin = newMin;
+    else if (oldMin == m_sharedMin)
+        m_sharedMin = *std::min_element(m_min.begin(), m_min.end());
+
+    if (newMax >= m_sharedMax)
+        m_sharedMax = newMax;
+    else if (oldMax == m_sharedMax)
+        m_sharedMax = *std::max_element(m_max.begin(), m_max.end());
+}
+
+#pragma managed(pop)
@@ -0,0 +1,68 @@
+#pragma once
+#pragma managed(push, off)
+
+#include "CPacketStage.h"
+#include "../CRunningAverage.h"
+
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+// Per-HeadState signal extraction, run natively on decoded blocks.  Each block contributes its last sample, to the
+// state that sample is in; each state keeps a window of timestamps plus running statistics, and produces the raw
+// series and the series detrended against the window mean (delayed by half a window so the mean is centred on the
+// sample).  Output accumulates per state until drained.  The min/max across all states is kept up to date
+// incrementally.
+class CSignalExtractor : public CPacketStage
+{
+public:
+    static constexpr double SCALE_C0      = 1.0 / 4660.100;
+    static constexpr double DELTA_OFFSET2 = 368.0;
+    static constexpr size_t MAX_PENDING   = 1 << 14;  // per state; undrained output beyond this is dropped (oldest first)
+
+    struct Series {
+        std::vector<double> x, raw;                   // one per block
+        std::vector<double> signalX, signal;          // once the window is full
+
+        void clear() { x.clear(); raw.clear(); signalX.clear(); signal.clear(); }
+    };
+
+    explicit CSignalExtractor(size_t windowSize = 512);
+
+    void Process(const CDecodedPacket& packet) override;
+    void Reset() override;
+
+    // Moves the pending output for state into out (out is cleared first).  false if the state has not been seen.
+    bool Drain(uint32_t state, Series& out);
+
+    // Copies the states seen so far into out, returns how many there are
+    size_t GetStates(std::span<uint32_t> out) const;
+
+    double GetSharedMin() const;
+    double GetSharedMax() const;
+    size_t GetWindowSize() const { return m_window; }
+
+    static void DoTest();
+
+private:
+    struct StateData {
+        uint32_t              state;
+        CRunningAverageMinMax ra;
+        std::vector<double>   x;       // timestamps, same ring position as the values in ra
+        size_t                head;
+        Series                pending;
+    };
+
+    mutable std::mutex     m_mutex;
+    size_t                 m_window;
+    std::vector<StateData> m_states;
+    std::vector<double>    m_min, m_max;         // per state, parallel to m_states
+    double                 m_sharedMin, m_sharedMax;
+
+    size_t FindOrAdd(uint32_t state);
+    void   AddSample(size_t idx, const CDataPacket& sample);
+    void   UpdateShared(size_t idx);
+};
+
+#pragma managed(pop)
@@ -0,0 +1,145 @@
+#include "CSignalExtractor.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+
+constexpr size_t   WINDOW = 512;
+constexpr uint32_t BLOCK  = CBlockPacket::MAX_BLOCK_SIZE;
+constexpr size_t   BLOCKS = 6'000;
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// What SignalExtractor.cs computed before the stage: the last sample of each block, per state, a 512 ring of x and
+// a running average of y, and once full the half-window-delayed y against the window mean
+struct Baseline {
+    struct State { std::vector<double> x, y; };
+    std::map<uint32_t, State>          states;
+    std::map<uint32_t, CSignalExtractor::Series> out;
+
+    void Block(const CBlockPacket& block)
+    {
+        const CDataPacket& s = block.blockData[block.count - 1];
+        const double x = s.timeStamp;
+        const double y = s.channel[0] * CSignalExtractor::SCALE_C0
+                       + static_cast<double>((s.hardwareState >> 24) & 0xFF) * CSignalExtractor::DELTA_OFFSET2;
+        State& st = states[s.state];
+        st.x.push_back(x);
+        st.y.push_back(y);
+
+        CSignalExtractor::Series& o = out[s.state];
+        o.x.push_back(x);
+        o.raw.push_back(y);
+        const size_t n = st.y.size();
+        if (n < WINDOW) return;
+        double mean = 0.0;
+        for (size_t i = n - WINDOW; i < n; ++i) mean += st.y[i];
+        mean /= WINDOW;
+        const size_t centre = n - WINDOW + (WINDOW - 1) / 2;
+        o.signalX.push_back(st.x[centre]);
+        o.signal .push_back(st.y[centre] - mean);
+    }
+
+    void MinMax(double& min, double& max) const
+    {
+        min = INFINITY; max = -INFINITY;
+        for (const auto& [state, st] : states)
+            for (size_t i = st.y.size() - std::min(st.y.size(), WINDOW); i < st.y.size(); ++i) {
+                min = std::min(min, st.y[i]);
+                max = std::max(max, st.y[i]);
+            }
+    }
+};
+
+static void Append(CSignalExtractor::Series& to, const CSignalExtractor::Series& from)
+{
+    to.x      .insert(to.x      .end(), from.x      .begin(), from.x      .end());
+    to.raw    .insert(to.raw    .end(), from.raw    .begin(), from.raw    .end());
+    to.signalX.insert(to.signalX.end(), from.signalX.begin(), from.signalX.end());
+    to.signal .insert(to.signal .end(), from.signal .begin(), from.signal .end());
+}
+
+static size_t Mismatches(const std::vector<double>& a, const std::vector<double>& b)
+{
+    if (a.size() != b.size()) return std::max(a.size(), b.size());
+    size_t bad = 0;
+    for (size_t i = 0; i < a.size(); ++i) bad += std::fabs(a[i] - b[i]) > 1e-9 * std::max(1.0, std::fabs(b[i]));
+    return bad;
+}
+
+
+void CSignalExtractor::DoTest()
+{
+    std::cout << "=== CSignalExtractor test ===\n";
+
+    std::mt19937 rng(3);
+    std::normal_distribution<double>    noise(0.0, 200.0);
+    std::uniform_int_distribution<int>  chance(0, 99);
+    const uint32_t STATES[] = { 0x11, 0x12, 0x21 };
+
+    // Blocks mostly of one state, cycling through three; now and then a block changes state part way through, so its
+    // last sample is not in the block's state.  Stage 2 offset steps every so often.
+    std::vector<CDataPacket> items(BLOCK);
+    CDecodedPacket p;
+    p.kind = PacketKind::Block;
+    p.block = CBlockPacket{ 0, 0.0, BLOCK, 0, items.data(), nullptr };
+
+    CSignalExtractor stage(WINDOW);
+    Baseline base;
+    std::map<uint32_t, Series> drained;
+    Series scratch;
+    uint64_t offset = 0;
+    double t = 0.0, level = 0.0;
+
+    double tStage = 0.0;
+    for (size_t b = 0; b < BLOCKS; ++b) {
+        const uint32_t state = STATES[b % 3];
+        const uint32_t split = chance(rng) < 10 ? BLOCK / 2 : BLOCK;
+        if (chance(rng) == 0) offset = (offset + 1) & 0xFF;
+        for (uint32_t i = 0; i < BLOCK; ++i) {
+            CDataPacket& s = items[i];
+            s.state         = i < split ? state : STATES[(b + 1) % 3];
+            s.timeStamp     = t += 3050e-6;
+            s.hardwareState = offset << 24;
+            level += noise(rng) * 0.01;
+            s.channel[0] = static_cast<uint32_t>(2'000'000 + level + noise(rng));
+        }
+        p.block.state = state;
+
+        const double start = GetTime();
+        stage.Process(p);
+        tStage += GetTime() - start;
+        base.Block(p.block);
+
+        // The first state drains after every block, the second every 50, the third only at the end
+        for (uint32_t s : { STATES[0], STATES[1] })
+            if (s == STATES[0] || b % 50 == 49)
+                if (stage.Drain(s, scratch)) Append(drained[s], scratch);
+    }
+    if (stage.Drain(STATES[1], scratch)) Append(drained[STATES[1]], scratch);
+    if (stage.Drain(STATES[2], scratch)) Append(drained[STATES[2]], scratch);
+
+    for (uint32_t s : STATES) {
+        const Series& got = drained[s];
+        const Series& want = base.out[s];
+        std::cout << "State 0x" << std::hex << s << std::dec << ": " << got.raw.size() << " points (baseline "
+                  << want.raw.size() << "), " << got.signal.size() << " signal, mismatches raw "
+                  << Mismatches(got.x, want.x) + Mismatches(got.raw, want.raw) << ", signal "
+                  << Mismatches(got.signalX, want.signalX) + Mismatches(got.signal, want.signal) << "\n";
+    }
+
+    double min, max;
+    base.MinMax(min, max);
+    std::cout << "Shared min/max: " << (stage.GetSharedMin() == min && stage.GetSharedMax() == max ? "match" : "DIFFER")
+              << " the baseline's rescan; " << tStage / BLOCKS * 1e9 << " ns/block\n";
+    std::cout << "\n";
+}
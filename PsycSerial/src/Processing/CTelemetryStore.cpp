@@ -0,0 +1,147 @@
+#include "CTelemetryStore.h"
+#pragma managed(push, off)
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+
+CTelemetryStore::CTelemetryStore()
+{
+    std::fill(std::begin(m_index), std::end(m_index), EMPTY);
+}
+
+bool CTelemetryStore::Consumes(const CDecodedPacket& packet) const
+{
+    return (packet.kind == PacketKind::Telemetry || packet.kind == PacketKind::TelemetryBatch) && GetConsume();
+}
+
+void CTelemetryStore::Process(const CDecodedPacket& packet)
+{
+    if (packet.kind == PacketKind::TelemetryBatch) {
+        const CTelemetryBatch& b = packet.telemetryBatch;
+        Update(std::span<const CTelemetryEntry>(b.entries, b.count), b.timeStamp);
+        return;
+    }
+
+    if (packet.kind != PacketKind::Telemetry) return;
+    const CTelemetryPacket& t = packet.telemetry;
+    if (t.key == 0) return;
+
+    Update(t.key, t.value, t.timeStamp);
+}
+
+uint64_t CTelemetryStore::BeginWrite()
+{
+    // Making the sequence odd also locks out other writers (Clear from the UI against the read thread)
+    uint64_t seq = m_seq.load(std::memory_order_relaxed);
+    for (;;) {
+        if (!(seq & 1) && m_seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            break;
+        if (seq & 1) {
+            std::this_thread::yield();
+            seq = m_seq.load(std::memory_order_relaxed);
+        }
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return seq;
+}
+
+size_t CTelemetryStore::Find(uint32_t key)
+{
+    for (size_t slot = Slot(key);; slot = (slot + 1) & (TABLE_SIZE - 1)) {
+        const uint16_t i = m_index[slot];
+        if (i == EMPTY) {
+            const uint32_t n = m_count.load(std::memory_order_relaxed);
+            if (n == MAX_KEYS) return MAX_KEYS;
+            m_index[slot] = static_cast<uint16_t>(n);
+            return n;
+        }
+        if (m_entries[i].key == key) return i;
+    }
+}
+
+void CTelemetryStore::Update(uint32_t key, float value, double timeStamp)
+{
+    const uint64_t seq = BeginWrite();
+    Apply(key, value, timeStamp);
+    m_seq.store(seq + 2, std::memory_order_release);
+}
+
+void CTelemetryStore::Update(std::span<const CTelemetryEntry> entries, double timeStamp)
+{
+    if (entries.empty()) return;
+
+    // Readers see the whole batch or none of it
+    const uint64_t seq = BeginWrite();
+    for (const CTelemetryEntry& e : entries)
+        if (e.key != 0) Apply(e.key, e.value, timeStamp);
+    m_seq.store(seq + 2, std::memory_order_release);
+}
+
+void CTelemetryStore::Apply(uint32_t key, float value, double timeStamp)
+{
+    const size_t i = Find(key);
+    if (i == MAX_KEYS) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Entry&  e = m_entries[i];
+    Window& w = m_windows[i];
+    const uint32_t n = m_count.load(std::memory_order_relaxed);
+    if (i == n) {
+        e = Entry{ key, value, value, value };
+        w = Window{};
+        m_count.store(n + 1, std::memory_order_relaxed);
+    }
+    else {
+        e.value = value;
+        e.min   = std::min(e.min, value);
+        e.max   = std::max(e.max, value);
+    }
+    e.count++;
+    e.timeStamp = timeStamp;
+
+    // Rate over whole windows of device time; a clock that steps back (device reset) starts a new window
+    if (w.start < 0.0 || timeStamp < w.start) {
+        w = Window{ timeStamp, e.count };
+    }
+    else if (timeStamp - w.start >= RATE_WINDOW) {
+        e.rate = static_cast<double>(e.count - w.count) / (timeStamp - w.start);
+        w = Window{ timeStamp, e.count };
+    }
+}
+
+void CTelemetryStore::Clear()
+{
+    const uint64_t seq = BeginWrite();
+
+    std::fill(std::begin(m_index), std::end(m_index), EMPTY);
+    m_count.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+
+    m_seq.store(seq + 2, std::memory_order_release);
+}
+
+size_t CTelemetryStore::Snapshot(std::span<Entry> out, uint64_t& version) const
+{
+    for (unsigned spins = 0;; ++spins) {
+        const uint64_t before = m_seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            if (spins > 64) std::this_thread::yield();
+            continue;
+        }
+
+        const size_t n = std::min<size_t>(m_count.load(std::memory_order_relaxed), out.size());
+        if (n) std::memcpy(out.data(), m_entries, n * sizeof(Entry));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_seq.load(std::memory_order_relaxed) == before) {
+            version = before;
+            return n;
+        }
+    }
+}
+
+#pragma managed(pop)
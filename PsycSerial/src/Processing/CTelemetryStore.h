@@ -0,0 +1,75 @@
+#pragma once
+#pragma managed(push, off)
+
+#include "CPacketStage.h"
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+// Latest state of every telemetry key (group, subGroup, id packed as in CTelemetryPacket::key), kept natively so
+// individual telemetry packets need not cross into managed code.  Entries are dense, in order of first arrival,
+// found through an open-addressing index.  Writers hold the sequence odd while they update; readers copy a
+// consistent snapshot under that seqlock (retrying if an update lands mid-copy) and never block the read thread.
+class CTelemetryStore : public CPacketStage
+{
+public:
+    static constexpr size_t MAX_KEYS    = 256;
+    static constexpr size_t TABLE_SIZE  = 2 * MAX_KEYS;  // power of two, at most half full
+    static constexpr double RATE_WINDOW = 0.5;           // seconds of device time per rate update
+
+    struct Entry {
+        uint32_t key{};
+        float    value{};          // last
+        float    min{}, max{};
+        uint64_t count{};
+        double   timeStamp{};      // device time of the last update, seconds
+        double   rate{};           // updates per second over the last full window
+    };
+
+    CTelemetryStore();
+
+    void Process(const CDecodedPacket& packet) override;
+    bool Consumes(const CDecodedPacket& packet) const override;
+
+    void Update(uint32_t key, float value, double timeStamp);
+    void Update(std::span<const CTelemetryEntry> entries, double timeStamp);  // one write for the whole batch
+    void Clear();
+
+    // Telemetry is kept from the managed DataReceived path while set (default)
+    void SetConsume(bool consume) { m_consume.store(consume, std::memory_order_relaxed); }
+    bool GetConsume() const       { return m_consume.load(std::memory_order_relaxed); }
+
+    // Copies up to out.size() entries, returns how many.  version identifies the copy; it only changes on update.
+    size_t   Snapshot(std::span<Entry> out, uint64_t& version) const;
+    uint64_t GetVersion() const { return m_seq.load(std::memory_order_acquire) & ~uint64_t(1); }
+    size_t   GetDropped() const { return m_dropped.load(std::memory_order_relaxed); }  // updates for keys past MAX_KEYS
+
+    static void DoTest();
+
+private:
+    static constexpr uint16_t EMPTY = 0xFFFF;
+
+    struct Window {
+        double   start{ -1.0 };
+        uint64_t count{};
+    };
+
+    std::atomic<uint64_t> m_seq{};                // odd while a writer is in
+    std::atomic<uint32_t> m_count{};
+    std::atomic<bool>     m_consume{ true };
+    std::atomic<size_t>   m_dropped{};
+
+    Entry    m_entries[MAX_KEYS];
+    Window   m_windows[MAX_KEYS];                 // writer only
+    uint16_t m_index[TABLE_SIZE];                 // writer only
+
+    static size_t Slot(uint32_t key) { return (key * 0x9E37'79B1u) >> (32 - 9); }
+    static_assert(TABLE_SIZE == size_t(1) << 9, "Slot() assumes 512 slots");
+
+    uint64_t BeginWrite();                        // returns the even sequence before; end by storing it + 2
+    size_t   Find(uint32_t key);                  // entry index for key, inserting it; MAX_KEYS if full
+    void     Apply(uint32_t key, float value, double timeStamp);  // inside a write
+};
+
+#pragma managed(pop)
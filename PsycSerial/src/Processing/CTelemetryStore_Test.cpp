@@ -0,0 +1,158 @@
+#include "CTelemetryStore.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+constexpr size_t KEYS    = 40;
+constexpr size_t MILLIS  = 100'000;   // 100 s of device time
+
+static double GetTime()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+static uint32_t MakeKey(size_t k)
+{
+    const uint32_t group = 0x11 + static_cast<uint32_t>(k % 5), subGroup = static_cast<uint32_t>(k / 5), id = 0x100 + static_cast<uint32_t>(k);
+    return group | (subGroup << 8) | (id << 16);
+}
+
+struct TeleUpdate { uint32_t key; float value; double timeStamp; };
+
+// Key k reports every k + 1 ms, its value counting up from 1, so a consistent entry has value == max == count
+static std::vector<TeleUpdate> MakeUpdates()
+{
+    std::vector<TeleUpdate> updates;
+    std::vector<float> next(KEYS, 1.0f);
+    for (size_t ms = 0; ms < MILLIS; ++ms)
+        for (size_t k = 0; k < KEYS; ++k)
+            if (ms % (k + 1) == 0) {
+                updates.push_back({ MakeKey(k), next[k], ms * 1e-3 });
+                next[k] += 1.0f;
+            }
+    return updates;
+}
+
+static void Feed(CTelemetryStore& store, const std::vector<TeleUpdate>& updates)
+{
+    for (const TeleUpdate& u : updates) store.Update(u.key, u.value, u.timeStamp);
+}
+
+// The same updates as the firmware batches them: everything sampled in one millisecond in one frame
+static void FeedBatched(CTelemetryStore& store, const std::vector<TeleUpdate>& updates)
+{
+    std::vector<CTelemetryEntry> batch;
+    for (size_t u = 0; u < updates.size();) {
+        const double timeStamp = updates[u].timeStamp;
+        batch.clear();
+        for (; u < updates.size() && updates[u].timeStamp == timeStamp; ++u) batch.push_back({ updates[u].key, updates[u].value });
+        store.Update(batch, timeStamp);
+    }
+}
+
+
+void CTelemetryStore::DoTest()
+{
+    std::cout << "=== CTelemetryStore test ===\n";
+
+    // Single-threaded: contents, rates and cost per update
+    const std::vector<TeleUpdate> updates = MakeUpdates();
+    auto* store = new CTelemetryStore();
+    double start = GetTime();
+    Feed(*store, updates);
+    const double tStore = GetTime() - start;
+
+    std::vector<Entry> snap(MAX_KEYS);
+    uint64_t version = 0;
+    snap.resize(store->Snapshot(snap, version));
+
+    double worstRate = 0.0;
+    size_t inconsistent = 0;
+    for (size_t k = 0; k < snap.size(); ++k) {
+        const Entry& e = snap[k];
+        const double expected = 1000.0 / (k + 1);
+        worstRate = std::max(worstRate, std::fabs(e.rate - expected) / expected);
+        inconsistent += (e.key != MakeKey(k) || e.value != e.max || e.min != 1.0f || double(e.count) != e.value);
+    }
+    std::cout << snap.size() << " keys, " << updates.size() << " updates, inconsistent " << inconsistent
+              << ", worst rate error " << worstRate * 100.0 << " %\n";
+    std::cout << tStore / updates.size() * 1e9 << " ns/update\n";
+
+    // Batched: same contents, one write per batch
+    auto* batched = new CTelemetryStore();
+    start = GetTime();
+    FeedBatched(*batched, updates);
+    const double tBatched = GetTime() - start;
+
+    std::vector<Entry> batchSnap(MAX_KEYS);
+    uint64_t batchVersion = 0;
+    batchSnap.resize(batched->Snapshot(batchSnap, batchVersion));
+    const bool same = batchSnap.size() == snap.size() && std::memcmp(batchSnap.data(), snap.data(), snap.size() * sizeof(Entry)) == 0;
+    std::cout << "Batched: same entries " << (same ? "yes" : "no") << ", " << tBatched / updates.size() * 1e9 << " ns/update\n";
+
+    // Version only moves on update
+    uint64_t again = 0;
+    store->Snapshot(snap, again);
+    std::cout << "Version stable without updates: " << (again == version ? "yes" : "no") << "\n";
+
+    // Keys beyond capacity are dropped, not stored
+    snap.resize(MAX_KEYS);
+    store->Clear();
+    for (uint32_t k = 1; k <= MAX_KEYS + 44; ++k) store->Update(k, 1.0f, 0.0);
+    std::cout << "Overfull: " << store->Snapshot(snap, version) << " keys, dropped " << store->GetDropped() << "\n";
+
+    // A reader snapshotting while the writer runs must never see a torn entry
+    std::atomic<bool> done{ false };
+    size_t snapshots = 0, torn = 0;
+    std::thread reader([&] {
+        std::vector<Entry> s(MAX_KEYS);
+        uint64_t v = 0;
+        while (!done.load()) {
+            const size_t n = store->Snapshot(s, v);
+            for (size_t i = 0; i < n; ++i)
+                torn += (s[i].value != s[i].max || double(s[i].count) != s[i].value);
+            ++snapshots;
+        }
+    });
+    for (size_t round = 0; round < 20; ++round) {
+        store->Clear();
+        Feed(*store, updates);
+    }
+    done = true;
+    reader.join();
+    std::cout << "Concurrent: " << snapshots << " snapshots, torn entries " << torn << "\n";
+
+    // A batch lands whole: every key is in each batch here, so a snapshot never mixes two batches' times
+    done = false;
+    snapshots = torn = 0;
+    std::vector<CTelemetryEntry> batch(KEYS);
+    batched->Clear();
+    std::thread batchReader([&] {
+        std::vector<Entry> s(MAX_KEYS);
+        uint64_t v = 0;
+        while (!done.load()) {
+            const size_t n = batched->Snapshot(s, v);
+            for (size_t i = 1; i < n; ++i)
+                torn += (s[i].timeStamp != s[0].timeStamp);
+            ++snapshots;
+        }
+    });
+    for (size_t ms = 0; ms < 20 * MILLIS; ++ms) {
+        for (size_t k = 0; k < KEYS; ++k) batch[k] = CTelemetryEntry{ MakeKey(k), float(ms) };
+        batched->Update(batch, ms * 1e-3);
+    }
+    done = true;
+    batchReader.join();
+    std::cout << "Concurrent batches: " << snapshots << " snapshots, mixed batches " << torn << "\n";
+    std::cout << "\n";
+
+    delete batched;
+    delete store;
+}
@@ -0,0 +1,38 @@
+#include "ClockSyncStage.h"
+
+namespace PsycSerial::Processing
+{
+    ClockSyncStage::ClockSyncStage()
+        : PacketStage(new CClockSync())
+    { }
+
+    void ClockSyncStage::GetFit(ClockFit^ into)
+    {
+        if (into == nullptr) throw gcnew ArgumentNullException("into");
+
+        const CClockSync::Fit fit = Native()->GetFit();
+        into->DeviceOrigin = fit.deviceOrigin;
+        into->HostOriginNs = fit.hostOriginNs;
+        into->Rate         = fit.rate;
+        into->Points       = static_cast<int>(fit.points);
+    }
+
+    void ClockSyncStage::GetStats(ClockSyncStats^ into)
+    {
+        if (into == nullptr) throw gcnew ArgumentNullException("into");
+
+        const CClockSync::Stats s = Native()->GetStats();
+        into->Frames       = s.frames;
+        into->Points       = static_cast<int>(s.points);
+        into->Restarts     = static_cast<int>(s.restarts);
+        into->DriftPpm     = s.driftPpm;
+        into->Span         = s.span;
+        into->EnvelopeRms  = s.envelopeRms;
+        into->ResidualMean = s.residualMean;
+        into->ResidualMax  = s.residualMax;
+    }
+
+    void ClockSyncStage::Clear() { Native()->Reset(); }
+
+    Int64 ClockSyncStage::ToHostNs(double deviceTime) { return Native()->GetFit().ToHostNs(deviceTime); }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "PacketStage.h"
+#include "CClockSync.h"
+
+using namespace System;
+
+namespace PsycSerial::Processing
+{
+    // Device time to host time (CHostClock ns, as IPacket::ArrivalNs): a copy of the current fit.  Take one per
+    // block and map each sample's TimeStamp with it.
+    public ref class ClockFit
+    {
+    public:
+        double DeviceOrigin = 0.0;
+        Int64  HostOriginNs = 0;
+        double Rate         = 1.0;
+        int    Points       = 0;     // 0 = nothing to map with yet
+
+        Int64  ToHostNs(double deviceTime) { return HostOriginNs + static_cast<Int64>((deviceTime - DeviceOrigin) * Rate * 1e9); }
+        property double DriftPpm { double get() { return (Rate - 1.0) * 1e6; } }
+        property bool   IsValid  { bool   get() { return Points != 0; } }
+    };
+
+    // Quality of the fit.  Times in seconds.
+    public ref class ClockSyncStats
+    {
+    public:
+        UInt64 Frames       = 0;
+        int    Points       = 0;
+        int    Restarts     = 0;
+        double DriftPpm     = 0.0;
+        double Span         = 0.0;
+        double EnvelopeRms  = 0.0;
+        double ResidualMean = 0.0;
+        double ResidualMax  = 0.0;
+    };
+
+    public ref class ClockSyncStage sealed : PacketStage
+    {
+    public:
+        ClockSyncStage();
+
+        void GetFit(ClockFit^ into);
+        void GetStats(ClockSyncStats^ into);
+        void Clear();
+
+        // One at a time; GetFit once for many
+        Int64 ToHostNs(double deviceTime);
+
+        static void DoTest() { CClockSync::DoTest(); }
+
+    private:
+        CClockSync* Native() { ThrowIfDisposed(); return static_cast<CClockSync*>(m_stage); }
+    };
+}
@@ -0,0 +1,53 @@
+#include "EventAnalyzerStage.h"
+#include "../_Config.h"
+
+namespace PsycSerial::Processing
+{
+    EventAnalyzerStage::EventAnalyzerStage()
+        : PacketStage(new CEventAnalyzer())
+    {
+        UpdateTiming();
+    }
+
+    void EventAnalyzerStage::UpdateTiming()
+    {
+        Native()->SetTiming(Config::A2D_READING_PERIOD_uS * 1e-6, Config::POT_UPDATE_OFFSET_uS * 1e-6);
+    }
+
+    void EventAnalyzerStage::Clear() { Native()->Clear(); }
+
+
+    static void CopyOut(const CEventAnalyzer::Histogram& src, EventHistogram^ dst)
+    {
+        dst->BinWidth = src.binWidth;
+        dst->Overflow = src.overflow;
+        dst->Count    = src.count;
+        dst->Mean     = src.Mean();
+        dst->Min      = src.min;
+        dst->Max      = src.max;
+        for (int i = 0; i < dst->Bins->Length; ++i) dst->Bins[i] = src.bins[i];
+    }
+
+    bool EventAnalyzerStage::GetTiming(EventKind kind, EventTiming^ into)
+    {
+        if (into == nullptr) throw gcnew ArgumentNullException("into");
+
+        CEventAnalyzer::Kind native;
+        bool isStart;
+        if (!CEventAnalyzer::KindOf(static_cast<uint32_t>(kind), native, isStart)) return false;
+
+        CEventAnalyzer::Stats stats;
+        Native()->GetStats(native, stats);
+
+        into->Pairs           = stats.pairs;
+        into->Overruns        = stats.overruns;
+        into->LongIntervals   = stats.longIntervals;
+        into->OrphanStarts    = stats.orphanStarts;
+        into->OrphanCompletes = stats.orphanCompletes;
+        into->Limit           = stats.limit;
+        into->Nominal         = stats.nominal;
+        CopyOut(stats.duration, into->Duration);
+        CopyOut(stats.interval, into->Interval);
+        return true;
+    }
+}
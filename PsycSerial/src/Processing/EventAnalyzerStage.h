@@ -0,0 +1,57 @@
+#pragma once
+
+#include "PacketStage.h"
+#include "CEventAnalyzer.h"
+#include "../Packets/Packets.h"
+
+using namespace System;
+
+namespace PsycSerial::Processing
+{
+    // Fixed-bin histogram of event times, in seconds.  Bins covers [0, Bins->Length * BinWidth).
+    public ref class EventHistogram
+    {
+    public:
+        double           BinWidth = 0.0;
+        array<UInt32>^   Bins     = gcnew array<UInt32>(static_cast<int>(CEventAnalyzer::Histogram::BINS));
+        UInt32           Overflow = 0;
+        UInt64           Count    = 0;
+        double           Mean     = 0.0;
+        double           Min      = 0.0;
+        double           Max      = 0.0;
+    };
+
+    // Snapshot of one event kind.  Limit / Nominal in seconds; Limit is 0 for kinds without a duration.
+    public ref class EventTiming
+    {
+    public:
+        UInt64 Pairs           = 0;
+        UInt64 Overruns        = 0;
+        UInt64 LongIntervals   = 0;
+        UInt64 OrphanStarts    = 0;
+        UInt64 OrphanCompletes = 0;
+        double Limit           = 0.0;
+        double Nominal         = 0.0;
+
+        EventHistogram^ Duration = gcnew EventHistogram();
+        EventHistogram^ Interval = gcnew EventHistogram();
+    };
+
+    public ref class EventAnalyzerStage sealed : PacketStage
+    {
+    public:
+        EventAnalyzerStage();
+
+        // Re-reads the limits from Config (after a handshake) and clears the statistics
+        void UpdateTiming();
+        void Clear();
+
+        // kind may be either event of a pair (A2D_READ_START or A2D_READ_COMPLETE, ...).  false for NONE.
+        bool GetTiming(EventKind kind, EventTiming^ into);
+
+        static void DoTest() { CEventAnalyzer::DoTest(); }
+
+    private:
+        CEventAnalyzer* Native() { ThrowIfDisposed(); return static_cast<CEventAnalyzer*>(m_stage); }
+    };
+}
@@ -0,0 +1,62 @@
+#include "FilterBankStage.h"
+
+using namespace System::Runtime::InteropServices;
+
+namespace PsycSerial::Processing
+{
+    FilterBankStage::FilterBankStage()
+        : PacketStage(new CFilterBank())
+        , m_scratch(new CFilterBank::Output())
+    { }
+
+    FilterBankStage::~FilterBankStage() { this->!FilterBankStage(); }
+
+    FilterBankStage::!FilterBankStage() { delete m_scratch; m_scratch = nullptr; }
+
+
+    void FilterBankStage::AddLowPass  (double fs, double f, double q) { Native()->AddBiquad(CFilterBank::Biquad::LowPass (fs, f, q)); }
+    void FilterBankStage::AddHighPass (double fs, double f, double q) { Native()->AddBiquad(CFilterBank::Biquad::HighPass(fs, f, q)); }
+    void FilterBankStage::AddNotch    (double fs, double f, double q) { Native()->AddBiquad(CFilterBank::Biquad::Notch   (fs, f, q)); }
+    void FilterBankStage::AddDCBlocker(double r)                      { Native()->AddBiquad(CFilterBank::Biquad::DCBlocker(r));        }
+
+    void FilterBankStage::AddBiquad(double b0, double b1, double b2, double a1, double a2)
+    {
+        Native()->AddBiquad({ b0, b1, b2, a1, a2 });
+    }
+
+    void FilterBankStage::AddFir(array<double>^ taps)
+    {
+        if (taps == nullptr) throw gcnew ArgumentNullException("taps");
+        if (taps->Length == 0) return;
+
+        pin_ptr<double> p = &taps[0];
+        Native()->AddFir(std::span<const double>(p, static_cast<size_t>(taps->Length)));
+    }
+
+    void FilterBankStage::ClearSections() { Native()->ClearSections(); }
+
+
+    static void CopyOut(const std::vector<double>& src, array<double>^% dst)
+    {
+        const int n = static_cast<int>(src.size());
+        if (dst->Length < n) Array::Resize(dst, n);
+        if (n > 0) Marshal::Copy(IntPtr(const_cast<double*>(src.data())), dst, 0, n);
+    }
+
+    bool FilterBankStage::Drain(HeadState state, FilteredSeries^ into)
+    {
+        if (into == nullptr) throw gcnew ArgumentNullException("into");
+        if (!Native()->Drain(static_cast<uint32_t>(state), *m_scratch)) {
+            into->Count = 0;
+            return false;
+        }
+
+        CopyOut(m_scratch->x     , into->X     );
+        CopyOut(m_scratch->values, into->Values);
+        into->Count = static_cast<int>(m_scratch->size());
+        return true;
+    }
+
+    bool FilterBankStage::UseAvx::get()           { return Native()->GetUseAvx(); }
+    void FilterBankStage::UseAvx::set(bool value) { Native()->SetUseAvx(value); }
+}
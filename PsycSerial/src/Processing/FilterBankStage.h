@@ -0,0 +1,54 @@
+#pragma once
+
+#include "PacketStage.h"
+#include "CFilterBank.h"
+#include "../Packets/Packets.h"
+
+using namespace System;
+
+namespace PsycSerial::Processing
+{
+    // One drain's worth of filtered samples for a state.  Values holds Channels doubles per sample (interleaved);
+    // arrays only grow, so reuse the same instance between drains.
+    public ref class FilteredSeries
+    {
+    public:
+        static const int Channels = static_cast<int>(CFilterBank::CHANNELS);
+
+        array<double>^ X      = gcnew array<double>(0);
+        array<double>^ Values = gcnew array<double>(0);
+        int            Count  = 0;
+
+        double Get(int sample, int channel) { return Values[sample * Channels + channel]; }
+    };
+
+    public ref class FilterBankStage sealed : PacketStage
+    {
+    public:
+        FilterBankStage();
+        ~FilterBankStage();
+        !FilterBankStage();
+
+        // Sections run in the order added; changing the cascade resets all filter state.  Frequencies in Hz.
+        void AddLowPass  (double sampleRate, double cutoff, double q);
+        void AddHighPass (double sampleRate, double cutoff, double q);
+        void AddNotch    (double sampleRate, double frequency, double q);
+        void AddDCBlocker(double r);
+        void AddBiquad   (double b0, double b1, double b2, double a1, double a2);
+        void AddFir      (array<double>^ taps);
+        void ClearSections();
+
+        // Moves everything filtered for state since the last drain into into.  false if the state has not been seen.
+        bool Drain(HeadState state, FilteredSeries^ into);
+
+        property bool UseAvx { bool get(); void set(bool value); }
+
+        static property bool HasAvx { bool get() { return CFilterBank::HasAvx(); } }
+        static void DoTest() { CFilterBank::DoTest(); }
+
+    private:
+        CFilterBank* Native() { ThrowIfDisposed(); return static_cast<CFilterBank*>(m_stage); }
+
+        CFilterBank::Output* m_scratch = nullptr;
+    };
+}
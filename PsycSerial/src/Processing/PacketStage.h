@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CPacketStage.h"
+
+using namespace System;
+
+namespace PsycSerial::Processing
+{
+    // Managed owner of a native CPacketStage.  Register with SerialHelper::AddStage; remove it again before
+    // disposing (SerialHelper::RemoveStage waits for the read thread to leave the stage).
+    public ref class PacketStage abstract
+    {
+    internal:
+        CPacketStage* NativeStage() { return m_stage; }
+
+    protected:
+        CPacketStage* m_stage = nullptr;   // owned
+
+        PacketStage(CPacketStage* stage) : m_stage(stage) {}
+
+        void ThrowIfDisposed() { if (!m_stage) throw gcnew ObjectDisposedException(GetType()->Name); }
+
+    public:
+        ~PacketStage() { this->!PacketStage(); }
+        !PacketStage() { delete m_stage; m_stage = nullptr; }
+    };
+}
@@ -0,0 +1,56 @@
+#include "SignalExtractorStage.h"
+
+using namespace System::Runtime::InteropServices;
+
+namespace PsycSerial::Processing
+{
+    SignalExtractorStage::SignalExtractorStage(int windowSize)
+        : PacketStage(new CSignalExtractor(windowSize > 0 ? static_cast<size_t>(windowSize) : 1))
+        , m_scratch(new CSignalExtractor::Series())
+    { }
+
+    SignalExtractorStage::~SignalExtractorStage() { this->!SignalExtractorStage(); }
+
+    SignalExtractorStage::!SignalExtractorStage() { delete m_scratch; m_scratch = nullptr; }
+
+
+    static void CopyOut(const std::vector<double>& src, array<double>^% dst)
+    {
+        const int n = static_cast<int>(src.size());
+        if (dst->Length < n) Array::Resize(dst, n);
+        if (n > 0) Marshal::Copy(IntPtr(const_cast<double*>(src.data())), dst, 0, n);
+    }
+
+    bool SignalExtractorStage::Drain(HeadState state, SignalSeries^ into)
+    {
+        if (into == nullptr) throw gcnew ArgumentNullException("into");
+        if (!Native()->Drain(static_cast<uint32_t>(state), *m_scratch)) {
+            into->RawCount = into->SignalCount = 0;
+            return false;
+        }
+
+        CopyOut(m_scratch->x      , into->X      );
+        CopyOut(m_scratch->raw    , into->Raw    );
+        CopyOut(m_scratch->signalX, into->SignalX);
+        CopyOut(m_scratch->signal , into->Signal );
+        into->RawCount    = static_cast<int>(m_scratch->x.size());
+        into->SignalCount = static_cast<int>(m_scratch->signal.size());
+        return true;
+    }
+
+    array<HeadState>^ SignalExtractorStage::States::get()
+    {
+        std::vector<uint32_t> states(16);
+        size_t n;
+        while ((n = Native()->GetStates(states)) > states.size())
+            states.resize(n);
+
+        auto result = gcnew array<HeadState>(static_cast<int>(n));
+        for (size_t i = 0; i < n; ++i) result[static_cast<int>(i)] = static_cast<HeadState>(states[i]);
+        return result;
+    }
+
+    double SignalExtractorStage::SharedMin::get()  { return Native()->GetSharedMin(); }
+    double SignalExtractorStage::SharedMax::get()  { return Native()->GetSharedMax(); }
+    int    SignalExtractorStage::WindowSize::get() { return static_cast<int>(Native()->GetWindowSize()); }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "PacketStage.h"
+#include "CSignalExtractor.h"
+#include "../Packets/Packets.h"
+
+using namespace System;
+
+namespace PsycSerial::Processing
+{
+    // One drain's worth of output for a state.  Arrays only grow, so reuse the same instance between drains.
+    public ref class SignalSeries
+    {
+    public:
+        array<double>^ X       = gcnew array<double>(0);
+        array<double>^ Raw     = gcnew array<double>(0);
+        array<double>^ SignalX = gcnew array<double>(0);
+        array<double>^ Signal  = gcnew array<double>(0);
+
+        int RawCount    = 0;
+        int SignalCount = 0;
+    };
+
+    public ref class SignalExtractorStage sealed : PacketStage
+    {
+    public:
+        SignalExtractorStage(int windowSize);
+        ~SignalExtractorStage();
+        !SignalExtractorStage();
+
+        // Moves everything produced for state since the last drain into into.  false if the state has not been seen.
+        bool Drain(HeadState state, SignalSeries^ into);
+
+        property array<HeadState>^ States     { array<HeadState>^ get(); }
+        property double            SharedMin  { double get(); }
+        property double            SharedMax  { double get(); }
+        property int               WindowSize { int get(); }
+
+    private:
+        CSignalExtractor* Native() { ThrowIfDisposed(); return static_cast<CSignalExtractor*>(m_stage); }
+
+        CSignalExtractor::Series* m_scratch = nullptr;
+    };
+}
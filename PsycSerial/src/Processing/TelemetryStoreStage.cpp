@@ -0,0 +1,57 @@
+#include "TelemetryStoreStage.h"
+
+namespace PsycSerial::Processing
+{
+    TelemetryStoreStage::TelemetryStoreStage()
+        : PacketStage(new CTelemetryStore())
+        , m_scratch(new CTelemetryStore::Entry[CTelemetryStore::MAX_KEYS])
+    { }
+
+    TelemetryStoreStage::~TelemetryStoreStage() { this->!TelemetryStoreStage(); }
+
+    TelemetryStoreStage::!TelemetryStoreStage() { delete[] m_scratch; m_scratch = nullptr; }
+
+
+    template<typename T>
+    static void Grow(array<T>^% a, int n) { if (a->Length < n) Array::Resize(a, n); }
+
+    bool TelemetryStoreStage::Update(TelemetrySnapshot^ into)
+    {
+        if (into == nullptr) throw gcnew ArgumentNullException("into");
+
+        CTelemetryStore* store = Native();
+        if (store->GetVersion() == into->Version) return false;
+
+        uint64_t version = 0;
+        const int n = static_cast<int>(store->Snapshot(std::span(m_scratch, CTelemetryStore::MAX_KEYS), version));
+
+        Grow(into->Keys      , n);
+        Grow(into->Values    , n);
+        Grow(into->Min       , n);
+        Grow(into->Max       , n);
+        Grow(into->Counts    , n);
+        Grow(into->Rates     , n);
+        Grow(into->TimeStamps, n);
+
+        for (int i = 0; i < n; ++i) {
+            const CTelemetryStore::Entry& e = m_scratch[i];
+            into->Keys      [i] = e.key;
+            into->Values    [i] = e.value;
+            into->Min       [i] = e.min;
+            into->Max       [i] = e.max;
+            into->Counts    [i] = e.count;
+            into->Rates     [i] = e.rate;
+            into->TimeStamps[i] = e.timeStamp;
+        }
+        into->Count   = n;
+        into->Version = version;
+        return true;
+    }
+
+    void TelemetryStoreStage::Clear() { Native()->Clear(); }
+
+    bool TelemetryStoreStage::Consume::get()           { return Native()->GetConsume(); }
+    void TelemetryStoreStage::Consume::set(bool value) { Native()->SetConsume(value); }
+
+    int  TelemetryStoreStage::Dropped::get() { return static_cast<int>(Native()->GetDropped()); }
+}
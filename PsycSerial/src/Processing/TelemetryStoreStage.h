@@ -0,0 +1,48 @@
+#pragma once
+
+#include "PacketStage.h"
+#include "CTelemetryStore.h"
+
+using namespace System;
+
+namespace PsycSerial::Processing
+{
+    // Copy of the telemetry store, one entry per key in order of first arrival.  Arrays only grow; reuse the same
+    // instance every frame.
+    public ref class TelemetrySnapshot
+    {
+    public:
+        array<UInt32>^ Keys       = gcnew array<UInt32>(0);
+        array<float>^  Values     = gcnew array<float >(0);
+        array<float>^  Min        = gcnew array<float >(0);
+        array<float>^  Max        = gcnew array<float >(0);
+        array<UInt64>^ Counts     = gcnew array<UInt64>(0);
+        array<double>^ Rates      = gcnew array<double>(0);   // updates per second
+        array<double>^ TimeStamps = gcnew array<double>(0);   // device time of the last update
+        int            Count      = 0;
+        UInt64         Version    = UInt64::MaxValue;
+    };
+
+    public ref class TelemetryStoreStage sealed : PacketStage
+    {
+    public:
+        TelemetryStoreStage();
+        ~TelemetryStoreStage();
+        !TelemetryStoreStage();
+
+        // Refreshes into if the store changed since into was last filled; false (into untouched) if not
+        bool Update(TelemetrySnapshot^ into);
+        void Clear();
+
+        // Telemetry packets stop here instead of reaching DataReceived (default true)
+        property bool Consume { bool get(); void set(bool value); }
+        property int  Dropped { int get(); }
+
+        static void DoTest() { CTelemetryStore::DoTest(); }
+
+    private:
+        CTelemetryStore* Native() { ThrowIfDisposed(); return static_cast<CTelemetryStore*>(m_stage); }
+
+        CTelemetryStore::Entry* m_scratch = nullptr;
+    };
+}
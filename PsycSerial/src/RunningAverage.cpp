@@ -27,6 +27,23 @@ namespace PsycSerial
         _p->Add(value);
     }
 
+    void RunningAverage::AddRange(array<double>^ values)
+    {
+        if (values == nullptr) throw gcnew ArgumentNullException("values");
+        AddRange(values, 0, values->Length);
+    }
+
+    void RunningAverage::AddRange(array<double>^ values, int offset, int count)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningAverage");
+        if (values == nullptr) throw gcnew ArgumentNullException("values");
+        if (offset < 0 || count < 0 || offset + count > values->Length) throw gcnew ArgumentOutOfRangeException("count");
+        if (count == 0) return;
+
+        pin_ptr<double> p = &values[offset];
+        _p->AddRange(std::span<const double>(p, static_cast<size_t>(count)));
+    }
+
     double RunningAverage::Average::get()
     {
         if (!_p) throw gcnew ObjectDisposedException("RunningAverage");
@@ -50,4 +67,40 @@ namespace PsycSerial
         if (!_p) throw gcnew ObjectDisposedException("RunningAverage");
         return static_cast<uint32_t>(_p->GetCount());
 	}
+
+    double RunningAverage::Variance::get()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningAverage");
+        return _p->GetVariance();
+    }
+
+    double RunningAverage::StdDev::get()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningAverage");
+        return _p->GetStdDev();
+    }
+
+    double RunningAverage::Ema::get()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningAverage");
+        return _p->GetEma();
+    }
+
+    double RunningAverage::EmaAlpha::get()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningAverage");
+        return _p->GetEmaAlpha();
+    }
+
+    void RunningAverage::EmaAlpha::set(double value)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningAverage");
+        _p->SetEmaAlpha(value);
+    }
+
+    double RunningAverage::Delayed(uint32_t delay)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningAverage");
+        return _p->GetDelayed(delay);
+    }
 } // namespace PsycSerial
@@ -21,10 +21,20 @@ namespace PsycSerial
 
         void Reset(size_t windowSize);
         void Add(double value);
+        void AddRange(array<double>^ values);
+        void AddRange(array<double>^ values, int offset, int count);
+
+        double Delayed(uint32_t delay);
+
+        static void DoTest() { CRunningAverageMinMax::DoTest(); }
 
 		property double   Average { inline double   get(); }
         property double   Min     { inline double   get(); }
         property double   Max     { inline double   get(); }
         property uint32_t Count   { inline uint32_t get(); }
+        property double   Variance{ inline double   get(); }
+        property double   StdDev  { inline double   get(); }
+        property double   Ema     { inline double   get(); }
+        property double   EmaAlpha{ inline double   get(); inline void set(double value); }
     };
 }
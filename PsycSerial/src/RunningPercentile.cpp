@@ -0,0 +1,64 @@
+#include "RunningPercentile.h"
+
+namespace PsycSerial
+{
+
+    // Deterministic cleanup
+    RunningPercentile::~RunningPercentile() { this->!RunningPercentile(); }
+
+    // Finalizer (in case user forgets to Dispose)
+    RunningPercentile::!RunningPercentile() { delete _p; _p = nullptr; }
+
+
+    RunningPercentile::RunningPercentile(size_t windowSize)
+    {
+        _p = new CRunningPercentile(windowSize);
+    }
+
+    void RunningPercentile::Reset(size_t windowSize)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningPercentile");
+        _p->Reset(windowSize);
+    }
+
+    void RunningPercentile::Add(double value)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningPercentile");
+        _p->Add(value);
+    }
+
+    void RunningPercentile::AddRange(array<double>^ values)
+    {
+        if (values == nullptr) throw gcnew ArgumentNullException("values");
+        AddRange(values, 0, values->Length);
+    }
+
+    void RunningPercentile::AddRange(array<double>^ values, int offset, int count)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningPercentile");
+        if (values == nullptr) throw gcnew ArgumentNullException("values");
+        if (offset < 0 || count < 0 || offset + count > values->Length) throw gcnew ArgumentOutOfRangeException("count");
+        if (count == 0) return;
+
+        pin_ptr<double> p = &values[offset];
+        _p->AddRange(std::span<const double>(p, static_cast<size_t>(count)));
+    }
+
+    double RunningPercentile::Percentile(double p)
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningPercentile");
+        return _p->GetPercentile(p);
+    }
+
+    double RunningPercentile::Median::get()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningPercentile");
+        return _p->GetMedian();
+    }
+
+    uint32_t RunningPercentile::Count::get()
+    {
+        if (!_p) throw gcnew ObjectDisposedException("RunningPercentile");
+        return static_cast<uint32_t>(_p->GetCount());
+    }
+} // namespace PsycSerial
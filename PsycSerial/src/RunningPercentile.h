@@ -0,0 +1,34 @@
+// RunningPercentile.h
+#pragma once
+
+#include <cstdint>
+#include "CRunningPercentile.h"
+
+using namespace System;
+
+namespace PsycSerial
+{
+    public ref class RunningPercentile sealed
+    {
+    private:
+        CRunningPercentile* _p = nullptr;
+
+    public:
+        RunningPercentile(size_t windowSize);
+        ~RunningPercentile();
+        !RunningPercentile();
+
+
+        void Reset(size_t windowSize);
+        void Add(double value);
+        void AddRange(array<double>^ values);
+        void AddRange(array<double>^ values, int offset, int count);
+
+        double Percentile(double p);   // p in [0, 1]
+
+        static void DoTest() { CRunningPercentile::DoTest(); }
+
+        property double   Median { inline double   get(); }
+        property uint32_t Count  { inline uint32_t get(); }
+    };
+}
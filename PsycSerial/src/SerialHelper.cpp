@@ -2,6 +2,7 @@
 #include "Utilities.h"
 #include "EventRaisers.h"
 #include "Packets/Decoder.h"
+#include "CTrace.h"
 
 // Include necessary headers for interop
 #include <vcclr.h> // For GCHandle, pin_ptr
@@ -268,6 +269,22 @@ namespace PsycSerial
         m_nativeSerial->Clear();
 	}
 
+    void SerialHelper::AddStage(Processing::PacketStage^ stage) {
+        ThrowIfDisposed();
+        if (stage == nullptr) throw gcnew ArgumentNullException("stage");
+        if (m_stages->Contains(stage)) return;
+
+        m_nativeSerial->AddStage(stage->NativeStage());
+        m_stages->Add(stage);
+    }
+
+    void SerialHelper::RemoveStage(Processing::PacketStage^ stage) {
+        ThrowIfDisposed();
+        if (stage == nullptr || !m_stages->Remove(stage)) return;
+
+        m_nativeSerial->RemoveStage(stage->NativeStage());  // returns once the read thread is out of the stage
+    }
+
 
     Task<bool>^ SerialHelper::OpenAsync() {
         return Task::Run(gcnew Func<bool>(this, &SerialHelper::Open));
@@ -285,6 +302,34 @@ namespace PsycSerial
 
 
 
+    UInt32 SerialHelper::SendCommand(UInt16 code, UInt16 parameter, double value) {
+        constexpr UInt32 FAIL = 0;
+        ThrowIfDisposed();
+        if (m_nativeSerial == nullptr) return FAIL;
+        try {
+            return m_nativeSerial->SendCommand(code, parameter, value);
+        }
+        catch (const std::exception& ex) {
+            Debug::WriteLine(String::Format("SerialHelper: Native exception during SendCommand: {0}", gcnew String(ex.what())));
+            RaiseErrorOccurredEvent(ConvertStdException(ex));
+        }
+        catch (...) {
+            Debug::WriteLine("SerialHelper: Unknown native exception during SendCommand.");
+            RaiseErrorOccurredEvent(gcnew Exception("Unknown native exception during SendCommand"));
+        }
+        return FAIL;
+    }
+
+    UInt64 SerialHelper::DroppedBlocks::get() {
+        if (m_disposed || m_nativeSerial == nullptr) return 0;
+        return m_nativeSerial->GetDroppedBlocks();
+    }
+
+    void SerialHelper::SetBlockCapacity(UInt32 maxItems, UInt32 maxEvents) {
+        ThrowIfDisposed();
+        m_nativeSerial->SetBlockCapacity(maxItems, maxEvents);
+    }
+
     bool SerialHelper::IsOpen::get() {
 		constexpr bool FAIL = false;
         if (m_disposed || m_nativeSerial == nullptr) {
@@ -440,7 +485,10 @@ namespace PsycSerial
         }
 
 
-        DataEventRaiser^ raiser = DataEventRaiser::Rent(this, managedPacket);
+        if (packet.traceId)
+            CTrace::Record(CTrace::Point::Convert, packet.traceId);
+
+        DataEventRaiser^ raiser = DataEventRaiser::Rent(this, managedPacket, packet.traceId);
 
         if (m_managedCallbacks != nullptr) {
             try {
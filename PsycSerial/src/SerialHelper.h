@@ -3,6 +3,7 @@
 #include "ManagedCallbacks.h"
 #include "CSerial.h"
 #include "Packets/Packets.h"
+#include "Processing/PacketStage.h"
 
 using namespace System;
 using namespace System::Diagnostics;
@@ -80,8 +81,15 @@ namespace PsycSerial {
         bool Write(array<Byte>^ data);
         bool Write(array<Byte>^ data, int offset, int count);
 
+        // Sends a Command frame; returns the request id the device's reply carries, 0 if it could not be written
+        UInt32 SendCommand(UInt16 code, UInt16 parameter, double value);
+
         void Clear();
 
+        // Native processing stages, run on the read thread before packets are queued for DataReceived
+        void AddStage(Processing::PacketStage^ stage);
+        void RemoveStage(Processing::PacketStage^ stage);
+
         // --- Async helpers ---
 
         // [NEW] Parameterless Open (uses last known m_portName)
@@ -107,6 +115,8 @@ namespace PsycSerial {
         property int  BaudRate {  int get(); }
 
         property int PendingCallbacks { int get(); } // Returns queue size from ManagedCallbacks
+
+        property UInt64 DroppedBlocks { UInt64 get(); } // Block frames past the negotiated block size, or corrupt
         
         property CallbackPolicy CurrentCallbackPolicy { CallbackPolicy get() { return m_managedCallbacks->Policy; } }
         
@@ -124,6 +134,7 @@ namespace PsycSerial {
 		void OnHandshakeReceived(const CTextPacket& packet);
 		bool TestHandshakeResponse(array<Byte>^ response);
         String^ GetHandshakeResponse();
+        void SetBlockCapacity(UInt32 maxItems, UInt32 maxEvents);  // block sizes from the handshake
 		int m_handshakeLength = 0;
         volatile ConnectionState m_connectionState = ConnectionState::Disconnected;
         AutoResetEvent^ m_handshakeEvent = gcnew AutoResetEvent(false);
@@ -140,6 +151,8 @@ namespace PsycSerial {
         NativeConnectionCallbackDelegate^ m_delegateConnectionHandler;
 
 		array<Byte>^ m_managedBytes = gcnew array<Byte>(4096);
+
+        System::Collections::Generic::List<Processing::PacketStage^>^ m_stages = gcnew System::Collections::Generic::List<Processing::PacketStage^>();  // keeps registered stages alive
     };
 
 
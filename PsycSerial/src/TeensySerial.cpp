@@ -94,12 +94,15 @@ namespace PsycSerial
 				if (devAck)
 				{
 //					Clear();
-					Write(">" + Config::ProgramVersion + "\n");
+					// Offer batched telemetry frames; the device answers with how many entries it will batch, if it does
+					Write(">" + Config::ProgramVersion + ":TELEMETRY_BATCH=" + UInt32(CTelemetryBatch::MAX_ENTRIES).ToString() + "\n");
 
 					received = m_handshakeEvent->WaitOne(500);
 					if (received)
 					{
+						Config::TELEMETRY_BATCH = 0;
 						Config::ParseHandshakeResponse(GetHandshakeResponse());
+						SetBlockCapacity(Config::MAX_BLOCKSIZE, Config::MAX_EVENTS_PER_BLOCK);
 
 						m_connectionState = ConnectionState::HandshakeSuccessful;
 //						Clear();
@@ -0,0 +1,11 @@
+#include "Tracing.h"
+#include "Utilities.h"
+
+
+namespace PsycSerial
+{
+    String^ Tracing::ToChromeJson()
+    {
+        return ConvertStdString(CTrace::ToChromeJson());
+    }
+}
@@ -0,0 +1,25 @@
+// Tracing.h
+#pragma once
+
+#include "CTrace.h"
+
+using namespace System;
+
+namespace PsycSerial
+{
+    // Per-frame latency tracing from the read to the DataReceived consumers (see CTrace).  Start, run the load of
+    // interest, Stop, then save ToChromeJson() as a .json file and open it in chrome://tracing or ui.perfetto.dev.
+    public ref class Tracing abstract sealed
+    {
+    public:
+        static void Start() { CTrace::Start(); }
+        static void Stop()  { CTrace::Stop(); }
+
+        static property bool   IsOn    { bool   get() { return CTrace::IsOn(); } }
+        static property UInt64 Dropped { UInt64 get() { return CTrace::GetDropped(); } }   // stamps from too many threads
+
+        static String^ ToChromeJson();
+
+        static void DoTest() { CTrace::DoTest(); }
+    };
+}
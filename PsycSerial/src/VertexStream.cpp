@@ -0,0 +1,40 @@
+#include "VertexStream.h"
+
+using namespace System::Runtime::InteropServices;
+
+namespace PsycSerial
+{
+    generic<typename TVertex> where TVertex : value class
+    int VertexStream::Generate(BlockPacket^ block, int first, int count, FieldEnum field, bool stateTimeX,
+                               double scale, double originX, System::Numerics::Vector4 colour,
+                               array<TVertex>^ dest, int offset)
+    {
+        if (block == nullptr) throw gcnew ArgumentNullException("block");
+        if (dest  == nullptr) throw gcnew ArgumentNullException("dest");
+        if (first < 0 || count < 0)                 throw gcnew ArgumentOutOfRangeException("count");
+        if (offset < 0 || offset > dest->Length)    throw gcnew ArgumentOutOfRangeException("offset");
+        if (Marshal::SizeOf(TVertex::typeid) != sizeof(CVertexStream::Vertex))
+            throw gcnew ArgumentException("TVertex must be 64 bytes: position, normal, colour, uv0, uv1");
+        if (block->Columns == nullptr || count == 0 || offset == dest->Length) return 0;
+
+        CVertexStream::Params params;
+        params.field     = static_cast<CVertexStream::Field>(field);
+        params.xSource   = stateTimeX ? CVertexStream::XSource::StateTime : CVertexStream::XSource::SampleTime;
+        params.scale     = scale;
+        params.originX   = originX;
+        params.colour[0] = colour.X;
+        params.colour[1] = colour.Y;
+        params.colour[2] = colour.Z;
+        params.colour[3] = colour.W;
+
+        GCHandle handle = GCHandle::Alloc(dest, GCHandleType::Pinned);
+        try {
+            auto* base = static_cast<CVertexStream::Vertex*>(handle.AddrOfPinnedObject().ToPointer());
+            return static_cast<int>(CVertexStream::Generate(*block->Columns, static_cast<size_t>(first), static_cast<size_t>(count),
+                                                            params, base + offset, static_cast<size_t>(dest->Length - offset)));
+        }
+        finally {
+            handle.Free();
+        }
+    }
+}
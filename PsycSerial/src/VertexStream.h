@@ -0,0 +1,25 @@
+// VertexStream.h
+#pragma once
+
+#include "CVertexStream.h"
+#include "Packets/Packets.h"
+
+using namespace System;
+
+namespace PsycSerial
+{
+    // Plot vertices straight from a block's native columns.  TVertex must be a 64-byte blittable struct laid out
+    // as position (vec4), normal (vec4), colour (vec4), uv0 (vec2), uv1 (vec2).
+    public ref class VertexStream abstract sealed
+    {
+    public:
+        // Writes samples [first, first + count) of block as vertices into dest starting at offset, stopping at the
+        // end of dest.  x = (stateTimeX ? StateTime : TimeStamp) - originX, y = field * scale.  Returns the count.
+        generic<typename TVertex> where TVertex : value class
+        static int Generate(BlockPacket^ block, int first, int count, FieldEnum field, bool stateTimeX,
+                            double scale, double originX, System::Numerics::Vector4 colour,
+                            array<TVertex>^ dest, int offset);
+
+        static void DoTest() { CVertexStream::DoTest(); }
+    };
+}
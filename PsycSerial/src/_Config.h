@@ -19,6 +19,7 @@ namespace PsycSerial
 
         static UInt32 MAX_BLOCKSIZE         =    164;  // max number of DataType entries in a BlockType
 		static UInt32 MAX_EVENTS_PER_BLOCK  =    400;  // max number of EventType entries in a BlockType
+        static UInt32 TELEMETRY_BATCH       =      0;  // max entries per batched telemetry frame, 0 = single frames only
 
         static String^ ProgramVersion = "v0.2.3";
         static String^ DeviceVersion  = String::Empty;
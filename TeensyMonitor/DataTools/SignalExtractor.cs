@@ -1,5 +1,6 @@
 ﻿using PsycSerial;
 using PsycSerial.Math;
+using PsycSerial.Processing;
 using TeensyMonitor.Plotter.Helpers;
 using TeensyMonitor.Plotter.UserControls;
 
@@ -16,19 +17,26 @@ namespace TeensyMonitor.DataTools
 
 
         private readonly ZFixer fixer = new();
-        private const double scale_C0 = 1.0 / 4660.100;
-        private const double delta_Offset2 = 368.0;
 
-        private const uint ra_Size = 512;
+        private const int ra_Size = 512;
 
-        public sealed class StateData
+        // One native stage for all head states: takes the last sample of every block, by its state, on the serial
+        // read thread, and keeps the per-state windows and the shared min/max.  Each extractor drains its own state.
+        private static SignalExtractorStage? _stage;
+        private static SignalExtractorStage Stage
         {
-            public RunningAverage RA     = new(ra_Size);
-            public XY[]           Buffer = new XY[ra_Size];
-            public uint           Index  = 0;
+            get
+            {
+                if (_stage == null)
+                {
+                    _stage = new SignalExtractorStage(ra_Size);
+                    Program.serialPort?.AddStage(_stage);
+                }
+                return _stage;
+            }
         }
 
-        public static Dictionary<HeadState, StateData> Stats { get; } = [];
+        private readonly SignalSeries _series = new();
 
         public SignalExtractor(HeadState state)
         {
@@ -37,6 +45,8 @@ namespace TeensyMonitor.DataTools
             _stateLabel_Signal = $"*Signal {state.Description()}";
 
             fixer.Telemetry = telemetry;
+
+            Stage.Drain(_state, _series);   // start from now, as a new extractor always has, not from a backlog
         }
 
 
@@ -48,67 +58,45 @@ namespace TeensyMonitor.DataTools
 
 
         int lastOffset2 = 0;
-        HeadState[] headStates = [];
         public bool Process(DataPacket packet)
         {
             if (_isDisposed) return false;
             SetChart(packet); 
 
-            double C0 = packet.Channel[0] * scale_C0;
-
 //            bool isDiscontinuity = packet.Stage2_Offset != lastOffset2;
 
             lastOffset2 = packet.Stage2_Offset;
 
-            double x = packet.TimeStamp;
-            double y = C0 + packet.Stage2_Offset * delta_Offset2;
-            bool changed = false;
-
-//            if (isDiscontinuity)
-//                fixer.Predict(ref x, ref y);
-//            else
-//                changed = fixer.Fix(ref x, ref y);
-            
-            telemetry["-Time"] = new XY(x, x);  // - means label only, do not graph.  Also, output time (x) as value, hence x,x.
-
-            telemetry[_stateLabel_Raw] = new XY(x, y); 
+            if (!Stage.Drain(_state, _series) || _series.RawCount == 0)
+                return false;
 
-            var stateData = Stats.TryGetValue(_state, out var sd) ? sd : Stats[_state] = new StateData();
+            bool changed = false;
 
-            var ra = stateData.RA;
-            var _buffer = stateData.Buffer;
-            var _ra_index = stateData.Index;
-            
-            ra.Add(y);
-            _buffer[_ra_index++] = new XY(x, y);
-            if (_ra_index == ra_Size) _ra_index = 0;
+            MyPlot.Shared_MinY = Stage.SharedMin;
+            MyPlot.Shared_MaxY = Stage.SharedMax;
 
-            if (ra.Count == ra_Size)
+            // Usually one point, the block just received; more when the read thread has run ahead.  The signal series
+            // ends on the same point as the raw one, once the window is full.
+            int firstSignal = _series.RawCount - _series.SignalCount;
+            for (int i = 0; i < _series.RawCount; i++)
             {
-                uint delay = (ra_Size - 1) / 2;
-                uint bufferIndex = (_ra_index + delay) % ra_Size;
-                telemetry[_stateLabel_Signal] = new XY(_buffer[bufferIndex].x, _buffer[bufferIndex].y - ra.Average);
-            }
+                double x = _series.X  [i];
+                double y = _series.Raw[i];
 
+//                if (isDiscontinuity)
+//                    fixer.Predict(ref x, ref y);
+//                else
+//                    changed = fixer.Fix(ref x, ref y);
 
-            if (headStates.Length != Stats.Count)
-                headStates = [.. Stats.Keys];
+                telemetry["-Time"] = new XY(x, x);  // - means label only, do not graph.  Also, output time (x) as value, hence x,x.
 
-            double min = double.MaxValue;
-            double max = double.MinValue;
+                telemetry[_stateLabel_Raw] = new XY(x, y);
 
-            for (int i = 0; i < headStates.Length; i++)
-                if (Stats.TryGetValue(headStates[i], out var stat))
-                {
-                    if (stat.RA.Min < min) min = stat.RA.Min;
-                    if (stat.RA.Max > max) max = stat.RA.Max;
-                }
+                if (i >= firstSignal)
+                    telemetry[_stateLabel_Signal] = new XY(_series.SignalX[i - firstSignal], _series.Signal[i - firstSignal]);
 
-            MyPlot.Shared_MinY = min;
-            MyPlot.Shared_MaxY = max;
-
-            stateData.Index = _ra_index;
-            Chart?.AddData(telemetry);
+                Chart?.AddData(telemetry);
+            }
 
             return changed;
         }
@@ -98,6 +98,20 @@ namespace TeensyMonitor
             return sb.ToString();
         }
 
+        // Same text from a packed telemetry key: group in the low byte, then subGroup, then the 16-bit id
+        public static string TelemetryDescription(this uint key)
+        {
+            StringBuilder sb = new();
+
+            sb.Append(((TelemetryPacket.TeleGroup)(key & 0xFF)).ToString());
+            sb.Append('.');
+            sb.Append(((key >> 8) & 0xFF).ToString("X2"));
+            sb.Append('.');
+            sb.Append((key >> 16).ToString("X4"));
+
+            return sb.ToString();
+        }
+
         public static RectangleF CalculateTotalBounds(this List<TextBlock> textBlocks, ref RectangleF maxBounds)
         {
             RectangleF totalBounds = RectangleF.Empty;
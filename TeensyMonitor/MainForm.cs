@@ -3,6 +3,7 @@ using Timer = System.Windows.Forms.Timer;
 namespace TeensyMonitor
 {
     using PsycSerial;
+    using PsycSerial.Processing;
     using System.Diagnostics;
     using TeensyMonitor.Plotter.Helpers;
     using TeensyMonitor.Plotter.UserControls;
@@ -13,6 +14,9 @@ namespace TeensyMonitor
         readonly TeensySerial? SP = Program.serialPort;
         readonly CancellationTokenSource cts = new();
 
+        // Telemetry stays native: the pane pulls a snapshot per frame instead of getting every packet
+        readonly TelemetryStoreStage telemetryStore = new();
+
 
         public MainForm()
         {
@@ -53,6 +57,9 @@ namespace TeensyMonitor
             SP.ConnectionChanged += SP_ConnectionChanged;
             SP.ErrorOccurred     += SP_ErrorOccurred;
 
+            SP.AddStage(telemetryStore);
+            TelemetryPane.Store = telemetryStore;
+
             Init_Clear();
         }
 
@@ -67,7 +74,6 @@ namespace TeensyMonitor
 
             if (packet is     BlockPacket blockPacket) AddBlockPacket(blockPacket);
             if (packet is      TextPacket textPacket ) AddTextPacket( textPacket);
-            if (packet is TelemetryPacket telePacket ) AddTelePacket( telePacket);
 
             packet.Cleanup();
         }
@@ -93,7 +99,7 @@ namespace TeensyMonitor
         private void AddTextPacket(TextPacket textPacket)
         {
             var parsedValues = parsedPool.Rent();
-            if (MyTextParser.Parse(textPacket.Text, parsedValues))
+            if (MyTextParser.Parse(textPacket, parsedValues))
             {
                 chart0.AddData(parsedValues);
                 parsedPool.Return(parsedValues);
@@ -102,10 +108,6 @@ namespace TeensyMonitor
                 dbg.Log(textPacket.Text);
         }
 
-        private void AddTelePacket(TelemetryPacket telePacket)
-            => TelemetryPane.SP_DataReceived(telePacket);
-
-
         private async void SP_ErrorOccurred(Exception exception)
         {
             if (IsHandleCreated == false) return;
@@ -17,6 +17,8 @@ namespace TeensyMonitor.Plotter.Helpers
 
         public static implicit operator MyColour(Color c) => new(c.R / 255f, c.G / 255f, c.B / 255f, c.A / 255f);
 
+        public static implicit operator System.Numerics.Vector4(MyColour c) => new(c.r, c.g, c.b, c.a);
+
 
         public static readonly List<MyColour> BaseColours = [
             Color.FromArgb(0x4E, 0x79, 0xA7), // Muted Blue
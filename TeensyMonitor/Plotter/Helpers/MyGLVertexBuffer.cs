@@ -57,6 +57,7 @@ namespace TeensyMonitor.Plotter.Helpers
     public class MyGLVertexBuffer(int vertexCapacity) : IDisposable
     {
         public int VertexCount { get => _vertexCount; }
+        public int Capacity    { get => vertexCapacity; }
   
         private readonly Vertex[] _vertexData = new Vertex[vertexCapacity];
         private int _vao;
@@ -67,6 +68,9 @@ namespace TeensyMonitor.Plotter.Helpers
 
         public int WindowSize { get; set; } = -1;
 
+        // What the vertices' x are relative to, so large timestamps keep float precision; the transform drawing them subtracts it too
+        public double OriginX { get; set; } = 0.0;
+
         private readonly object _lock = new();
 
         public void Init()
@@ -202,7 +206,7 @@ namespace TeensyMonitor.Plotter.Helpers
         Vertex[] subPlotData = new Vertex[1024];
         public void SetSubPlotData(BlockPacket packet, FieldEnum field, double scale)
         {
-            if (subPlotData.Length < packet.Count)
+            if (subPlotData.Length < packet.Count + 1)
                 subPlotData = new Vertex[packet.Count * 2];
 
             if (field == FieldEnum.Events)
@@ -224,19 +228,14 @@ namespace TeensyMonitor.Plotter.Helpers
 
             MyColour colour = MyColour.GetFieldColour(field);
 
-            int i = 0;
-            while (i < packet.Count)
-            {
-                double value = packet.BlockData[i].get(field) * scale;
-
-                float x = (float)packet.BlockData[i].StateTime;
-                float y = (float)value;
-                float z = 0.0f;
+            int i = VertexStream.Generate(packet, 0, packet.Count, field, stateTimeX: true, scale, originX: 0.0, colour, subPlotData, 0);
 
-                if (separate && i == last)
-                    subPlotData[i++] = new Vertex((float)packet.BlockData[last-1].StateTime, y, z, colour);
-
-                subPlotData[i++] = new Vertex(x, y, z, colour);
+            // Hold the last value from the previous sample's time, so a delayed last sample shows as a step
+            if (separate && i == packet.Count)
+            {
+                subPlotData[i] = subPlotData[i - 1];
+                subPlotData[i - 1].Position.X = subPlotData[i - 2].Position.X;
+                i++;
             }
 
 
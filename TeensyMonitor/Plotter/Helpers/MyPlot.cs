@@ -24,6 +24,15 @@ namespace TeensyMonitor.Plotter.Helpers
 
         private RunningAverage? _ra = null;
 
+        // Block data goes into a min/max pyramid and is drawn as one min/max pair per pixel, so spikes inside a block survive
+        private readonly MinMaxPyramid _lod = new(capacity: 4096, levels: 8);
+        private bool _lodActive = false;
+        private double[] _lodX = new double[256];
+        private double[] _lodY = new double[256];
+        private double[] _pxMin = [];
+        private double[] _pxMax = [];
+        private Vertex[] _lodVertices = [];
+
 
         public string DBG { get; set; } = string.Empty;
         
@@ -121,9 +130,27 @@ namespace TeensyMonitor.Plotter.Helpers
             if (Selector == null)
                 SetSubplot(block);
 
-            _bufMainPlot.AddBlock(ref block, Selector, onlyLast:true); // only plot last point in block
+            int n = block.Count;
+            if (_lodX.Length < n)
+            {
+                _lodX = new double[n * 2];
+                _lodY = new double[n * 2];
+            }
 
-            LastX = (float)block.BlockData[block.Count - 1].TimeStamp;
+            for (int i = 0; i < n; i++)
+            {
+                ref var item = ref block.BlockData[i];
+                _lodX[i] = item.TimeStamp;
+                _lodY[i] = (Selector == null) ? item.Channel[0] * Config.C0to1024 : item.get(Selector.Value);
+            }
+
+            lock (_lod)
+            {
+                _lod.AddRange(_lodX, _lodY, 0, n);
+                _lodActive = true;
+            }
+
+            LastX = (float)block.BlockData[n - 1].TimeStamp;
         }
 
 
@@ -132,6 +159,9 @@ namespace TeensyMonitor.Plotter.Helpers
         /// </summary>
         public void Render()
         {
+            if (Visible && _lodActive) BuildFromPyramid();   // before the transform: it moves the buffer's origin
+
+            bool transformSet = false;
             if ((_ra != null && AutoScaling) || SharedScaling)
             {
                 float minY, maxY;
@@ -147,12 +177,29 @@ namespace TeensyMonitor.Plotter.Helpers
                 }
 
                 // Guard bad values / zero range
-                SetScaling(minY, maxY);
+                transformSet = SetScaling(minY, maxY);
             }
 
             if (Visible)
             {
+                // The plotter's transform is for absolute x; one relative to this buffer's origin is used, then put back
+                bool restore = _bufMainPlot.OriginX != 0.0;
+                if (restore && !transformSet)
+                {
+                    RectangleF viewport = _plotter.ViewPort;
+                    _parentMinX = viewport.Left;
+                    _parentMaxX = viewport.Right;
+                    SetTransform(viewport.Top, viewport.Bottom);
+                }
+
                 _bufMainPlot.DrawLineStrip();
+
+                if (restore)
+                {
+                    var transform = _plotter.getPlotTransform();
+                    GL.UniformMatrix4(_transformLoc, false, ref transform);
+                }
+
                 _subPlot.Render();
                 DBG = "Rendered";
             }
@@ -162,10 +209,10 @@ namespace TeensyMonitor.Plotter.Helpers
             }
         }
 
-        public void SetScaling(float minY, float maxY)
+        public bool SetScaling(float minY, float maxY)
         {
             if (!float.IsFinite(minY) || !float.IsFinite(maxY))
-                return;
+                return false;
 
             if (maxY < minY) (minY, maxY) = (maxY, minY);
 
@@ -194,10 +241,63 @@ namespace TeensyMonitor.Plotter.Helpers
             _parentMaxX = viewport.Right;
 
 
-            var transform = Matrix4.CreateOrthographicOffCenter(_parentMinX, _parentMaxX, bottom, top, -1.0f, 1.0f);
-            GL.UniformMatrix4(_transformLoc, false, ref transform);
+            SetTransform(bottom, top);
 
             _plotter.SetMetrics(minY, maxY, range, desiredHeight);
+            return true;
+        }
+
+        /// <summary>
+        /// Sets the transform for the main buffer: the parent's x range, moved by the buffer's origin in double before narrowing.
+        /// </summary>
+        private void SetTransform(float bottom, float top)
+        {
+            double origin = _bufMainPlot.OriginX;
+            var transform = Matrix4.CreateOrthographicOffCenter((float)(_parentMinX - origin), (float)(_parentMaxX - origin), bottom, top, -1.0f, 1.0f);
+            GL.UniformMatrix4(_transformLoc, false, ref transform);
+        }
+
+        /// <summary>
+        /// Replaces the main buffer with the visible range of the pyramid: one min/max pair per horizontal pixel.
+        /// x is relative to the left edge of the view, so pixels a day into a session still get distinct floats.
+        /// </summary>
+        private void BuildFromPyramid()
+        {
+            RectangleF viewport = _plotter.ViewPort;
+            int pixels = Math.Min(_plotter.PixelWidth, _bufMainPlot.Capacity / 2);
+            if (pixels <= 0 || viewport.Width <= 0) return;
+
+            if (_pxMin.Length != pixels)
+            {
+                _pxMin = new double[pixels];
+                _pxMax = new double[pixels];
+                _lodVertices = new Vertex[pixels * 2];
+            }
+
+            int found;
+            lock (_lod)
+                found = _lod.Query(viewport.Left, viewport.Right, _pxMin, _pxMax);
+
+            if (found < 0)
+            {   // nothing in view (after a device reset the pyramid starts over): no stale trace either
+                _bufMainPlot.Set(ref _lodVertices, 0);
+                return;
+            }
+
+            MyColour colour = MyColour.GetFieldColour(Selector ?? FieldEnum.C0);
+            float pixelWidth = viewport.Width / pixels;
+            int count = 0;
+            for (int p = 0; p < pixels; p++)
+            {
+                if (double.IsNaN(_pxMin[p])) continue;
+
+                float x = (p + 0.5f) * pixelWidth;
+                _lodVertices[count++] = new Vertex(x, (float)_pxMin[p], 0.0f, colour);   // block values are not Yscale'd, as they never were
+                _lodVertices[count++] = new Vertex(x, (float)_pxMax[p], 0.0f, colour);
+            }
+
+            _bufMainPlot.Set(ref _lodVertices, count);
+            _bufMainPlot.OriginX = viewport.Left;
         }
 
         /// <summary>
@@ -16,6 +16,8 @@ namespace TeensyMonitor.Plotter.UserControls
 
         public int GetPlotShader() => _plotShaderProgram;
 
+        public int PixelWidth => MyGL?.ClientSize.Width ?? 0;
+
         protected MyPlotterBase()
         {
             if (!Program.IsRunning) return;
@@ -1,9 +1,8 @@
 ﻿using OpenTK.Graphics.OpenGL4;
 using OpenTK.Mathematics;
 
-using PsycSerial;
+using PsycSerial.Processing;
 
-using System.Collections.Concurrent;
 using System.Windows.Forms;
 using TeensyMonitor.Plotter.Backgrounds;
 using TeensyMonitor.Plotter.Fonts;
@@ -13,66 +12,60 @@ namespace TeensyMonitor.Plotter.UserControls
     public partial class MyTelemetryPane : MyGLControl
     {
 
-        private readonly ConcurrentDictionary<uint, double> _latestValues = [];
-        private readonly ConcurrentDictionary<uint, Tuple<TextBlock, TextBlock>> _blocks = [];
+        private readonly TelemetrySnapshot _snapshot = new();
+        private readonly Dictionary<uint, Tuple<TextBlock, TextBlock>> _blocks = [];
         private readonly List<TextBlock> _textBlocksToRender = [];
+        private float[] _shownValues = [];
 
-        private volatile int labelCount = 0;
-        private readonly ConcurrentDictionary<uint, bool> _pendingStates = [];
+        private int labelCount = 0;
 
         private LabelAreaRenderer? _labelAreaRenderer;
 
-        private readonly object _lock = new();
-        private volatile bool needUpdate = true;
+        private bool needUpdate = true;
+
+        // Native store the pane reads once per frame; telemetry packets no longer reach managed code one by one
+        public TelemetryStoreStage? Store { get; set; }
 
         public MyTelemetryPane()
         {
             InitializeComponent();
         }
-        public void SP_DataReceived(IPacket packet)
-        {
-            if (font == null) return;
-
-            if (packet is TelemetryPacket telePacket == false) return;
-            var key = telePacket.Key; if (key == 0) return;
-
-            if (_blocks.ContainsKey(key) == false)
-                if (TestAndSetPending(key) == false)
-                    CreateTextBlocksForLabel(key, telePacket, "0.00");
 
-            if (_latestValues.TryGetValue(key, out var existingValue))
-                if (Math.Abs(existingValue - telePacket.Value) < 0.00001) return;
+        // Pulls the store if it changed; a redraw is only needed when a shown value did
+        private void PullSnapshot()
+        {
+            if (Store == null || Store.Update(_snapshot) == false) return;
 
-            _latestValues[key] = telePacket.Value;
-            needUpdate = true;
-        }
+            if (_shownValues.Length < _snapshot.Count)
+            {
+                int old = _shownValues.Length;
+                Array.Resize(ref _shownValues, _snapshot.Count);
+                Array.Fill(_shownValues, float.NaN, old, _snapshot.Count - old);
+            }
 
-        private bool TestAndSetPending(uint state)
-        {
-            lock (_lock)
+            for (int i = 0; i < _snapshot.Count; i++)
             {
-                if (_pendingStates.ContainsKey(state)) return true;
-                _pendingStates[state] = true;
-                return false;
+                if (Math.Abs(_shownValues[i] - _snapshot.Values[i]) < 0.00001) continue;
+
+                _shownValues[i] = _snapshot.Values[i];
+                needUpdate = true;
+                redrawCounter = 0;
             }
         }
 
-        private void CreateTextBlocksForLabel(uint key, TelemetryPacket telePacket, string valueFormat)
+        private Tuple<TextBlock, TextBlock> CreateTextBlocksForLabel(uint key, string valueFormat)
         {
+            string labelText = $": {key.TelemetryDescription()}";
 
-            string labelText = $": {telePacket.Description()}";
-
-            lock (_lock)
-            {
-                Interlocked.Increment(ref labelCount);
-                float yPos = MyGL.Height - 20 - labelCount * 50;
+            labelCount++;
+            float yPos = MyGL.Height - 20 - labelCount * 50;
 
-                var labelBlock = new TextBlock(labelText, 126, yPos, font);
-                var valueBlock = new TextBlock("0.00"   , 120, yPos, font, TextAlign.Right, valueFormat);
+            var labelBlock = new TextBlock(labelText, 126, yPos, font);
+            var valueBlock = new TextBlock("0.00"   , 120, yPos, font, TextAlign.Right, valueFormat);
 
-                _blocks[key] = Tuple.Create(labelBlock, valueBlock);
-            }
-            _pendingStates.TryRemove(key, out _);
+            var tuple = Tuple.Create(labelBlock, valueBlock);
+            _blocks[key] = tuple;
+            return tuple;
         }
 
         protected override void Init()
@@ -85,33 +78,27 @@ namespace TeensyMonitor.Plotter.UserControls
         const int RedrawCount = 2;
         int redrawCounter = 0;
 
-        uint[] _keyCache = [];
         protected override void DrawText()
         {
-            if (font == null || needUpdate == false) return;
+            if (font == null) return;
 
+            PullSnapshot();
+            if (needUpdate == false) return;
+
+            // 1. Populate the list of blocks to render, one label / value pair per key in order of arrival.
             _textBlocksToRender.Clear();
-            // 1. Populate the list of blocks to render and flag if their content has changed.
-            lock (_lock)
+            for (int i = 0; i < _snapshot.Count; i++)
             {
-                if (_keyCache.Length != _latestValues.Count)
-                    _keyCache = [.. _latestValues.Keys];
-
+                uint key = _snapshot.Keys[i];
+                if (key == 0) continue;
 
-                for (int i = 0; i < _latestValues.Count; i++)
-                {
-                    uint key = _keyCache[i];
-                    if (_blocks.TryGetValue(key, out var tuple))
-                    {
-                        var item = _latestValues[key];
+                if (_blocks.TryGetValue(key, out var tuple) == false)
+                    tuple = CreateTextBlocksForLabel(key, "0.00");
 
-                        // Check
-                        tuple.Item2.SetValue(item);
+                tuple.Item2.SetValue(_snapshot.Values[i]);
 
-                        _textBlocksToRender.Add(tuple.Item1);
-                        _textBlocksToRender.Add(tuple.Item2);
-                    }
-                }
+                _textBlocksToRender.Add(tuple.Item1);
+                _textBlocksToRender.Add(tuple.Item2);
             }
 
             if (!_textBlocksToRender.Any()) return;
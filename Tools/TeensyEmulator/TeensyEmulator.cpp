@@ -0,0 +1,172 @@
+// Teensy emulator on a pseudo-terminal (Linux).  Runs CTeensyEmulator on the master side of a pty and prints the
+// slave's path; open that path as the serial port and the host sees a device that answers the handshake and then
+// streams at the configured rates.  A reader that does not keep up fills the device's send buffer, after which new
+// frames are dropped, as the firmware does; the once-a-second line on stderr shows throughput, backlog and drops.
+//
+//   g++ -std=c++20 -O2 -I../../PsycSerial/src -o teensy-emulator TeensyEmulator.cpp
+//       ../../PsycSerial/src/Emulator/CTeensyEmulator.cpp ../../PsycSerial/src/Emulator/CTeensyEmulator_Test.cpp
+//       ../../PsycSerial/src/Packets/CEncoder.cpp ../../PsycSerial/src/Packets/CBlockCodec.cpp
+//       ../../PsycSerial/src/Packets/CDecoder.cpp ../../PsycSerial/src/Packets/CTextFieldParser.cpp
+//
+//   teensy-emulator [--rate <multiplier>] [--packed] [--batch <n>] [--state-us <us>] [--hz <Hz>] [--block <n>]
+//                   [--link <path>] [--seconds <s>] [--test]
+
+#include "Emulator/CTeensyEmulator.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+
+namespace
+{
+    constexpr size_t SEND_BUFFER = 256 * 1024;   // bytes the device holds for a slow reader before it drops frames
+
+    volatile std::sig_atomic_t s_stop = 0;
+
+    double Now()
+    {
+        using clock = std::chrono::steady_clock;
+        static const auto start = clock::now();
+        return std::chrono::duration<double>(clock::now() - start).count();
+    }
+
+    int Usage(const char* program)
+    {
+        std::fprintf(stderr,
+            "usage: %s [--rate <multiplier>] [--packed] [--batch <n>] [--state-us <us>] [--hz <Hz>] [--block <n>]\n"
+            "          [--link <path>] [--seconds <s>] [--test]\n", program);
+        return 2;
+    }
+
+    int OpenPty(std::string& slavePath)
+    {
+        const int fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+            std::perror("posix_openpt");
+            return -1;
+        }
+        slavePath = ptsname(fd);
+
+        // Raw bytes both ways: no echo, no line discipline, no CR/LF translation
+        termios tio{};
+        tcgetattr(fd, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+        return fd;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    CTeensyEmulator::Settings settings;
+    std::string link;
+    double seconds = 0.0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        auto next = [&] { ++i; return value; };
+
+        if      (arg == "--test")              { CTeensyEmulator::DoTest(); return 0; }
+        else if (arg == "--packed")            settings.packedBlocks      = true;
+        else if (arg == "--rate"     && value) settings.multiplier        = std::atof(next());
+        else if (arg == "--batch"    && value) settings.telemetryBatch    = uint32_t(std::atoi(next()));
+        else if (arg == "--state-us" && value) settings.stateDuration_uS  = uint32_t(std::atoi(next()));
+        else if (arg == "--hz"       && value) settings.samplingSpeed_Hz  = uint32_t(std::atoi(next()));
+        else if (arg == "--block"    && value) settings.maxBlockSize      = uint32_t(std::atoi(next()));
+        else if (arg == "--link"     && value) link                       = next();
+        else if (arg == "--seconds"  && value) seconds                    = std::atof(next());
+        else return Usage(argv[0]);
+    }
+    if (settings.multiplier <= 0.0 || settings.stateDuration_uS == 0 || settings.samplingSpeed_Hz == 0)
+        return Usage(argv[0]);
+
+    std::string slavePath;
+    const int fd = OpenPty(slavePath);
+    if (fd < 0) return 1;
+
+    if (!link.empty()) {
+        unlink(link.c_str());
+        if (symlink(slavePath.c_str(), link.c_str()) != 0) { std::perror("symlink"); link.clear(); }
+    }
+    std::signal(SIGINT,  [](int) { s_stop = 1; });
+    std::signal(SIGTERM, [](int) { s_stop = 1; });
+
+    CTeensyEmulator device(settings);
+    std::printf("%s\n", link.empty() ? slavePath.c_str() : link.c_str());
+    std::fflush(stdout);
+
+    std::vector<uint8_t> pending, scratch;
+    size_t   sent = 0;                     // bytes of pending already written
+    uint64_t dropped = 0, lastBytes = 0, lastSamples = 0, lastBlocks = 0;
+    uint8_t  input[4096];
+    double   nextReport = Now() + 1.0;
+
+    while (!s_stop && (seconds <= 0.0 || Now() < seconds)) {
+        pollfd p{ fd, short(POLLIN | (sent < pending.size() ? POLLOUT : 0)), 0 };
+        poll(&p, 1, 1);
+        const double now = Now();
+
+        // No reader: the slave side is closed
+        if (p.revents & POLLHUP) {
+            if (device.IsStreaming()) {
+                device.Disconnect();
+                std::fprintf(stderr, "host closed the port\n");
+            }
+            pending.clear(); sent = 0;
+            usleep(20'000);
+            continue;
+        }
+
+        if (p.revents & POLLIN) {
+            const ssize_t n = read(fd, input, sizeof input);
+            if (n > 0) device.Receive(input, size_t(n), now, pending);
+        }
+
+        // A full send buffer drops what the device produces meanwhile
+        if (pending.size() - sent < SEND_BUFFER) {
+            device.Generate(now, pending);
+        }
+        else {
+            scratch.clear();
+            device.Generate(now, scratch);
+            dropped += scratch.size();
+        }
+
+        while (sent < pending.size()) {
+            const ssize_t n = write(fd, pending.data() + sent, pending.size() - sent);
+            if (n <= 0) {
+                if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EIO) std::perror("write");
+                break;
+            }
+            sent += size_t(n);
+        }
+        if (sent == pending.size())       { pending.clear(); sent = 0; }
+        else if (sent > SEND_BUFFER)      { pending.erase(pending.begin(), pending.begin() + sent); sent = 0; }
+
+        if (now >= nextReport) {
+            const CTeensyEmulator::Stats& s = device.GetStats();
+            std::fprintf(stderr, "%8.0f s  %9llu samples/s  %7llu blocks/s  %7.2f MB/s  backlog %7zu B  dropped %llu B\n",
+                         now, (unsigned long long)(s.samples - lastSamples), (unsigned long long)(s.blocks - lastBlocks),
+                         (s.bytes - lastBytes) / 1e6, pending.size() - sent, (unsigned long long)dropped);
+            lastSamples = s.samples; lastBlocks = s.blocks; lastBytes = s.bytes;
+            nextReport += 1.0;
+        }
+    }
+
+    if (!link.empty()) unlink(link.c_str());
+    close(fd);
+    return 0;
+}